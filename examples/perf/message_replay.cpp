@@ -0,0 +1,305 @@
+/*
+ * Replays the calls recorded by a message capture (QI_MESSAGE_CAPTURE) against a
+ * service, and reports their latency.
+ *
+ * The arguments of the calls are decoded with the signatures of the service
+ * being replayed against, calls carrying objects are skipped.
+ */
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <qi/anyobject.hpp>
+#include <qi/application.hpp>
+#include <qi/binarycodec.hpp>
+#include <qi/buffer.hpp>
+#include <qi/clock.hpp>
+#include <qi/session.hpp>
+
+namespace po = boost::program_options;
+
+namespace
+{
+  // See src/messaging/messagecapture.hpp for the file format.
+  const qi::uint32_t captureMagic = 0x50414351;
+  const qi::uint32_t captureVersion = 1;
+  const qi::uint8_t directionSent = 0;
+  const qi::uint8_t directionReceived = 1;
+
+  // Same layout as qi::Message::Header.
+  struct Header
+  {
+    qi::uint32_t magic;
+    qi::uint32_t id;
+    qi::uint32_t size;
+    qi::uint16_t version;
+    qi::uint8_t  type;
+    qi::uint8_t  flags;
+    qi::uint32_t service;
+    qi::uint32_t object;
+    qi::uint32_t action;
+  };
+  static_assert(sizeof(Header) == 28, "Header does not have the size of qi::Message::Header");
+
+  const qi::uint8_t typeCall = 1;
+  const qi::uint8_t flagDynamicPayload = 1;
+  const qi::uint8_t flagReturnType = 2;
+  const qi::uint8_t flagDeadline = 4;
+  const qi::uint32_t mainObject = 1;
+
+  struct CapturedCall
+  {
+    qi::NanoSeconds at;
+    unsigned int function;
+    qi::uint8_t flags;
+    qi::Buffer payload;
+  };
+
+  template<typename T>
+  bool readPod(std::istream& in, T& value)
+  {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+  }
+
+  std::vector<CapturedCall> readCapture(const std::string& path, unsigned int serviceId,
+                                        qi::uint8_t direction)
+  {
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in.is_open())
+      throw std::runtime_error("Cannot open " + path);
+    qi::uint32_t magic = 0, version = 0;
+    if (!readPod(in, magic) || !readPod(in, version) || magic != captureMagic)
+      throw std::runtime_error(path + " is not a message capture");
+    if (version != captureVersion)
+      throw std::runtime_error(path + " has an unsupported capture version");
+
+    std::vector<CapturedCall> calls;
+    std::vector<char> payload;
+    qi::int64_t elapsed;
+    qi::uint32_t connection;
+    qi::uint8_t dir;
+    Header header;
+    while (readPod(in, elapsed))
+    {
+      if (!readPod(in, connection) || !readPod(in, dir) || !readPod(in, header))
+        throw std::runtime_error(path + " is truncated");
+      payload.resize(header.size);
+      if (header.size && !in.read(payload.data(), header.size))
+        throw std::runtime_error(path + " is truncated");
+      // Only the calls to the methods of the service, not to the internal ones.
+      if (dir != direction || header.type != typeCall || header.service != serviceId
+          || header.object != mainObject || header.action <= qi::Manageable::endId)
+        continue;
+      CapturedCall call{qi::NanoSeconds(elapsed), header.action, header.flags, qi::Buffer()};
+      call.payload.write(payload.data(), payload.size());
+      calls.push_back(std::move(call));
+    }
+    return calls;
+  }
+
+  struct ReplayedCall
+  {
+    qi::NanoSeconds at;
+    unsigned int function;
+    qi::AnyValue arguments;
+    qi::Signature returnSignature;
+  };
+
+  /// Decodes the arguments of a call as a tuple, like ServiceBoundObject::onMessage.
+  ReplayedCall decode(const CapturedCall& call, const qi::MetaObject& metaObject)
+  {
+    const qi::MetaMethod* method = metaObject.method(call.function);
+    if (!method)
+      throw std::runtime_error("no such method");
+    qi::Signature signature = method->parametersSignature();
+    if (call.flags & flagDynamicPayload)
+      signature = "m";
+    const bool hasReturnType = call.flags & flagReturnType;
+    if (hasReturnType)
+      signature = "(" + signature.toString() + "s)";
+
+    qi::BufferReader reader(call.payload);
+    if (call.flags & flagDeadline)
+      reader.seek(sizeof(qi::int64_t));
+    qi::AnyReference value(qi::TypeInterface::fromSignature(signature));
+    value = qi::decodeBinary(&reader, value);
+    qi::AnyValue decoded(value, false, true);
+
+    ReplayedCall replayed{call.at, call.function, qi::AnyValue(), qi::Signature()};
+    qi::AnyReference arguments = decoded.asReference();
+    if (hasReturnType)
+    {
+      replayed.returnSignature = qi::Signature(arguments[1].to<std::string>());
+      arguments = arguments[0];
+    }
+    if (call.flags & flagDynamicPayload)
+      arguments = arguments.content();
+    replayed.arguments = qi::AnyValue(arguments, true, true);
+    return replayed;
+  }
+
+  double percentile(const std::vector<double>& sorted, double ratio)
+  {
+    return sorted[std::min(sorted.size() - 1, static_cast<std::size_t>(ratio * sorted.size()))];
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  qi::Application app(argc, argv);
+
+  po::options_description desc("Replays the calls of a message capture against a service");
+  desc.add_options()
+    ("help,h", "Print this help.")
+    ("capture,c", po::value<std::string>()->required(), "The capture file (see QI_MESSAGE_CAPTURE).")
+    ("url,u", po::value<std::string>()->default_value("tcp://127.0.0.1:9559"), "The service directory.")
+    ("service,s", po::value<std::string>()->required(), "The service to call.")
+    ("captured-service-id", po::value<unsigned int>()->required(), "The id of the service in the capture.")
+    ("sent", "Replay the calls the capturing process sent, instead of those it received.")
+    ("connections,n", po::value<unsigned int>()->default_value(1), "The number of parallel connections.")
+    ("max-speed", "Send the calls as fast as possible instead of with their original timing.")
+    ("window,w", po::value<unsigned int>()->default_value(16),
+     "The calls in flight per connection at max speed.");
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+    if (vm.count("help"))
+    {
+      std::cout << desc << std::endl;
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch (const po::error& e)
+  {
+    std::cerr << e.what() << std::endl << desc << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const unsigned int connectionCount = std::max(1u, vm["connections"].as<unsigned int>());
+  const bool maxSpeed = vm.count("max-speed") != 0;
+  const unsigned int window = std::max(1u, vm["window"].as<unsigned int>());
+
+  std::vector<qi::SessionPtr> sessions;
+  std::vector<qi::AnyObject> services;
+  std::vector<ReplayedCall> calls;
+  unsigned int skipped = 0;
+  try
+  {
+    for (unsigned int i = 0; i < connectionCount; ++i)
+    {
+      qi::SessionPtr session = qi::makeSession();
+      session->connect(vm["url"].as<std::string>());
+      services.push_back(session->service(vm["service"].as<std::string>()));
+      sessions.push_back(session);
+    }
+    const qi::MetaObject metaObject = services.front().metaObject();
+    for (const CapturedCall& call : readCapture(vm["capture"].as<std::string>(),
+                                                vm["captured-service-id"].as<unsigned int>(),
+                                                vm.count("sent") ? directionSent : directionReceived))
+    {
+      try
+      {
+        calls.push_back(decode(call, metaObject));
+      }
+      catch (const std::exception& e)
+      {
+        std::cerr << "Skipping a call to method " << call.function << ": " << e.what() << std::endl;
+        ++skipped;
+      }
+    }
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (calls.empty())
+  {
+    std::cerr << "No call to replay." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::mutex mutex;
+  std::condition_variable progressed;
+  std::vector<unsigned int> inFlight(connectionCount, 0);
+  std::vector<double> latencies;
+  latencies.reserve(calls.size());
+  std::size_t finished = 0;
+  unsigned int errors = 0;
+
+  const qi::SteadyClockTimePoint start = qi::SteadyClock::now();
+  for (std::size_t i = 0; i < calls.size(); ++i)
+  {
+    const ReplayedCall& call = calls[i];
+    const std::size_t connection = i % connectionCount;
+    if (maxSpeed)
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      progressed.wait(lock, [&] { return inFlight[connection] < window; });
+    }
+    else
+    {
+      const auto dueIn = start + (call.at - calls.front().at) - qi::SteadyClock::now();
+      if (dueIn > qi::NanoSeconds::zero())
+        std::this_thread::sleep_for(std::chrono::nanoseconds(dueIn.count()));
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      ++inFlight[connection];
+    }
+    const qi::SteadyClockTimePoint sentAt = qi::SteadyClock::now();
+    qi::GenericFunctionParameters params(call.arguments.asReference().asTupleValuePtr());
+    services[connection].metaCall(call.function, params, qi::MetaCallType_Queued, call.returnSignature)
+        .connect([&, connection, sentAt](qi::Future<qi::AnyReference> result) {
+      const double latency =
+          boost::chrono::duration_cast<qi::NanoSeconds>(qi::SteadyClock::now() - sentAt).count() / 1000.;
+      if (result.hasValue())
+      {
+        qi::AnyReference value = result.value();
+        value.destroy();
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      if (result.hasError() || result.isCanceled())
+        ++errors;
+      else
+        latencies.push_back(latency);
+      --inFlight[connection];
+      ++finished;
+      progressed.notify_all();
+    });
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    progressed.wait(lock, [&] { return finished == calls.size(); });
+  }
+  const double seconds =
+      boost::chrono::duration_cast<qi::MicroSeconds>(qi::SteadyClock::now() - start).count() / 1e6;
+
+  std::sort(latencies.begin(), latencies.end());
+  std::cout << calls.size() << " calls over " << connectionCount << " connections in "
+            << seconds << " s (" << calls.size() / seconds << " calls/s), "
+            << errors << " errors, " << skipped << " skipped" << std::endl;
+  if (!latencies.empty())
+  {
+    std::cout << "latency (us): p50 " << percentile(latencies, 0.5)
+              << ", p90 " << percentile(latencies, 0.9)
+              << ", p99 " << percentile(latencies, 0.99)
+              << ", p99.9 " << percentile(latencies, 0.999)
+              << ", max " << latencies.back() << std::endl;
+  }
+
+  for (qi::SessionPtr& session : sessions)
+    session->close();
+  return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
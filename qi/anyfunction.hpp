@@ -152,8 +152,11 @@ namespace qi {
     AnyFunction();
     ~AnyFunction();
     AnyFunction(const AnyFunction& b);
+    /// Takes the function of \p b without cloning it, \p b is left empty.
+    AnyFunction(AnyFunction&& b);
     AnyFunction(FunctionTypeInterface* type, void* value);
     AnyFunction& operator = (const AnyFunction& b);
+    AnyFunction& operator = (AnyFunction&& b);
 
     /// Calls the function.
     /// @param args A list of unnamed arguments, each wrapped in an
@@ -268,6 +271,7 @@ QI_GEN(genCall)
   public:
     GenericFunctionParameters();
     GenericFunctionParameters(const AnyReferenceVector&);
+    GenericFunctionParameters(AnyReferenceVector&&);
     /// Copy arguments. destroy() must be called on the result
     GenericFunctionParameters copy(bool notFirst=false) const;
     /// Convert the arguments to given signature. destroy() must be called on the result.
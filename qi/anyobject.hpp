@@ -48,6 +48,7 @@ static const unsigned int qiObjectSpecialMemberMaxUid = 100;
  * or not
  * @param callerId thread id of caller, for tracing purposes
  * @param postTimestamp the time when the call was requested
+ * @param priority the priority of the call when it is scheduled in ec
  */
 QI_API qi::Future<AnyReference> metaCall(ExecutionContext* ec,
     ObjectThreadingModel objectThreadingModel,
@@ -59,7 +60,8 @@ QI_API qi::Future<AnyReference> metaCall(ExecutionContext* ec,
     const GenericFunctionParameters& params,
     bool noCloneFirst = false,
     unsigned int callerId = 0,
-    qi::os::timeval postTimestamp = qi::os::timeval());
+    qi::os::timeval postTimestamp = qi::os::timeval(),
+    TaskPriority priority = TaskPriority::Normal);
 
 }
 
@@ -11,7 +11,11 @@
 # include <qi/types.hpp>
 # include <boost/shared_ptr.hpp>
 # include <vector>
+# include <string>
 # include <cstddef>
+# include <cstring>
+# include <limits>
+# include <type_traits>
 
 #ifdef _MSC_VER
 #  pragma warning( push )
@@ -217,6 +221,43 @@ namespace qi
     boost::shared_ptr<BufferPrivate> _p;
   };
 
+  /**
+   * \brief Read-only view on a range of characters.
+   * \includename{qi/buffer.hpp}
+   *
+   * A view obtained from a BufferReader refers to the data of the read buffer
+   * instead of copying it, and shares its ownership: the view remains valid
+   * even if the buffer is destroyed, as long as it is not modified.
+   * Copying a view does not copy the characters.
+   */
+  class QI_API StringView
+  {
+  public:
+    /// \brief Constructs an empty view.
+    StringView();
+    /// \brief Constructs a view on a copy of the given characters.
+    StringView(const char* data, size_t size);
+    /// \brief Constructs a view on a copy of the given string.
+    explicit StringView(const std::string& str);
+
+    const char* data() const { return _data; }
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    /// \brief Returns a copy of the viewed characters.
+    std::string str() const { return std::string(_data, _size); }
+
+    friend QI_API bool operator==(const StringView& a, const StringView& b);
+    friend bool operator!=(const StringView& a, const StringView& b) { return !(a == b); }
+
+  private:
+    friend class BufferReader;
+    StringView(boost::shared_ptr<const void> owner, const char* data, size_t size);
+
+    boost::shared_ptr<const void> _owner;
+    const char* _data;
+    size_t _size;
+  };
+
   /**
    * \brief Class to read const buffer.
    * \includename{qi/buffer.hpp}
@@ -265,6 +306,38 @@ namespace qi
      */
     void  *peek(size_t offset) const;
 
+    /**
+     * \brief Read data from the buffer without copying it.
+     * \param length Number of bytes to read.
+     * \return A view on the data, sharing the ownership of the buffer data.
+     * If actual position + \a length exceed size of buffer, the cursor is not
+     * moved and an empty view is returned.
+     */
+    StringView readView(size_t length);
+
+    /**
+     * \brief Read an array of values in one copy.
+     * The values are expected in the layout of T in memory, as written by
+     * Buffer::write(values, count * sizeof(T)).
+     * \param values A pre-allocated array of at least \a count values.
+     * \param count Number of values to read.
+     * \return true if the values were read. If the buffer does not hold
+     * \a count values from the actual position, nothing is read and false is
+     * returned.
+     */
+    template <typename T>
+    bool readArray(T* values, size_t count)
+    {
+      static_assert(std::is_pod<T>::value, "only plain values can be read in bulk");
+      if (count > std::numeric_limits<size_t>::max() / sizeof(T))
+        return false;
+      const void* data = read(count * sizeof(T));
+      if (!data)
+        return false;
+      std::memcpy(values, data, count * sizeof(T));
+      return true;
+    }
+
 
     /**
      * \brief Check if there is sub-buffer at the actual position.
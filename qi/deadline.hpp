@@ -0,0 +1,46 @@
+#pragma once
+
+#ifndef _QI_DEADLINE_HPP_
+#define _QI_DEADLINE_HPP_
+
+#include <boost/optional.hpp>
+#include <qi/api.hpp>
+#include <qi/clock.hpp>
+
+namespace qi
+{
+  /**
+   * \brief Sets the deadline of the calls made by the current thread, for the lifetime of the object.
+   *
+   * Calls to remote objects carry the time left before the deadline, so that the server
+   * drops them instead of executing them once the caller has given up. While a call with a
+   * deadline runs, the deadline is set again so that it propagates to the calls it makes.
+   *
+   * Deadlines nest: the effective deadline is the earliest of the deadlines of the enclosing
+   * scopes, and the previous one is restored on destruction.
+   *
+   * \includename{qi/deadline.hpp}
+   */
+  class QI_API ScopedDeadline
+  {
+  public:
+    explicit ScopedDeadline(SteadyClockTimePoint deadline);
+    /// Sets the deadline to now plus timeout.
+    explicit ScopedDeadline(Duration timeout);
+    ~ScopedDeadline();
+
+    ScopedDeadline(const ScopedDeadline&) = delete;
+    ScopedDeadline& operator=(const ScopedDeadline&) = delete;
+
+  private:
+    boost::optional<SteadyClockTimePoint> _previous;
+  };
+
+  /// \return The deadline of the calls made by the current thread, if any.
+  QI_API boost::optional<SteadyClockTimePoint> currentDeadline();
+
+  /// The error of the calls dropped because their deadline expired.
+  QI_API extern const char* const deadlineExpiredError;
+}
+
+#endif  // _QI_DEADLINE_HPP_
@@ -38,6 +38,16 @@ namespace detail
 
 }
 
+/// Priority of a task scheduled in an execution context.
+enum class TaskPriority
+{
+  /// The default priority, for bulk work.
+  Normal,
+  /// For latency-critical work, such as the dispatch of calls and timer callbacks.
+  /// Such tasks run before the pending tasks of normal priority.
+  High,
+};
+
 class QI_API ExecutionContext
 {
 public:
@@ -92,6 +102,15 @@ public:
     return asyncDelay(std::forward<F>(callback), qi::Duration(0));
   }
 
+  /// post a callback to be executed as soon as possible with the given priority.
+  /// Contexts without priorities ignore it.
+  template <typename F>
+  void post(F&& callback, TaskPriority priority);
+  /// call a callback asynchronously with the given priority.
+  /// Contexts without priorities ignore it.
+  template <typename F, typename R = traits::Decay<decltype(std::declval<F>()())>>
+  qi::Future<R> async(F&& callback, TaskPriority priority);
+
   /// return true if the current thread is in this context
   virtual bool isInThisContext() const = 0;
 
@@ -99,6 +118,16 @@ protected:
   virtual void postImpl(boost::function<void()> callback) = 0;
   virtual qi::Future<void> asyncAtImpl(boost::function<void()> cb, qi::SteadyClockTimePoint tp) = 0;
   virtual qi::Future<void> asyncDelayImpl(boost::function<void()> cb, qi::Duration delay) = 0;
+
+  // Named apart from postImpl and asyncDelayImpl so that overriding those does not hide them.
+  // Adding these virtual functions changed the vtable of ExecutionContext and of the classes
+  // deriving from it (ABI break): code deriving from them must be rebuilt.
+  virtual void postWithPriorityImpl(boost::function<void()> callback, TaskPriority /*priority*/)
+  {
+    postImpl(std::move(callback));
+  }
+  virtual qi::Future<void> asyncDelayWithPriorityImpl(boost::function<void()> cb, qi::Duration delay,
+                                                      TaskPriority priority);
 };
 
 }
@@ -200,6 +229,19 @@ void ExecutionContext::post(F&& callback)
   postImpl(std::forward<F>(callback));
 }
 
+inline qi::Future<void> ExecutionContext::asyncDelayWithPriorityImpl(boost::function<void()> cb,
+                                                                     qi::Duration delay,
+                                                                     TaskPriority /*priority*/)
+{
+  return asyncDelayImpl(std::move(cb), delay);
+}
+
+template <typename F>
+void ExecutionContext::post(F&& callback, TaskPriority priority)
+{
+  postWithPriorityImpl(std::forward<F>(callback), priority);
+}
+
 template <typename ReturnType, typename Callback>
 struct ToPost
 {
@@ -239,6 +281,18 @@ Future<R> ExecutionContext::asyncDelay(F&& callback, qi::Duration delay)
   f.connect(boost::bind(&detail::checkCanceled<R>, _1, promise), FutureCallbackType_Sync);
   return promise.future();
 }
+
+template <typename F, typename R>
+Future<R> ExecutionContext::async(F&& callback, TaskPriority priority)
+{
+  ToPost<R, typename std::decay<F>::type> topost(std::move(callback));
+  auto promise = topost.promise;
+  qi::Future<void> f = asyncDelayWithPriorityImpl(std::move(topost), qi::Duration(0), priority);
+  promise.setup(boost::bind(&detail::futureCancelAdapter<void>,
+                            boost::weak_ptr<detail::FutureBaseTyped<void> >(f.impl())));
+  f.connect(boost::bind(&detail::checkCanceled<R>, _1, promise), FutureCallbackType_Sync);
+  return promise.future();
+}
 }
 
 #endif
@@ -0,0 +1,125 @@
+#pragma once
+
+#ifndef _QI_DETAIL_EXECUTIONSTATISTICS_HPP_
+#define _QI_DETAIL_EXECUTIONSTATISTICS_HPP_
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <boost/thread/mutex.hpp>
+#include <qi/api.hpp>
+#include <qi/clock.hpp>
+#include <qi/stats.hpp>
+
+#ifdef _MSC_VER
+#  pragma warning( push )
+#  pragma warning( disable: 4251 )
+#endif
+
+namespace qi
+{
+namespace detail
+{
+  /// Gathers the ExecutionStatistics of an execution context.
+  /// All methods are lock-free, except when a task joins the slowest ones.
+  class QI_API ExecutionStatisticsRecorder
+  {
+  public:
+    /// Number of slowest tasks kept.
+    static const std::size_t slowTaskCount = 8;
+
+    /// \param contextName Name of the execution context, used in the long task warnings.
+    explicit ExecutionStatisticsRecorder(std::string contextName);
+
+    /// Whether statistics are gathered. Read once from the environment variable
+    /// QI_EXECUTION_STATISTICS, enabled by default. Execution contexts must not
+    /// call the other methods if it returns false.
+    static bool enabled();
+
+    /// A task is ready to run. See also QueuedTask.
+    void taskQueued() { ++_queued; }
+    /// A task that was ready to run was dropped.
+    void taskUnqueued() { --_queued; }
+    /// A task starts.
+    /// \param queued Whether taskQueued was called for this task.
+    /// \param schedulingDelay Time elapsed since the task was due.
+    void taskStarted(bool queued, SteadyClock::duration schedulingDelay);
+    /// A task started by taskStarted is finished.
+    /// \param name Name of the task, the string must outlive the recorder.
+    void taskFinished(SteadyClock::duration runTime, const char* name);
+
+    ExecutionStatistics statistics() const;
+
+  private:
+    using Histogram = std::array<std::atomic<qi::uint64_t>, DurationHistogram::bucketCount>;
+
+    static void push(Histogram& histogram, SteadyClock::duration duration);
+    static DurationHistogram load(const Histogram& histogram);
+    void recordSlowTask(qi::int64_t runTimeUs, const char* name);
+
+    const std::string _contextName;
+    std::atomic<qi::int64_t> _queued;
+    std::atomic<qi::int64_t> _active;
+    std::atomic<qi::uint64_t> _completed;
+    Histogram _schedulingDelay;
+    Histogram _runTime;
+
+    // Run time of the fastest of the slowest tasks once there are slowTaskCount of them,
+    // so that faster tasks are discarded without locking.
+    std::atomic<qi::int64_t> _slowTaskThresholdUs;
+    mutable boost::mutex _slowTasksMutex;
+    std::vector<std::pair<qi::int64_t, const char*>> _slowTasks;
+  };
+
+  /// Counts a task as queued until it starts, for the execution contexts that may drop their
+  /// tasks without running them: the task is unqueued when the last copy of the handle is
+  /// destroyed, unless it was released when the task started.
+  /// The recorder must outlive the handle.
+  class QueuedTask
+  {
+  public:
+    /// The task is not counted.
+    QueuedTask() = default;
+
+    explicit QueuedTask(ExecutionStatisticsRecorder& recorder)
+      : _count(std::make_shared<Count>(recorder))
+    {
+    }
+
+    /// The task starts. Returns whether it was counted, see ExecutionStatisticsRecorder::taskStarted.
+    bool release() const
+    {
+      return _count && _count->recorder.exchange(nullptr) != nullptr;
+    }
+
+  private:
+    struct Count
+    {
+      explicit Count(ExecutionStatisticsRecorder& recorder)
+        : recorder(&recorder)
+      {
+        recorder.taskQueued();
+      }
+
+      ~Count()
+      {
+        if (ExecutionStatisticsRecorder* r = recorder.load())
+          r->taskUnqueued();
+      }
+
+      std::atomic<ExecutionStatisticsRecorder*> recorder;
+    };
+
+    std::shared_ptr<Count> _count;
+  };
+}
+}
+
+#ifdef _MSC_VER
+#  pragma warning( pop )
+#endif
+
+#endif  // _QI_DETAIL_EXECUTIONSTATISTICS_HPP_
@@ -272,6 +272,15 @@ namespace detail {
       });
     }
 
+    template <typename T>
+    void FutureBaseTyped<T>::setValue(qi::Future<T>& future, ValueType&& value)
+    {
+      finish(future, [this, &value] {
+        _value = std::move(value);
+        reportValue();
+      });
+    }
+
     template <typename T>
     void FutureBaseTyped<T>::set(qi::Future<T>& future)
     {
@@ -797,8 +797,9 @@ namespace qi {
      *  throw if state != running
      *  If T is void \p value must be nullptr
      */
-    void setValue(const ValueType &value) {
-      _f._p->setValue(_f, value);
+    void setValue(ValueType value) {
+      // Taken by value so that temporaries are moved in, not copied.
+      _f._p->setValue(_f, std::move(value));
     }
 
     /** set the error, and notify all futures
@@ -941,6 +942,7 @@ namespace qi {
        */
       void set(qi::Future<T>& future);
       void setValue(qi::Future<T>& future, const ValueType &value);
+      void setValue(qi::Future<T>& future, ValueType &&value);
       void setError(qi::Future<T>& future, const std::string &message);
       void setBroken(qi::Future<T>& future);
       void setCanceled(qi::Future<T>& future);
@@ -15,7 +15,13 @@
 
 // #include <locale>  TODO: Use these includes when they become available on all platforms,
 // #include <codecvt> instead of replaced by boost.locale
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
 #include <type_traits>
+#include <vector>
 
 #include <qi/type/traits.hpp>
 
@@ -62,10 +68,19 @@
   QI_CAT(_QI_LOG_FORMAT_HASARG_, _QI_LOG_ISEMPTY(__VA_ARGS__))(Msg, __VA_ARGS__)
 
 #define _QI_LOG_FORMAT_HASARG_0(Msg, ...) \
-  boost::str(::qi::log::detail::getFormat(Msg)  QI_VAARGS_APPLY(_QI_FORMAT_ELEM, _, __VA_ARGS__ /**/))
+  ::qi::log::detail::formatToString(Msg, __VA_ARGS__)
 
 #define _QI_LOG_FORMAT_HASARG_1(Msg, ...) Msg
 
+// Formats directly into a log stream.
+#  define _QI_LOG_FORMAT_TO(Stream, Msg, ...)                   \
+  QI_CAT(_QI_LOG_FORMAT_TO_HASARG_, _QI_LOG_ISEMPTY(__VA_ARGS__))(Stream, Msg, __VA_ARGS__)
+
+#define _QI_LOG_FORMAT_TO_HASARG_0(Stream, Msg, ...) \
+  ::qi::log::detail::formatTo(Stream, Msg, __VA_ARGS__)
+
+#define _QI_LOG_FORMAT_TO_HASARG_1(Stream, Msg, ...) (Stream << Msg)
+
 #define _QI_SECOND(a, ...) __VA_ARGS__
 
 /* For fast category access, we use lookup to a fixed name symbol.
@@ -104,6 +119,14 @@
   while (false)
 #endif
 
+#  define _QI_LOG_MESSAGE_FORMAT(Type, TypeCased, Msg, ...)           \
+  do                                                                  \
+  {                                                                   \
+    if (::qi::log::isVisible(_QI_LOG_CATEGORY_GET(), ::qi::Type))     \
+      _QI_LOG_FORMAT_TO(BOOST_PP_CAT(_qiLog, TypeCased)(_QI_LOG_CATEGORY_GET()), Msg, __VA_ARGS__); \
+  }                                                                   \
+  while (false)
+
 /* Tricky, we do not want to hit category_get if a category is specified
 * Usual glitch of off-by-one list size: put argument 'TypeCased' in the vaargs
 * Basically we want variadic macro, but it does not exist, so emulate it using _QI_LOG_EMPTY.
@@ -128,13 +151,38 @@
  QI_CAT(_QI_LOG_MESSAGE_STREAM_HASCAT_HASFORMAT_, _QI_LOG_ISEMPTY( __VA_ARGS__))(Type, TypeCased, cat, __VA_ARGS__)
 
 
+/* A category given as a string literal is resolved once per call site: each
+ * lambda expression has its own type, hence its own static. The static also
+ * keeps the address of the name it was resolved from: an array of const char
+ * that is not a literal, such as a `const char (&)[N]` parameter, may be a
+ * different name at each evaluation and is only taken from the cache if it is
+ * the same array. Other category expressions are resolved each time they are
+ * evaluated.
+ */
+#define _QI_LOG_CATEGORY_AT(cat)                                            \
+  ::qi::log::detail::categoryAt([](const char* name) {                     \
+      static const ::qi::log::detail::CachedCategory cached(name);          \
+      return cached.get(name);                                              \
+    }, cat)
+
+/* The category expression is evaluated once, into a variable scoped to the
+ * log statement. The for statement runs its body at most once and, unlike an
+ * if statement, cannot capture a following else.
+ */
+#define _QI_LOG_IF_VISIBLE_AT(Type, cat)                                    \
+  for (::qi::log::CategoryType _qi_log_category_at = _QI_LOG_CATEGORY_AT(cat); \
+       _qi_log_category_at && ::qi::log::isVisible(_qi_log_category_at, ::qi::Type); \
+       _qi_log_category_at = 0)
+
 // No format argument
 #define _QI_LOG_MESSAGE_STREAM_HASCAT_HASFORMAT_1(Type, TypeCased, cat, ...) \
-  BOOST_PP_CAT(_qiLog,TypeCased)(cat)
+  _QI_LOG_IF_VISIBLE_AT(Type, cat)                                          \
+    BOOST_PP_CAT(_qiLog,TypeCased)(_qi_log_category_at)
 
 // Format argument
 #define _QI_LOG_MESSAGE_STREAM_HASCAT_HASFORMAT_0(Type, TypeCased, cat, ...) \
-   BOOST_PP_CAT(_qiLog, TypeCased)(cat, _QI_LOG_FORMAT(__VA_ARGS__))
+  _QI_LOG_IF_VISIBLE_AT(Type, cat)                                          \
+    _QI_LOG_FORMAT_TO(BOOST_PP_CAT(_qiLog, TypeCased)(_qi_log_category_at), __VA_ARGS__)
 
 
 /* Detecting empty arg is tricky.
@@ -226,6 +274,148 @@ namespace qi {
 
       QI_API boost::format getFormat(const std::string& s);
 
+      /// An output stream writing into a buffer that is kept to be reused by
+      /// the next log statement of the thread. Get one with acquireLogStreamBuffer().
+      class QI_API LogStreamBuffer : private std::streambuf
+      {
+      public:
+        LogStreamBuffer();
+
+        std::ostream& stream() { return _stream; }
+
+        /// The content, null-terminated.
+        const char* c_str();
+        std::size_t size() const { return static_cast<std::size_t>(pptr() - pbase()); }
+
+        /// Empties the buffer and restores the default formatting of the stream.
+        void clear();
+
+      private:
+        int_type overflow(int_type c) override;
+
+        std::vector<char> _data;
+        std::ostream _stream;
+      };
+
+      /// Gets a buffer from the pool of the current thread, or a new one if
+      /// they are all in use (nested logs).
+      QI_API LogStreamBuffer* acquireLogStreamBuffer();
+      /// Gives the buffer back to the pool of the current thread.
+      QI_API void releaseLogStreamBuffer(LogStreamBuffer* buffer);
+
+      struct LogStreamBufferReleaser
+      {
+        void operator()(LogStreamBuffer* buffer) const { releaseLogStreamBuffer(buffer); }
+      };
+
+      /// A buffer given back to the pool when destroyed, even if writing to it threw.
+      using ScopedLogStreamBuffer = std::unique_ptr<LogStreamBuffer, LogStreamBufferReleaser>;
+
+      inline ScopedLogStreamBuffer scopedLogStreamBuffer()
+      {
+        return ScopedLogStreamBuffer(acquireLogStreamBuffer());
+      }
+
+      /// A type-erased reference to an argument of a format.
+      struct FormatArg
+      {
+        const void* value;
+        void (*print)(std::ostream&, const void*);
+      };
+
+      template <typename T>
+      void printFormatArg(std::ostream& os, const void* value);
+
+      template <typename T>
+      FormatArg makeFormatArg(const T& value)
+      {
+        return FormatArg{&value, &printFormatArg<T>};
+      }
+
+      /// Writes fmt to os, replacing its directives by the arguments.
+      /// The syntax is the one of boost::format (printf-like "%s", "%5.2f",
+      /// positional "%1%", "%1$s", "%|...|") plus "{}" for the next argument.
+      /// As with boost::format, the argument is always written with its
+      /// operator<<, the directive only sets the formatting of the stream.
+      ///
+      /// Differences with boost::format:
+      /// - "{{" and "}}" are written as "{" and "}".
+      /// - "{}" is written as is when no argument is left for it, so that the
+      ///   formats with a literal "{}" and no extra argument are unchanged.
+      /// The argument count is not checked: as with the boost::format objects
+      /// these macros used before, which had their exceptions disabled,
+      /// missing arguments are written as nothing and extra ones are ignored.
+      /// Exceptions thrown by the operator<< of an argument are propagated.
+      QI_API void format(std::ostream& os, const char* fmt, const FormatArg* args, std::size_t count);
+
+      template <typename... Args>
+      std::ostream& formatTo(std::ostream& os, const char* fmt, const Args&... args)
+      {
+        // One more element so that the array is never empty.
+        const FormatArg array[] = { makeFormatArg(args)..., FormatArg{nullptr, nullptr} };
+        format(os, fmt, array, sizeof...(Args));
+        return os;
+      }
+
+      template <typename... Args>
+      std::ostream& formatTo(std::ostream& os, const std::string& fmt, const Args&... args)
+      {
+        return formatTo(os, fmt.c_str(), args...);
+      }
+
+      template <typename F, typename... Args>
+      std::string formatToString(const F& fmt, const Args&... args)
+      {
+        const ScopedLogStreamBuffer buffer = scopedLogStreamBuffer();
+        formatTo(buffer->stream(), fmt, args...);
+        return std::string(buffer->c_str(), buffer->size());
+      }
+
+      /// The category of a log call site, resolved from the first name it sees.
+      struct CachedCategory
+      {
+        explicit CachedCategory(const char* name)
+          : name(name)
+          , category(addCategory(name))
+        {
+        }
+
+        /// The cached category if name is the array it was resolved from.
+        CategoryType get(const char* name) const
+        {
+          return name == this->name ? category : addCategory(name);
+        }
+
+        const char* const name;
+        const CategoryType category;
+      };
+
+      // Overloads used by _QI_LOG_CATEGORY_AT: only arrays of const char, such
+      // as string literals, are cached by the call site.
+      template <typename F, std::size_t N>
+      Category* categoryAt(F&& cached, const char (&name)[N])
+      {
+        return cached(name);
+      }
+
+      template <typename F, std::size_t N>
+      Category* categoryAt(F&&, char (&name)[N])
+      {
+        return addCategory(name);
+      }
+
+      template <typename F>
+      Category* categoryAt(F&&, const std::string& name)
+      {
+        return addCategory(name);
+      }
+
+      template <typename F>
+      Category* categoryAt(F&&, Category* category)
+      {
+        return category;
+      }
+
       // given a set of rules in the format documented in the public header,
       // return a list of (category name, LogLevel) tuples.
       QI_API std::vector<std::tuple<std::string, qi::LogLevel>> parseFilterRules(
@@ -243,6 +433,13 @@ namespace qi {
         // return std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>().to_bytes(str);
         return boost::locale::conv::utf_to_utf<char>(str.c_str(), str.c_str() + str.size());
       }
+
+      template <typename T>
+      void printFormatArg(std::ostream& os, const void* value)
+      {
+        using ::operator<<;
+        os << narrow(*static_cast<const T*>(value));
+      }
     } // namespace detail
 
     //inlined for perf
@@ -271,6 +468,7 @@ namespace qi {
         , _file(file)
         , _function(function)
         , _line(line)
+        , _buffer(detail::scopedLogStreamBuffer())
       {
       }
       LogStream(const qi::LogLevel level,
@@ -284,6 +482,7 @@ namespace qi {
         , _file(file)
         , _function(function)
         , _line(line)
+        , _buffer(detail::scopedLogStreamBuffer())
       {
       }
       LogStream(const qi::LogLevel  level,
@@ -298,6 +497,23 @@ namespace qi {
         , _file(file)
         , _function(function)
         , _line(line)
+        , _buffer(detail::scopedLogStreamBuffer())
+      {
+        *this << message;
+      }
+      LogStream(const qi::LogLevel  level,
+                const char         *file,
+                const char         *function,
+                const int           line,
+                CategoryType        category,
+                const std::string&  message)
+        : _logLevel(level)
+        , _category(0)
+        , _categoryType(category)
+        , _file(file)
+        , _function(function)
+        , _line(line)
+        , _buffer(detail::scopedLogStreamBuffer())
       {
         *this << message;
       }
@@ -305,9 +521,9 @@ namespace qi {
       ~LogStream()
       {
         if (_category)
-          qi::log::log(_logLevel, _category, this->str().c_str(), _file, _function, _line);
+          qi::log::log(_logLevel, _category, _buffer->c_str(), _file, _function, _line);
         else
-          qi::log::log(_logLevel, _categoryType, this->str(), _file, _function, _line);
+          qi::log::log(_logLevel, _categoryType, _buffer->c_str(), _file, _function, _line);
       }
 
       LogStream& self() { return *this; }
@@ -319,14 +535,17 @@ namespace qi {
        */
       inline std::string str() const
       {
-        return _oss.str();
+        return std::string(_buffer->c_str(), _buffer->size());
       }
 
       explicit inline operator bool() const
       {
-        return static_cast<bool>(_oss);
+        return static_cast<bool>(_buffer->stream());
       }
 
+      /// The underlying stream, reused by the next log statements of the thread.
+      std::ostream& stream() { return _buffer->stream(); }
+
       template <typename T>
       friend LogStream& operator<<(LogStream& l, T&& t)
       {
@@ -334,28 +553,38 @@ namespace qi {
         // defined in the global namespace to be used in this function, declare that we use the
         // overload in the global namespace.
         using ::operator<<;
-        l._oss << detail::narrow(std::forward<T>(t));
+        l._buffer->stream() << detail::narrow(std::forward<T>(t));
         return l;
       }
 
       /* overload for std::endl and other manipulators */
       friend inline LogStream& operator<<(LogStream& l, std::ostream& (*pf) (std::ostream&))
       {
-        l._oss << pf;
+        l._buffer->stream() << pf;
         return l;
       }
 
     private:
 
-      std::ostringstream _oss;
       qi::LogLevel  _logLevel;
       const char   *_category;
       CategoryType  _categoryType;
       const char   *_file;
       const char   *_function;
       int           _line;
+      detail::ScopedLogStreamBuffer _buffer;
 
     };
+
+    namespace detail
+    {
+      template <typename F, typename... Args>
+      LogStream& formatTo(LogStream& stream, const F& fmt, const Args&... args)
+      {
+        formatTo(stream.stream(), fmt, args...);
+        return stream;
+      }
+    }
   }
 }
 
@@ -13,10 +13,13 @@
 
 # include <boost/thread/synchronized_value.hpp>
 # include <boost/function.hpp>
+# include <string>
+# include <vector>
 
 # include <qi/types.hpp>
 # include <qi/api.hpp>
 # include <qi/clock.hpp>
+# include <qi/stats.hpp>
 # include <qi/detail/executioncontext.hpp>
 
 # ifdef _MSC_VER
@@ -34,10 +37,100 @@ namespace qi
 {
   template<typename T> class Future;
 
+  /**
+   * \brief Placement and scheduling of the worker threads of an EventLoop.
+   * \includename{qi/eventloop.hpp}
+   *
+   * The default policy leaves the threads to the system scheduler.
+   */
+  struct QI_API EventLoopThreadPolicy
+  {
+    /// CPUs the workers are allowed to run on. All of them if empty.
+    std::vector<int> cpus;
+    /// If true, each worker is bound to a single CPU, taken from cpus in a
+    /// round-robin fashion. Otherwise workers float over all of cpus.
+    bool pinned = false;
+    /// If true, the workers use the SCHED_FIFO real-time policy.
+    bool realTime = false;
+    /// The real-time priority of the workers if realTime is set, their nice
+    /// value otherwise. 0 without realTime leaves the priority unchanged.
+    int priority = 0;
+    /// Name of the worker threads, followed by their index. If empty, the
+    /// workers are named after the event loop.
+    std::string threadName;
+
+    /**
+     * \brief Reads a policy from the environment.
+     * \param prefix Prefix of the variables, for instance "QI_EVENTLOOP" reads:
+     *   - QI_EVENTLOOP_CPUS: a list of CPUs and ranges of CPUs, for instance "0-2,5",
+     *   - QI_EVENTLOOP_PINNED: 1 to pin the workers,
+     *   - QI_EVENTLOOP_REALTIME: 1 to use the real-time policy,
+     *   - QI_EVENTLOOP_PRIORITY: the priority or nice value,
+     *   - QI_EVENTLOOP_THREAD_NAME: the name of the worker threads.
+     * \throw std::runtime_error if a variable cannot be parsed.
+     */
+    static EventLoopThreadPolicy fromEnvironment(const std::string& prefix);
+  };
+
+  /// \brief Utilization counters of a worker thread of an EventLoop.
+  struct EventLoopThreadStatistics
+  {
+    /// Index of the worker in the event loop.
+    unsigned int index = 0;
+    /// The CPU the worker is pinned to, -1 if it floats.
+    int cpu = -1;
+    /// Number of tasks executed by the worker.
+    uint64_t tasks = 0;
+    /// Time spent executing tasks.
+    NanoSeconds busyTime{0};
+    /// Time elapsed since the worker started.
+    NanoSeconds upTime{0};
+  };
+
+  /**
+   * \brief State and decisions of the adaptive sizing of the thread pool of an EventLoop.
+   *
+   * When an event loop spawns threads on overload, a monitor measures every
+   * QI_EVENTLOOP_PING_TIMEOUT milliseconds (500 by default) the latency of its queue.
+   * If a task waits longer than that, the pool grows so that the initial number of
+   * threads are not blocked, a thread being blocked when it runs the same task for
+   * longer than the timeout. Threads idle for QI_EVENTLOOP_IDLE_TIMEOUT milliseconds
+   * (60000 by default, 0 to disable) are stopped, down to the initial number of threads.
+   * The pool is limited to QI_EVENTLOOP_MAX_THREADS threads (150 by default, see
+   * EventLoop::setMaxThreads) and to a memory budget of QI_EVENTLOOP_MEMORY_BUDGET
+   * megabytes (unlimited by default), each thread accounting for QI_EVENTLOOP_THREAD_MEMORY
+   * kilobytes (8192 by default, the usual size of a thread stack).
+   */
+  struct EventLoopPoolStatistics
+  {
+    /// Number of running threads.
+    unsigned int threads = 0;
+    /// Number of threads the pool shrinks to.
+    unsigned int minThreads = 0;
+    /// Maximum number of threads, given the memory budget. 0 if unlimited.
+    unsigned int maxThreads = 0;
+    /// Number of blocked threads at the last overload.
+    unsigned int blockedThreads = 0;
+    /// Number of threads spawned because of overloads.
+    uint64_t spawned = 0;
+    /// Number of idle threads stopped.
+    uint64_t retired = 0;
+    /// Number of overloads the pool could not grow for, because of its limits.
+    uint64_t saturations = 0;
+    /// Latency of the queue at the last measure, in microseconds.
+    int64_t lastLatencyUs = 0;
+  };
+
   class EventLoopPrivate;
   /**
    * \brief Class to handle eventloop.
    * \includename{qi/eventloop.hpp}
+   *
+   * Tasks are posted with a priority (see TaskPriority). Tasks of high priority run before
+   * the pending tasks of normal priority: a worker taking a task of normal priority first runs
+   * up to QI_EVENTLOOP_PRIORITY_BURST (8 by default) pending tasks of high priority. Tasks of
+   * normal priority are therefore never starved, and 0 disables priorities. Timer callbacks,
+   * i.e. tasks scheduled with a delay or at a time point, have the high priority by default.
    */
   class QI_API EventLoop : public ExecutionContext
   {
@@ -52,6 +145,14 @@ namespace qi
      */
     explicit EventLoop(std::string name = "eventloop", int nthreads = 0, bool spawnOnOverload = true);
 
+    /**
+     * \brief Creates a group of threads running event loops, placed and scheduled according to a policy.
+     * \param policy The placement and scheduling of the threads. The other constructor reads it from the
+     *   environment variables prefixed by QI_EVENTLOOP, see EventLoopThreadPolicy::fromEnvironment.
+     * See the other constructor for the other parameters.
+     */
+    EventLoop(std::string name, int nthreads, bool spawnOnOverload, EventLoopThreadPolicy policy);
+
     /// \brief Default destructor.
     ~EventLoop();
 
@@ -96,6 +197,26 @@ namespace qi
      */
     void setMaxThreads(unsigned int max);
 
+    /**
+     * \brief Returns the utilization counters of the running worker threads.
+     * \note It is safe to call this method concurrently.
+     */
+    std::vector<EventLoopThreadStatistics> threadStatistics() const;
+
+    /**
+     * \brief Returns the statistics of the tasks of the event loop: queue depth, scheduling delays,
+     * run times and slowest tasks. Gathering can be disabled by setting QI_EXECUTION_STATISTICS=0,
+     * and tasks running longer than QI_EXECUTION_LONG_TASK_MS milliseconds are logged as warnings.
+     * \note It is safe to call this method concurrently.
+     */
+    ExecutionStatistics statistics() const;
+
+    /**
+     * \brief Returns the state of the adaptive sizing of the thread pool, see EventLoopPoolStatistics.
+     * \note It is safe to call this method concurrently.
+     */
+    EventLoopPoolStatistics poolStatistics() const;
+
     /// \brief Internal function.
     void *nativeHandle();
 
@@ -171,17 +292,40 @@ namespace qi
     {
       postDelayImpl(callback, qi::Duration(0));
     }
+    void postWithPriorityImpl(boost::function<void()> callback, TaskPriority priority) override;
     void postDelayImpl(boost::function<void()> callback, qi::Duration delay);
     qi::Future<void> asyncAtImpl(boost::function<void()> cb, qi::SteadyClockTimePoint tp) override;
     qi::Future<void> asyncDelayImpl(boost::function<void()> cb, qi::Duration delay) override;
+    qi::Future<void> asyncDelayWithPriorityImpl(boost::function<void()> cb, qi::Duration delay,
+                                                TaskPriority priority) override;
   };
 
   /// \brief Returns the global eventloop, created on demand on first call.
   QI_API EventLoop* getEventLoop();
 
-  /// \brief Returns the global network eventloop, created on demand on first call.
+  /**
+   * \brief Returns the global network eventloop, created on demand on first call.
+   *
+   * The placement of the network eventloops is read from the environment variables
+   * prefixed by QI_NETWORK_EVENTLOOP (see EventLoopThreadPolicy::fromEnvironment), so
+   * that for instance QI_NETWORK_EVENTLOOP_CPUS=3 and QI_NETWORK_EVENTLOOP_PINNED=1
+   * dedicate the network thread to the CPU 3. When there are several network
+   * eventloops and they are pinned, each one is pinned to the next CPU of the list.
+   */
   QI_API EventLoop* getNetworkEventLoop();
 
+  /**
+   * \brief Returns one of the network eventloops, chosen in a round-robin fashion.
+   *
+   * The network eventloops are single-threaded, so the handlers of a socket bound
+   * to one of them are never executed concurrently. Their number is read from the
+   * environment variable QI_NETWORK_EVENTLOOP_COUNT (1 by default, in which case this
+   * function always returns getNetworkEventLoop()). The first one is always the
+   * eventloop returned by getNetworkEventLoop().
+   * \note It is safe to call this function concurrently.
+   */
+  QI_API EventLoop* getNextNetworkEventLoop();
+
   /**
    * \brief Starts the eventloop with nthread threads. Does nothing if already started.
    * \param nthread Set the minimum number of worker threads in the pool.
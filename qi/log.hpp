@@ -72,7 +72,7 @@
 # define qiLogDebugF(Msg, ...) do {} while(0)
 #else
 # define qiLogDebug(...)   _QI_LOG_MESSAGE_STREAM(LogLevel_Debug,   Debug ,  __VA_ARGS__)
-# define qiLogDebugF(Msg, ...)   _QI_LOG_MESSAGE(LogLevel_Debug,   _QI_LOG_FORMAT(Msg, __VA_ARGS__))
+# define qiLogDebugF(Msg, ...)   _QI_LOG_MESSAGE_FORMAT(LogLevel_Debug, Debug, Msg, __VA_ARGS__)
 #endif
 
 /**
@@ -83,7 +83,7 @@
 # define qiLogVerboseF(Msg, ...) do {} while(0)
 #else
 # define qiLogVerbose(...) _QI_LOG_MESSAGE_STREAM(LogLevel_Verbose, Verbose, __VA_ARGS__)
-# define qiLogVerboseF(Msg, ...)   _QI_LOG_MESSAGE(LogLevel_Verbose,   _QI_LOG_FORMAT(Msg, __VA_ARGS__))
+# define qiLogVerboseF(Msg, ...)   _QI_LOG_MESSAGE_FORMAT(LogLevel_Verbose, Verbose, Msg, __VA_ARGS__)
 #endif
 
 /**
@@ -94,7 +94,7 @@
 # define qiLogInfoF(Msg, ...) do {} while(0)
 #else
 # define qiLogInfo(...)    _QI_LOG_MESSAGE_STREAM(LogLevel_Info,    Info,    __VA_ARGS__)
-# define qiLogInfoF(Msg, ...)   _QI_LOG_MESSAGE(LogLevel_Info,   _QI_LOG_FORMAT(Msg, __VA_ARGS__))
+# define qiLogInfoF(Msg, ...)   _QI_LOG_MESSAGE_FORMAT(LogLevel_Info, Info, Msg, __VA_ARGS__)
 #endif
 
 /**
@@ -105,7 +105,7 @@
 # define qiLogWarningF(Msg, ...) do {} while(0)
 #else
 # define qiLogWarning(...) _QI_LOG_MESSAGE_STREAM(LogLevel_Warning, Warning, __VA_ARGS__)
-# define qiLogWarningF(Msg, ...)   _QI_LOG_MESSAGE(LogLevel_Warning,   _QI_LOG_FORMAT(Msg, __VA_ARGS__))
+# define qiLogWarningF(Msg, ...)   _QI_LOG_MESSAGE_FORMAT(LogLevel_Warning, Warning, Msg, __VA_ARGS__)
 #endif
 
 /**
@@ -116,7 +116,7 @@
 # define qiLogErrorF(Msg, ...) do {} while(0)
 #else
 # define qiLogError(...)   _QI_LOG_MESSAGE_STREAM(LogLevel_Error,   Error,   __VA_ARGS__)
-# define qiLogErrorF(Msg, ...)   _QI_LOG_MESSAGE(LogLevel_Error,   _QI_LOG_FORMAT(Msg, __VA_ARGS__))
+# define qiLogErrorF(Msg, ...)   _QI_LOG_MESSAGE_FORMAT(LogLevel_Error, Error, Msg, __VA_ARGS__)
 #endif
 
 /**
@@ -127,7 +127,7 @@
 # define qiLogFatalF(Msg, ...) do {} while(0)
 #else
 # define qiLogFatal(...)   _QI_LOG_MESSAGE_STREAM(LogLevel_Fatal,   Fatal,   __VA_ARGS__)
-# define qiLogFatalF(Msg, ...)   _QI_LOG_MESSAGE(LogLevel_Fatal,   _QI_LOG_FORMAT(Msg, __VA_ARGS__))
+# define qiLogFatalF(Msg, ...)   _QI_LOG_MESSAGE_FORMAT(LogLevel_Fatal, Fatal, Msg, __VA_ARGS__)
 #endif
 
 
@@ -294,6 +294,16 @@ namespace qi {
                     const char*        fct = "",
                     const int          line = 0);
 
+    /**
+     * \copydoc log()
+     */
+    QI_API void log(const qi::LogLevel verb,
+                    CategoryType       category,
+                    const char*        msg,
+                    const char*        file = "",
+                    const char*        fct = "",
+                    const int          line = 0);
+
 
     /**
      * \brief Convert log verbosity to a readable string.
@@ -0,0 +1,63 @@
+#pragma once
+
+#ifndef _QI_MESSAGING_CALLBATCH_HPP_
+#define _QI_MESSAGING_CALLBATCH_HPP_
+
+#include <memory>
+#include <qi/api.hpp>
+
+namespace qi
+{
+  namespace detail
+  {
+    class CallBatch;
+  }
+
+  /**
+   * \brief Groups the asynchronous calls to remote objects made by the current thread, for the
+   * lifetime of the object.
+   *
+   * The calls made with async() are serialized and their futures returned as usual, but their
+   * messages are only sent when the batch is flushed: explicitly, on destruction, or before a
+   * call that is not batched. The messages going to the same socket are then handed over to it
+   * at once. Each call still resolves its own future.
+   *
+   * Synchronous calls, such as call(), and the calls the library waits for itself, such as
+   * connecting to a signal, reading a property or getting a service, are not batched.
+   * Waiting for the result of an asynchronous call of the batch before it is flushed blocks
+   * forever: wait for it after the flush.
+   *
+   * With CallOrder::Sequential, the servers execute the calls of the batch one after the other,
+   * in the order they were made, instead of concurrently. Servers not supporting it execute
+   * them as usual.
+   *
+   * Batches nest: calls go to the innermost one, the previous one is restored on destruction.
+   *
+   * \includename{qi/messaging/callbatch.hpp}
+   */
+  class QI_API ScopedCallBatch
+  {
+  public:
+    enum class CallOrder
+    {
+      Any,
+      Sequential,
+    };
+
+    explicit ScopedCallBatch(CallOrder order = CallOrder::Any);
+    /// Sends the calls made since the last flush.
+    ~ScopedCallBatch();
+
+    ScopedCallBatch(const ScopedCallBatch&) = delete;
+    ScopedCallBatch& operator=(const ScopedCallBatch&) = delete;
+
+    /// Sends the calls made since the last flush.
+    void flush();
+
+  private:
+    std::unique_ptr<detail::CallBatch> _batch;
+    detail::CallBatch* _previous;
+  };
+}
+
+#endif  // _QI_MESSAGING_CALLBATCH_HPP_
@@ -289,6 +289,7 @@ namespace qi { namespace sock {
 ///           void* data,
 ///           const void* const_data,
 ///           std::size_t maxSizeInBytes,
+///           SslContext<N> sslContextLValue,
 ///           SslSocket<N> sslSocketLValue,
 ///           NetTransferHandler transferHandler, the following is valid:
 ///        IoService<N>& io = N::defaultIoService();
@@ -296,6 +297,8 @@ namespace qi { namespace sock {
 ///     && N::setSocketNativeOptionsWindows(handle, i) if compiled on Windows
 ///     && N::setSocketNativeOptionsLinux(handle, i) if compiled on Linux
 ///     && N::setSocketNativeOptionsMacOs(handle) if compiled on MacOs
+///     && N::sslEnableSessionResumption(sslContextLValue)
+///     && N::sslResumeSession(sslSocketLValue)
 ///     && MutableBufferSequence mutable_bufs = N::buffer(data, maxSizeInBytes);
 ///         (MutableBufferSequence only constrained by the following)
 ///     && ConstBufferSequence const_bufs = N::buffer(const_data, maxSizeInBytes);
@@ -3,6 +3,7 @@
 #define _QI_SOCK_CONNECTEDSTATE_HPP
 #include <memory>
 #include <utility>
+#include <vector>
 #include <boost/optional.hpp>
 #include <qi/atomic.hpp>
 #include <qi/functional.hpp>
@@ -153,6 +154,9 @@ namespace qi
         template<typename Msg, typename Proc>
         void send(Msg&& msg, SslEnabled, Proc onSent);
 
+        template<typename Proc>
+        void sendAll(std::vector<Message>&& msgs, SslEnabled, Proc onSent);
+
         void stop(Promise<void> disconnectedPromise)
         {
           if (tryRaiseAtomicFlag(_stopRequested))
@@ -217,6 +221,16 @@ namespace qi
       {
         return _impl->send(std::forward<Msg>(msg), ssl, onSent);
       }
+
+      /// Enqueues the messages in order, with a single dispatch to the network.
+      /// If no message is being sent, they are all written with a single write.
+      ///
+      /// Procedure<bool (ErrorCode<N>, std::list<Message>::const_iterator)>
+      template<typename Proc = NoOpProcedure<bool (ErrorCode<N>, std::list<Message>::const_iterator)>>
+      void sendAll(std::vector<Message>&& msgs, SslEnabled ssl, const Proc& onSent = {true})
+      {
+        return _impl->sendAll(std::move(msgs), ssl, onSent);
+      }
       Future<SyncConnectedResultPtr<N, S>> complete() const
       {
         return _impl->_completePromise->future();
@@ -331,6 +345,35 @@ namespace qi
         );
       }))();
     }
+
+    template<typename N, typename S>
+    template<typename Proc>
+    void Connected<N, S>::Impl::sendAll(std::vector<Message>&& msgs, SslEnabled ssl, Proc onSent)
+    {
+      using SendMessage = decltype(_sendMsg);
+      using ReadableMessage = typename SendMessage::ReadableMessage;
+      auto self = shared_from_this();
+      auto life = lifetimeTransfo();
+      auto sync = syncTransfo();
+      auto sharedMsgs = std::make_shared<std::vector<Message>>(std::move(msgs));
+
+      // As in `send`, but all the messages are enqueued at once.
+      sync(life([=]() mutable {
+        _sendMsg.sendAll(std::move(*sharedMsgs), ssl,
+          [=](const ErrorCode<N>& e, const ReadableMessage& ptrMsg) mutable { // onSent
+            const bool mustContinue = !_shuttingdown.load() && onSent(e, ptrMsg);
+            if (!mustContinue)
+            {
+              self->setPromise(e, &*ptrMsg);
+              return false; // We must not continue to send messages.
+            }
+            return true; // Otherwise, we continue to send messages.
+          },
+          life,
+          sync
+        );
+      }))();
+    }
 }} // namespace qi::sock
 
 #endif // _QI_SOCK_CONNECTEDSTATE_HPP
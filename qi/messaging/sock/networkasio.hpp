@@ -42,6 +42,18 @@ namespace qi { namespace sock {
     /// Warning: On some platform (e.g. MacOs), timeout might be ignored.
     static void setSocketNativeOptions(boost::asio::ip::tcp::socket::native_handle_type h, int timeoutInSeconds);
 
+    /// Makes the client sockets using the context store the TLS sessions they
+    /// establish, for sslResumeSession. Must be called before the context is used.
+    static void sslEnableSessionResumption(ssl_context_type& c);
+
+    /// Reuses, if any, the TLS session previously established with the remote
+    /// endpoint the socket is connected to, to avoid a full handshake. The
+    /// sessions the socket establishes are remembered for later connections to
+    /// the same remote endpoint.
+    /// Must be called on client side, before the handshake. The sessions are only
+    /// stored if sslEnableSessionResumption was called on the context of the socket.
+    static void sslResumeSession(ssl_socket_type& s);
+
     /// NetSslSocket S, MutableBufferSequence B, ReadHandler H
     template<typename S, typename B, typename H>
     static void async_read(S& s, const B& b, H h)
@@ -15,7 +15,8 @@
 
 namespace qi { namespace sock {
 
-  inline char const* logCategory()
+  /// Returns the literal itself so that logging macros cache the category.
+  inline auto logCategory() -> decltype("qimessaging.messagesocket")
   {
     return "qimessaging.messagesocket";
   }
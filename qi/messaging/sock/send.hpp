@@ -2,8 +2,10 @@
 #ifndef _QI_SOCK_SEND_HPP
 #define _QI_SOCK_SEND_HPP
 #include <atomic>
+#include <memory>
 #include <vector>
 #include <list>
+#include <utility>
 #include <stdexcept>
 #include <sstream>
 #include <boost/thread/synchronized_value.hpp>
@@ -24,36 +26,30 @@
 
 namespace qi { namespace sock {
 
-  /// Make network buffers for the given message.
+  /// Calls the procedure on each chunk of memory that must be sent over the
+  /// network for the given message, in order.
   ///
-  /// One buffer is for the header and the other one is for data.
+  /// A buffer has a header and data.
+  /// Inside data, subbuffers' sizes are interleaved.
+  /// Subbuffers are _not_ inside the buffer, but in separate memory.
+  /// The chunks are:
+  /// - the header
+  /// - for all subbuffers:
+  ///  - the data chunk in the main buffer up to (and including) the subbuffer's size
+  ///  - the subbuffer
+  /// - the last data chunk in the main buffer
   ///
-  /// Network N
-  template<typename N>
-  std::vector<ConstBuffer<N>> makeBuffers(const Message& msg)
+  /// Memory layout for a buffer with 2 subbuffers:
+  /// (low address)                                                         (high address)
+  /// |header|buffer_part_0|size_subbuffer_0|buffer_part_1|size_subbuffer_1|buffer_part_2|
+  ///
+  /// Procedure<void (const void*, std::size_t)> Proc
+  template<typename Proc>
+  void forEachMessageChunk(const Message& msg, Proc proc)
   {
-    // header buffer
-    ConstBuffer<N> headerBuffer = N::buffer(static_cast<const void*>(&msg.header()),
-      sizeof(Message::Header));
-    std::vector<ConstBuffer<N>> buffers;
+    proc(static_cast<const void*>(&msg.header()), sizeof(Message::Header));
     const auto& msgBuffer = msg.buffer();
 
-    // A buffer has a header and data.
-    // Inside data, subbuffers' sizes are interleaved.
-    // Subbuffers are _not_ inside the buffer, but in separate memory.
-    // We're going to send to the network:
-    // - the header
-    // - for all subbuffers:
-    //  - the data chunk in the main buffer up to (and including) the subbuffer's size
-    //  - the subbuffer
-    // - the last data chunk in the main buffer
-    //
-    // Memory layout for a buffer with 2 subbuffers:
-    // (low address)                                                         (high address)
-    // |header|buffer_part_0|size_subbuffer_0|buffer_part_1|size_subbuffer_1|buffer_part_2|
-    buffers.reserve(1 + 2 * msgBuffer.subBuffers().size() + 1);
-    buffers.push_back(headerBuffer);
-
     decltype(msgBuffer.size()) beginOffset = 0;
     // subbuffers
     for (const auto& sub: msgBuffer.subBuffers())
@@ -62,19 +58,162 @@ namespace qi { namespace sock {
       const auto sizeOffset = sub.first;
       auto endOffset = sizeOffset + sizeof(Buffer::size_type);
       if (endOffset != beginOffset)
-        buffers.push_back(N::buffer(
-          static_cast<const char*>(msgBuffer.data()) + beginOffset, endOffset - beginOffset));
+        proc(static_cast<const char*>(msgBuffer.data()) + beginOffset, endOffset - beginOffset);
       beginOffset = endOffset;
       // subbuffer
       const auto& subBuffer = sub.second;
-      buffers.push_back(N::buffer(subBuffer.data(), subBuffer.size()));
+      proc(subBuffer.data(), subBuffer.size());
     }
     // end of main buffer
-    buffers.push_back(N::buffer(
-      static_cast<const char*>(msgBuffer.data()) + beginOffset, msgBuffer.size() - beginOffset));
+    proc(static_cast<const char*>(msgBuffer.data()) + beginOffset, msgBuffer.size() - beginOffset);
+  }
+
+  /// Calls the procedure on each chunk of memory of `count` messages starting
+  /// at `first`, in order. See `forEachMessageChunk`.
+  ///
+  /// ForwardIterator<Message> I, Procedure<void (const void*, std::size_t)> Proc
+  template<typename I, typename Proc>
+  void forEachMessagesChunk(I first, std::size_t count, Proc proc)
+  {
+    for (std::size_t i = 0; i < count; ++i, ++first)
+      forEachMessageChunk(*first, proc);
+  }
+
+  /// Make network buffers for `count` messages starting at `first`, in order.
+  ///
+  /// For each message, one buffer is for the header and the others are for data.
+  /// See `forEachMessageChunk` for the layout.
+  ///
+  /// Network N, ForwardIterator<Message> I
+  template<typename N, typename I>
+  std::vector<ConstBuffer<N>> makeBuffers(I first, std::size_t count)
+  {
+    std::vector<ConstBuffer<N>> buffers;
+    std::size_t bufferCount = 0;
+    auto it = first;
+    for (std::size_t i = 0; i < count; ++i, ++it)
+      bufferCount += 1 + 2 * it->buffer().subBuffers().size() + 1;
+    buffers.reserve(bufferCount);
+    forEachMessagesChunk(first, count, [&](const void* data, std::size_t size) {
+      buffers.push_back(N::buffer(data, size));
+    });
+    return buffers;
+  }
+
+  /// Make network buffers for the given message.
+  ///
+  /// Network N
+  template<typename N>
+  std::vector<ConstBuffer<N>> makeBuffers(const Message& msg)
+  {
+    return makeBuffers<N>(&msg, 1);
+  }
+
+  /// Maximum size of the plaintext of a TLS record.
+  static const std::size_t sslMaxRecordSize = 16 * 1024;
+
+  /// Make network buffers for `count` messages starting at `first`, coalescing
+  /// their small chunks.
+  ///
+  /// With SSL, each buffer of a sequence is encrypted into its own record, so
+  /// sending the header and the subbuffers' sizes as separate buffers produces
+  /// many tiny records. Chunks smaller than `maxRecordSize` are therefore
+  /// copied into `storage`, in contiguous blocks of at most `maxRecordSize`
+  /// bytes, across the messages. Bigger chunks are referred to in place, as
+  /// they already fill whole records.
+  ///
+  /// Precondition: `storage` must not be modified and must outlive the
+  ///   returned buffers.
+  ///
+  /// Network N, ForwardIterator<Message> I
+  template<typename N, typename I>
+  std::vector<ConstBuffer<N>> makeCoalescedBuffers(I first, std::size_t count,
+    std::vector<char>& storage, std::size_t maxRecordSize = sslMaxRecordSize)
+  {
+    // Reserving upfront guarantees that the storage is never reallocated,
+    // which would invalidate the buffers already made.
+    std::size_t coalescedSize = 0;
+    forEachMessagesChunk(first, count, [&](const void*, std::size_t size) {
+      if (size < maxRecordSize)
+        coalescedSize += size;
+    });
+    storage.clear();
+    storage.reserve(coalescedSize);
+
+    std::vector<ConstBuffer<N>> buffers;
+    std::size_t blockBegin = 0;
+    auto flushBlock = [&] {
+      if (storage.size() != blockBegin)
+        buffers.push_back(N::buffer(static_cast<const void*>(storage.data() + blockBegin),
+                                   storage.size() - blockBegin));
+      blockBegin = storage.size();
+    };
+    forEachMessagesChunk(first, count, [&](const void* data, std::size_t size) {
+      if (size == 0)
+        return;
+      if (size >= maxRecordSize)
+      {
+        flushBlock();
+        buffers.push_back(N::buffer(data, size));
+        return;
+      }
+      if (storage.size() - blockBegin + size > maxRecordSize)
+        flushBlock();
+      const auto bytes = static_cast<const char*>(data);
+      storage.insert(storage.end(), bytes, bytes + size);
+    });
+    flushBlock();
     return buffers;
   }
 
+  /// Make network buffers for the given message, coalescing its small chunks.
+  ///
+  /// Network N
+  template<typename N>
+  std::vector<ConstBuffer<N>> makeCoalescedBuffers(const Message& msg, std::vector<char>& storage,
+    std::size_t maxRecordSize = sslMaxRecordSize)
+  {
+    return makeCoalescedBuffers<N>(&msg, 1, storage, maxRecordSize);
+  }
+
+  /// Make the network buffers to write `count` messages starting at `first`.
+  ///
+  /// With SSL, the buffers are coalesced into a newly allocated `storage`,
+  /// which must be kept alive until the write is complete.
+  ///
+  /// Network N, ForwardIterator<Message> I
+  template<typename N, typename I>
+  std::vector<ConstBuffer<N>> makeWriteBuffers(I first, std::size_t count, SslEnabled ssl,
+    std::shared_ptr<std::vector<char>>& storage)
+  {
+    if (*ssl)
+    {
+      storage = std::make_shared<std::vector<char>>();
+      return makeCoalescedBuffers<N>(first, count, *storage);
+    }
+    return makeBuffers<N>(first, count);
+  }
+
+  /// Write the buffers through the socket, or through its next layer if SSL
+  /// is disabled.
+  ///
+  /// Network N,
+  /// Mutable<SslSocket<N>> S,
+  /// Procedure<void (ErrorCode<N>, std::size_t)> H
+  template<typename N, typename S, typename H>
+  void asyncWriteBuffers(const S& socket, std::vector<ConstBuffer<N>> buffers, SslEnabled ssl,
+    const H& handler)
+  {
+    if (*ssl)
+    {
+      N::async_write(*socket, std::move(buffers), handler);
+    }
+    else
+    {
+      N::async_write((*socket).next_layer(), std::move(buffers), handler);
+    }
+  }
+
   /// Send a message through the socket and call the handler when the operation
   /// is complete, successfully or not.
   ///
@@ -112,21 +251,53 @@ namespace qi { namespace sock {
   void sendMessage(const S& socket, M cptrMsg, Proc onSent, SslEnabled ssl,
       F0 lifetimeTransfo = {}, F1 syncTransfo = {})
   {
-    auto buffers = makeBuffers<N>(*cptrMsg);
+    // With SSL, the coalesced chunks are kept alive until the write is complete.
+    std::shared_ptr<std::vector<char>> storage;
+    auto buffers = makeWriteBuffers<N>(&*cptrMsg, 1, ssl, storage);
     auto writeCont = syncTransfo(lifetimeTransfo([=](ErrorCode<N> erc, size_t /*len*/) mutable {
+      storage.reset();
       if (auto optionalCptrNextMsg = onSent(erc, cptrMsg))
       {
         sendMessage<N>(socket, *optionalCptrNextMsg, onSent, ssl, lifetimeTransfo, syncTransfo);
       }
     }));
-    if (*ssl)
-    {
-      N::async_write(*socket, std::move(buffers), writeCont);
-    }
-    else
-    {
-      N::async_write((*socket).next_layer(), std::move(buffers), writeCont);
-    }
+    asyncWriteBuffers<N>(socket, std::move(buffers), ssl, writeCont);
+  }
+
+  /// Send `count` messages starting at `first` through the socket with a single
+  /// write, and call the handler when the operation is complete, successfully
+  /// or not.
+  ///
+  /// If the handler returns a new range of messages, it is immediately sent.
+  ///
+  /// Precondition: The messages of the range must be valid until the handler
+  ///   has been called.
+  ///
+  /// Precondition: This function must not be called while messages are already
+  ///   being sent. It is possible to call it again only once the handler has
+  ///   been called.
+  ///
+  /// Network N,
+  /// Mutable<SslSocket<N>> S,
+  /// ForwardIterator<Message> I,
+  /// Procedure<Optional<std::pair<I, std::size_t>> (ErrorCode<N>, I, std::size_t)> Proc,
+  /// Transformation<Procedure> F0,
+  /// Transformation<Procedure<void (Args...)>> F1
+  template<typename N, typename S, typename I, typename Proc, typename F0 = IdTransfo, typename F1 = IdTransfo>
+  void sendMessages(const S& socket, I first, std::size_t count, Proc onSent, SslEnabled ssl,
+      F0 lifetimeTransfo = {}, F1 syncTransfo = {})
+  {
+    // With SSL, the coalesced chunks are kept alive until the write is complete.
+    std::shared_ptr<std::vector<char>> storage;
+    auto buffers = makeWriteBuffers<N>(first, count, ssl, storage);
+    auto writeCont = syncTransfo(lifetimeTransfo([=](ErrorCode<N> erc, size_t /*len*/) mutable {
+      storage.reset();
+      if (auto next = onSent(erc, first, count))
+      {
+        sendMessages<N>(socket, next->first, next->second, onSent, ssl, lifetimeTransfo, syncTransfo);
+      }
+    }));
+    asyncWriteBuffers<N>(socket, std::move(buffers), ssl, writeCont);
   }
 
   /// Functor that sends messages through a socket.
@@ -178,7 +349,22 @@ namespace qi { namespace sock {
              typename F0 = IdTransfo, typename F1 = IdTransfo>
     void operator()(Msg&&, SslEnabled, Proc onSent = Proc{true},
       const F0& lifetimeTransfo = F0{}, const F1& syncTransfo = F1{});
+
+    /// Enqueues all the messages at once, so that they are written together.
+    ///
+    /// Procedure<bool (ErrorCode<N>, Readable<Message>)> Proc,
+    /// Transformation<Procedure> F0,
+    /// Transformation<Procedure<void (Args...)>> F1
+    template<typename Proc = NoOpProcedure<bool (ErrorCode<N>, ReadableMessage)>,
+             typename F0 = IdTransfo, typename F1 = IdTransfo>
+    void sendAll(std::vector<Message>&&, SslEnabled, Proc onSent = Proc{true},
+      const F0& lifetimeTransfo = F0{}, const F1& syncTransfo = F1{});
   private:
+    /// Procedure<void ()> Append
+    template<typename Append, typename Proc, typename F0, typename F1>
+    void enqueue(Append append, SslEnabled, Proc onSent, const F0& lifetimeTransfo,
+      const F1& syncTransfo);
+
     S _socket;
     /// A list is used because we need the iterators not to be invalidated by
     /// insertions at begin or end, which is not the case with deque.
@@ -188,65 +374,88 @@ namespace qi { namespace sock {
     std::mutex _sendMutex;
   };
 
-  // Lemma SendMessageEnqueue.0:
-  //  If a message is already being sent, the message is queued without
-  //  invalidating the one being sent.
-  // Proof:
-  //  All messages are put in the send queue, including the one being sent.
-  //  The send queue is a list so adding an element doesn't invalidate the other ones.
   template<typename N, typename S>
   template<typename Msg, typename Proc, typename F0, typename F1>
   void SendMessageEnqueue<N, S>::operator()(Msg&& msg, SslEnabled ssl, Proc onSent,
       const F0& lifetimeTransfo, const F1& syncTransfo)
   {
     qiLogDebug(logCategory()) << _socket.get() << " SendMessageEnqueue()(" << msg.type() << ": " << msg.address() << ", ssl=" << *ssl << ")";
+    enqueue([&] { _sendQueue.emplace_back(std::forward<Msg>(msg)); },
+      ssl, std::move(onSent), lifetimeTransfo, syncTransfo);
+  }
+
+  template<typename N, typename S>
+  template<typename Proc, typename F0, typename F1>
+  void SendMessageEnqueue<N, S>::sendAll(std::vector<Message>&& msgs, SslEnabled ssl,
+      Proc onSent, const F0& lifetimeTransfo, const F1& syncTransfo)
+  {
+    qiLogDebug(logCategory()) << _socket.get() << " SendMessageEnqueue::sendAll(" << msgs.size() << " messages, ssl=" << *ssl << ")";
+    if (msgs.empty())
+      return;
+    enqueue([&] {
+        for (auto& msg : msgs)
+          _sendQueue.emplace_back(std::move(msg));
+      },
+      ssl, std::move(onSent), lifetimeTransfo, syncTransfo);
+  }
+
+  // Lemma SendMessageEnqueue.0:
+  //  If messages are already being sent, the new ones are queued without
+  //  invalidating the ones being sent.
+  // Proof:
+  //  All messages are put in the send queue, including the ones being sent.
+  //  The send queue is a list so adding an element doesn't invalidate the other ones.
+  template<typename N, typename S>
+  template<typename Append, typename Proc, typename F0, typename F1>
+  void SendMessageEnqueue<N, S>::enqueue(Append append, SslEnabled ssl, Proc onSent,
+      const F0& lifetimeTransfo, const F1& syncTransfo)
+  {
     using I = decltype(_sendQueue.begin());
-    I itMsg;
+    I itFirst;
+    std::size_t count = 0;
     bool mustStartSendLoop = false;
     {
       std::lock_guard<std::mutex> lock{_sendMutex};
-      _sendQueue.emplace_back(std::forward<Msg>(msg));
-      itMsg = _sendQueue.begin();
-      // We've just added a message to the queue, so if we are not currently sending,
+      append();
+      // We've just added messages to the queue, so if we are not currently sending,
       // we must (re)start the send loop.
       if (!_sending)
       {
         _sending = true;
         mustStartSendLoop = true;
+        itFirst = _sendQueue.begin();
+        count = _sendQueue.size();
       }
     }
     if (mustStartSendLoop)
     {
       // Lemma SendMessageEnqueue.1:
-      //  When calling sendMessage, itMsg is still valid.
+      //  When calling sendMessages, the `count` messages from itFirst are still valid.
       // Proof:
       //  The send queue is a std::list, so inserting or erasing other elements
-      //  doesn't invalidate the iterator.
-      //  Each thread adds a message to the send queue. But only one at a time
-      //  can enter this branch (by tryRaiseAtomicFlag.0).
-      //  Also, the sending flag is only modified while the queue is locked, so
-      //  the scenario where a thread B adds a message to the queue, is suspended
-      //  just before evaluating the condition of this branch, then the sending loop
-      //  thread A clears the queue, and then the thread B resumes, is correctly handled.
-      //  Moreover, this branch results in exactly one message being removed from
-      //  the send queue (by SendMessageEnqueue.2).
-      //  Therefore, at this point the number of messages in the send queue is
-      //  always at least 1.
+      //  doesn't invalidate the iterators.
+      //  Only one thread at a time can enter this branch, because the sending
+      //  flag is only modified while the queue is locked. The range was taken
+      //  under the same lock, and only the send loop erases messages from the
+      //  queue, once they are written (by SendMessageEnqueue.2).
 
       // Lemma SendMessageEnqueue.2:
-      //  eraseAndReturnNextMessage erases from the send queue the element pointed
-      //  by the given iterator, even if an exception is thrown.
-      auto eraseAndReturnNextMessage =
-        [&, onSent](ErrorCode<N> erc, I itSent) mutable -> boost::optional<I> {
+      //  eraseAndReturnNextMessages erases from the send queue the written
+      //  messages, even if an exception is thrown, and returns every message
+      //  queued in the meantime, so that they are written together.
+      auto eraseAndReturnNextMessages =
+        [&, onSent](ErrorCode<N> erc, I itSent, std::size_t sentCount) mutable
+          -> boost::optional<std::pair<I, std::size_t>> {
           // It's ok to allow new sendings once the current one is complete.
           bool mustContinue = false;
-          boost::optional<I> itNext;
+          boost::optional<std::pair<I, std::size_t>> next;
           try
           {
             // A scoped is used to cope with potential exception thrown by onSent.
             auto scopedErase = scoped([&] {
               std::lock_guard<std::mutex> lock{_sendMutex};
-              _sendQueue.erase(itSent);
+              for (std::size_t i = 0; i < sentCount; ++i)
+                itSent = _sendQueue.erase(itSent);
               if (!mustContinue || _sendQueue.empty())
               {
                 QI_ASSERT(_sending);
@@ -255,19 +464,25 @@ namespace qi { namespace sock {
                 _sending = false;
                 return;
               }
-              itNext = _sendQueue.begin();
+              next = std::make_pair(_sendQueue.begin(), _sendQueue.size());
             });
-            mustContinue = onSent(erc, itSent);
+            // All the messages have been written together, so each one is
+            // reported, even after the handler has asked to stop.
+            bool allContinue = true;
+            auto it = itSent;
+            for (std::size_t i = 0; i < sentCount; ++i, ++it)
+              allContinue = onSent(erc, ReadableMessage{it}) && allContinue;
+            mustContinue = allContinue;
           }
           catch (const std::exception& e)
           {
             qiLogError(logCategory()) << "Error in post-send phase: " << e.what();
             throw;
           }
-          return itNext;
+          return next;
         };
 
-      sendMessage<N>(_socket, itMsg, std::move(eraseAndReturnNextMessage), ssl,
+      sendMessages<N>(_socket, itFirst, count, std::move(eraseAndReturnNextMessages), ssl,
         lifetimeTransfo, syncTransfo);
     }
   }
@@ -44,9 +44,13 @@ namespace qi { namespace sock {
       socket.set_verify_mode(x);
     }
 
+    /// On client side, a previous TLS session with the same remote endpoint is
+    /// resumed if possible, and the new sessions are stored for later connections.
     template<typename H>
     void async_handshake(handshake_type x, H h)
     {
+      if (x == handshake_type::client)
+        N::sslResumeSession(socket);
       socket.async_handshake(x, h);
     }
 
@@ -60,6 +64,11 @@ namespace qi { namespace sock {
       return socket.next_layer();
     }
 
+    typename socket_t::native_handle_type native_handle()
+    {
+      return socket.native_handle();
+    }
+
   // Custom:
     template<typename T, typename U>
     void async_read_some(const T& buffers, const U& handler)
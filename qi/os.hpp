@@ -574,6 +574,18 @@ namespace qi {
      * \endverbatim
      */
     QI_API bool setCurrentThreadCPUAffinity(const std::vector<int> &cpus);
+    /**
+     *  \brief Set the scheduling priority of the current thread.
+     *  \param priority With realTime, the priority of the thread in the FIFO
+     *  real-time policy (1 to 99 on Linux). Otherwise, its nice value
+     *  (-20 to 19 on Linux, lower values being higher priorities).
+     *  \param realTime If true, switch the thread to the SCHED_FIFO policy.
+     *  \return true on success
+     *  \warning Real-time scheduling and negative nice values usually require
+     *  privileges. On Windows the value is mapped onto the thread priority levels.
+     *  Nice values are not per-thread and have no effect outside of Linux.
+     */
+    QI_API bool setCurrentThreadPriority(int priority, bool realTime = false);
     /**
      *  \brief Get the number of CPUs on the local machin
      *  \return Number of CPUs
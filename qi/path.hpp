@@ -225,6 +225,16 @@ namespace qi
        */
       QI_API void clearOptionalSdkPrefix();
 
+      /**
+       * \brief Forget the cached content of the SDK prefixes.
+       *
+       * The lib, bin and data directories of the SDK prefixes are indexed
+       * the first time they are searched. Call this function after files
+       * have been added to or removed from them.
+       * The user writable path is never cached.
+       */
+      QI_API void invalidateCache();
+
       /**
        * \brief Set the writable files path for users.
        * \param path Path to the new writable data path
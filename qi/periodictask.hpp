@@ -5,6 +5,7 @@
 #ifndef _QI_PERIODICTASK_HPP_
 # define _QI_PERIODICTASK_HPP_
 
+# include <cstdint>
 # include <string>
 
 # include <boost/function.hpp>
@@ -30,6 +31,37 @@ namespace qi
     /// \brief Callback is a boost::function.
     using Callback = boost::function<void()>;
 
+    /// How the calls are scheduled.
+    enum class Scheduling
+    {
+      /// The next call is scheduled one period after the end of the previous
+      /// one, or after its start if compensateCallbackTime() is set. Delays
+      /// accumulate over time. This is the default.
+      Relative,
+      /// The calls are scheduled on absolute deadlines: the k-th call is due
+      /// at start + k * period, whatever the duration of the previous calls.
+      /// The deadlines missed because a call overran are skipped.
+      FixedRateSkip,
+      /// Same as FixedRateSkip, but the missed deadlines are not skipped: the
+      /// calls are made one after the other until the task is on time again.
+      FixedRateCatchUp,
+    };
+
+    /// Measures of the scheduling of the calls since start().
+    struct Statistics
+    {
+      /// Number of calls.
+      std::uint64_t calls = 0;
+      /// Number of calls that ended after the deadline of the next call.
+      std::uint64_t overruns = 0;
+      /// Number of deadlines skipped (Scheduling::FixedRateSkip only).
+      std::uint64_t skipped = 0;
+      /// Delay between the deadline of a call and its actual start, the
+      /// largest one and the sum over all the calls.
+      qi::Duration maxJitter{0};
+      qi::Duration totalJitter{0};
+    };
+
     /// \brief Default constructor.
     PeriodicTask();
 
@@ -121,6 +153,15 @@ namespace qi
      */
     void compensateCallbackTime(bool compensate);
 
+    /**
+     * Set how the calls are scheduled, Scheduling::Relative by default.
+     * Takes effect at the next call.
+     */
+    void setScheduling(Scheduling scheduling);
+
+    /// \return The measures of the scheduling of the calls since start().
+    Statistics statistics() const;
+
     /// \brief Set name for debugging and tracking purpose.
     /// \param name Name of the periodic task.
     void setName(const std::string& name);
@@ -25,6 +25,52 @@
 
 namespace qi {
 
+  /**
+   * \brief Limits on the calls a service executes at once.
+   *
+   * A call exceeding a limit waits until calls of the service finish, in a queue of at most
+   * maxQueued calls. When the queue is full, or if maxQueued is 0, the call fails with the
+   * error qi::serviceOverloadedError, without its arguments being decoded. 0 means no limit.
+   * Only the calls to the methods of the service are limited, not the internal requests such
+   * as signal connections.
+   *
+   * \includename{qi/session.hpp}
+   */
+  struct QI_API CallAdmissionPolicy
+  {
+    /// Number of calls the service executes at once.
+    unsigned int maxCalls = 0;
+    /// Number of calls the service executes at once for each client socket.
+    unsigned int maxCallsPerSocket = 0;
+    /// Number of calls waiting for others to finish.
+    unsigned int maxQueued = 0;
+
+    /**
+     * \brief Reads the policy of the services from the environment variables
+     * QI_SERVICE_MAX_CALLS, QI_SERVICE_MAX_CALLS_PER_SOCKET and QI_SERVICE_MAX_QUEUED_CALLS.
+     * \throw std::runtime_error if a variable cannot be parsed.
+     */
+    static CallAdmissionPolicy fromEnvironment();
+  };
+
+  /// \brief Counters of the admission of the calls to a service, see CallAdmissionPolicy.
+  struct CallAdmissionStatistics
+  {
+    /// Number of calls being executed.
+    unsigned int inFlight = 0;
+    /// Number of calls waiting for others to finish.
+    unsigned int queued = 0;
+    /// Number of calls admitted, immediately or after waiting.
+    uint64_t admitted = 0;
+    /// Number of calls that had to wait.
+    uint64_t delayed = 0;
+    /// Number of calls rejected.
+    uint64_t rejected = 0;
+  };
+
+  /// The error of the calls rejected because the service is overloaded.
+  QI_API extern const char* const serviceOverloadedError;
+
   class SessionPrivate;
   class AuthProvider;
   using AuthProviderPtr = boost::shared_ptr<AuthProvider>;
@@ -100,6 +146,20 @@ namespace qi {
     qi::FutureSync<unsigned int> registerService(const std::string &name, AnyObject object);
     qi::FutureSync<void>         unregisterService(unsigned int serviceId);
 
+    /**
+     * \brief Sets the limits on the calls a service registered on this session executes at once.
+     * The services use CallAdmissionPolicy::fromEnvironment() by default, read once per process.
+     * If the environment cannot be parsed, a warning is logged and the calls are not limited.
+     * \throw std::runtime_error if no service of that name is registered on this session.
+     */
+    void setCallAdmissionPolicy(const std::string& serviceName, const CallAdmissionPolicy& policy);
+
+    /**
+     * \brief Returns the counters of the admission of the calls to a service registered on this session.
+     * \throw std::runtime_error if no service of that name is registered on this session.
+     */
+    CallAdmissionStatistics callAdmissionStatistics(const std::string& serviceName) const;
+
 
     void setAuthProviderFactory(AuthProviderFactoryPtr);
     void setClientAuthenticatorFactory(ClientAuthenticatorFactoryPtr);
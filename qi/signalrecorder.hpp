@@ -0,0 +1,207 @@
+#pragma once
+
+#ifndef _QI_SIGNALRECORDER_HPP_
+#define _QI_SIGNALRECORDER_HPP_
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <qi/anyobject.hpp>
+#include <qi/api.hpp>
+#include <qi/clock.hpp>
+#include <qi/future.hpp>
+#include <qi/signal.hpp>
+#include <qi/trackable.hpp>
+
+#ifdef _MSC_VER
+#  pragma warning( push )
+#  pragma warning( disable: 4251 )
+#endif
+
+namespace qi
+{
+namespace detail
+{
+  class SignalRecorderPrivate;
+  class SignalPlayerPrivate;
+  struct Playback;
+}
+
+/**
+ * @brief Records the emissions of signals into a bag, to be replayed by a SignalPlayer.
+ *
+ * A bag is a directory of append-only segment files, mapped in memory. Each emission is
+ * serialized in the thread emitting the signal and copied in the current segment at an
+ * offset reserved atomically: no lock is taken unless a new segment has to be created.
+ *
+ * Unlike SignalSpy, the recorded arguments are not kept in memory, which suits long
+ * recordings of high rate signals.
+ *
+ * A segment file is made of:
+ * - uint32 magic, fileMagic
+ * - uint32 version, fileVersion
+ * - int64 nanoseconds since the epoch (SystemClock) when the recording started
+ * - records, aligned on 8 bytes, up to the first size field of 0:
+ *   - uint32 size of the payload plus one, written last
+ *   - uint32 channel, or channelDeclaration
+ *   - int64 nanoseconds since the recording started (SteadyClock)
+ *   - the arguments, as serialized by encodeBinary.
+ *   The payload of a declaration is the channel id, its name and its signature.
+ */
+class QI_API SignalRecorder
+{
+public:
+  static const qi::uint32_t fileMagic = 0x47414251; // "QBAG"
+  static const qi::uint32_t fileVersion = 2;
+  static const qi::uint32_t channelDeclaration = 0xFFFFFFFF;
+  static const std::size_t defaultSegmentSize = 64 * 1024 * 1024;
+
+  /**
+   * @param directory The bag, created if needed. The segments it contains are overwritten.
+   * @param segmentSize The size of the segment files. Emissions that do not fit in a
+   * segment are dropped.
+   * @throw std::runtime_error if the first segment cannot be created.
+   */
+  explicit SignalRecorder(const std::string& directory,
+                          std::size_t segmentSize = defaultSegmentSize);
+
+  // Non-copyable
+  SignalRecorder(const SignalRecorder&) = delete;
+  SignalRecorder& operator=(const SignalRecorder&) = delete;
+
+  /// Stops recording, and truncates the last segment to the recorded size.
+  ~SignalRecorder();
+
+  /**
+   * Records the emissions of a signal, until the recorder is destroyed.
+   * The signal may be destroyed before the recorder.
+   * @return The channel of the emissions in the bag.
+   */
+  template<typename... Args>
+  unsigned int record(SignalF<void(Args...)>& signal, const std::string& channelName)
+  {
+    const unsigned int channel = addChannel(channelName, {typeOf<Args>()...});
+    std::weak_ptr<detail::SignalRecorderPrivate> weakPrivate = _p;
+    // Destroyed with the subscriber, when it is disconnected or when the signal is destroyed.
+    std::shared_ptr<void> subscribed = std::make_shared<bool>(true);
+    const SignalLink link = signal.connect([weakPrivate, channel, subscribed](const Args&... args)
+    {
+      if (auto p = weakPrivate.lock())
+        write(*p, channel, AnyReferenceVector{AnyReference::from(args)...});
+    }).setCallType(MetaCallType_Direct);
+    _signalLinks.push_back(SignalConnection{&signal, link, subscribed});
+    return channel;
+  }
+
+  /**
+   * Records the emissions of a signal or of a property of a local or remote object.
+   * The name of the channel defaults to the name of the signal.
+   * @throw std::runtime_error if the object has no such signal or property.
+   */
+  unsigned int record(AnyObject object, const std::string& signalOrPropertyName,
+                      const std::string& channelName = std::string());
+
+  /// Writes the recorded emissions to the disk.
+  void flush();
+
+  /// The number of emissions recorded.
+  std::size_t recordCount() const;
+
+  /// The number of emissions dropped because they did not fit in a segment.
+  std::size_t droppedCount() const;
+
+private:
+  unsigned int addChannel(const std::string& name, const std::vector<TypeInterface*>& types);
+  static void write(detail::SignalRecorderPrivate& p, unsigned int channel,
+                    const AnyReferenceVector& args);
+
+  struct SignalConnection
+  {
+    SignalBase* signal;
+    SignalLink link;
+    /// Expires when the signal no longer holds the subscriber.
+    std::weak_ptr<void> subscribed;
+  };
+
+  std::shared_ptr<detail::SignalRecorderPrivate> _p;
+  std::vector<std::pair<AnyObject, SignalLink>> _links;
+  std::vector<SignalConnection> _signalLinks;
+};
+
+/**
+ * @brief Reads a bag written by a SignalRecorder.
+ *
+ * The records are indexed by time when the bag is opened, they can then be accessed
+ * at random or re-emitted on signals with their original timing.
+ */
+class QI_API SignalPlayer : public Trackable<SignalPlayer>
+{
+public:
+  /// @throw std::runtime_error if the directory does not contain a bag.
+  explicit SignalPlayer(const std::string& directory);
+
+  // Non-copyable
+  SignalPlayer(const SignalPlayer&) = delete;
+  SignalPlayer& operator=(const SignalPlayer&) = delete;
+
+  ~SignalPlayer();
+
+  struct Channel
+  {
+    unsigned int id;
+    std::string name;
+    Signature signature;
+  };
+
+  /// A recorded emission.
+  struct Record
+  {
+    /// The time of the emission, since the recording started.
+    NanoSeconds time;
+    unsigned int channel;
+    std::vector<AnyValue> args;
+  };
+
+  /// The channels of the bag, ordered by id.
+  const std::vector<Channel>& channels() const;
+
+  /// When the recording started.
+  SystemClockTimePoint startTime() const;
+
+  /// The number of records.
+  std::size_t recordCount() const;
+
+  /// Direct access to a record, by order of time.
+  /// @throw std::runtime_error if the index is out of range.
+  Record record(std::size_t index) const;
+
+  /// The index of the first record emitted at or after the given time, recordCount() if none.
+  std::size_t seek(NanoSeconds time) const;
+
+  /// The records of the channel are emitted on the signal when playing.
+  void setTarget(unsigned int channel, SignalBase& signal);
+
+  /// The records of the channel are emitted on the signal of the object when playing.
+  void setTarget(unsigned int channel, AnyObject object, const std::string& signalName);
+
+  /**
+   * Emits the records from the given index on their target signals, in order.
+   * Targets must not be changed while playing.
+   * @param speed The factor applied to the original timing, 2 replays twice as fast.
+   * A speed of 0 or less replays as fast as possible.
+   * @return A future set when all the records are emitted, that can be cancelled to stop.
+   */
+  Future<void> play(double speed = 1.0, std::size_t from = 0);
+
+private:
+  void playFrom(std::shared_ptr<detail::Playback> playback, std::size_t index);
+
+  std::unique_ptr<detail::SignalPlayerPrivate> _p;
+};
+}
+
+#ifdef _MSC_VER
+#  pragma warning( pop )
+#endif
+
+#endif  // _QI_SIGNALRECORDER_HPP_
@@ -10,6 +10,9 @@
 
 # include <sstream>
 # include <algorithm>
+# include <string>
+# include <vector>
+# include <qi/types.hpp>
 
 namespace qi
 {
@@ -145,6 +148,96 @@ namespace qi
     MinMaxSum _user;
     MinMaxSum _system;
   };
+
+  /// Distribution of durations, in buckets of exponentially growing width.
+  struct DurationHistogram
+  {
+    static const unsigned int bucketCount = 24;
+
+    /// counts[i] is the number of durations shorter than 2^i microseconds not counted
+    /// in the previous buckets. The last bucket also counts all the longer durations.
+    std::vector<qi::uint64_t> counts = std::vector<qi::uint64_t>(bucketCount, 0);
+
+    /// Index of the bucket of a duration in microseconds.
+    static unsigned int bucketIndex(qi::int64_t us)
+    {
+      unsigned int index = 0;
+      while (us > 0 && index + 1 < bucketCount)
+      {
+        us >>= 1;
+        ++index;
+      }
+      return index;
+    }
+
+    /// Exclusive upper bound in microseconds of the durations counted in a bucket,
+    /// except for the last bucket which has none.
+    static qi::int64_t bucketUpperBoundUs(unsigned int index)
+    {
+      return qi::int64_t(1) << index;
+    }
+
+    /// Adds a duration in microseconds.
+    void push(qi::int64_t us)
+    {
+      ++counts[bucketIndex(us)];
+    }
+
+    /// Number of durations in the histogram.
+    qi::uint64_t total() const
+    {
+      qi::uint64_t sum = 0;
+      for (auto count : counts)
+        sum += count;
+      return sum;
+    }
+
+    /**
+     * \brief Upper bound in microseconds of the bucket holding a quantile.
+     * \param q The quantile, between 0 and 1, for instance 0.99 for the 99th percentile.
+     * \return 0 if the histogram is empty.
+     */
+    qi::int64_t quantileUs(double q) const
+    {
+      const qi::uint64_t all = total();
+      if (!all)
+        return 0;
+      const qi::uint64_t rank = static_cast<qi::uint64_t>(q * static_cast<double>(all));
+      qi::uint64_t seen = 0;
+      for (unsigned int i = 0; i < counts.size(); ++i)
+      {
+        seen += counts[i];
+        if (seen > rank || seen == all)
+          return bucketUpperBoundUs(i);
+      }
+      return bucketUpperBoundUs(static_cast<unsigned int>(counts.size()) - 1);
+    }
+  };
+
+  /// A task that ran for long on an execution context.
+  struct SlowTask
+  {
+    /// The type of the callable of the task, which usually points to its call site.
+    std::string name;
+    qi::int64_t runTimeUs = 0;
+  };
+
+  /// Statistics about the tasks executed by an execution context: an EventLoop or a Strand.
+  struct ExecutionStatistics
+  {
+    /// Tasks ready to run that have not started yet.
+    qi::int64_t queueDepth = 0;
+    /// Tasks running.
+    qi::int64_t activeTasks = 0;
+    /// Tasks that ran to completion, successfully or not.
+    qi::uint64_t completedTasks = 0;
+    /// Delays between the time a task is due and the time it starts.
+    DurationHistogram schedulingDelay;
+    /// Durations of the tasks.
+    DurationHistogram runTime;
+    /// The slowest tasks, the slowest first.
+    std::vector<SlowTask> slowestTasks;
+  };
 }
 
 #endif // !_QI_STATS_HPP_
@@ -11,6 +11,7 @@
 #include <atomic>
 #include <qi/assert.hpp>
 #include <qi/detail/executioncontext.hpp>
+#include <qi/detail/executionstatistics.hpp>
 #include <qi/detail/futureunwrap.hpp>
 #include <boost/enable_shared_from_this.hpp>
 #include <boost/shared_ptr.hpp>
@@ -49,16 +50,23 @@ public:
   using Queue = std::deque<boost::shared_ptr<Callback>>;
 
   qi::ExecutionContext& _eventLoop;
+  const TaskPriority _priority;
   std::atomic<unsigned int> _curId;
   std::atomic<unsigned int> _aliveCount;
   bool _processing; // protected by mutex, no need for atomic
   std::atomic<int> _processingThread;
   boost::recursive_mutex _mutex;
   boost::condition_variable_any _processFinished;
-  bool _dying;
+  std::atomic<bool> _dying; // atomic as it is checked between callbacks without the mutex
   Queue _queue;
+  unsigned int _highPriorityCount; // callbacks of high priority in _queue, protected by mutex
+  // The last posting of process, the previous ones do nothing when they run. Protected by mutex.
+  unsigned int _processPost;
+  TaskPriority _processPriority;
+  bool _processStarted;
+  detail::ExecutionStatisticsRecorder _statistics;
 
-  StrandPrivate(qi::ExecutionContext& eventLoop);
+  StrandPrivate(qi::ExecutionContext& eventLoop, TaskPriority priority = TaskPriority::Normal);
 
   // Schedules the callback for execution. If the trigger date `tp` is in the past, executes the
   // callback immediately in the calling thread.
@@ -68,13 +76,20 @@ public:
   // calling thread.
   Future<void> asyncDelayImpl(boost::function<void()> cb, qi::Duration delay) override;
 
+  // Same as asyncDelayImpl, the processing of the strand is scheduled on the event loop with
+  // the given priority while the callback is pending. Callbacks still run in order.
+  Future<void> asyncDelayWithPriorityImpl(boost::function<void()> cb, qi::Duration delay,
+                                          TaskPriority priority) override;
+
   // Schedules the callback for deferred execution and returns immediately.
-  Future<void> deferImpl(boost::function<void()> cb, qi::Duration delay);
+  Future<void> deferImpl(boost::function<void()> cb, qi::Duration delay,
+                         TaskPriority priority = TaskPriority::Normal);
 
-  boost::shared_ptr<Callback> createCallback(boost::function<void()> cb);
+  boost::shared_ptr<Callback> createCallback(boost::function<void()> cb,
+                                             TaskPriority priority = TaskPriority::Normal);
   void enqueue(boost::shared_ptr<Callback> cbStruct);
 
-  void process();
+  void process(unsigned int post);
   void cancel(boost::shared_ptr<Callback> cbStruct);
   bool isInThisContext() const override;
 
@@ -84,18 +99,30 @@ public:
   qi::Future<void> async(const boost::function<void()>& callback, qi::Duration delay) override
   { QI_ASSERT(false); throw 0; }
   using ExecutionContext::async;
+  // Fails the callbacks of the queue, which is emptied. _mutex must be locked.
+  void dropQueue(Queue& queue);
 private:
   void stopProcess(boost::recursive_mutex::scoped_lock& lock,
                    bool finished);
+  // Prepares a new posting of process, with the highest priority of the pending callbacks.
+  // _mutex must be locked.
+  unsigned int nextProcessPost();
+  void postProcess(unsigned int post, TaskPriority priority);
 };
 
-inline StrandPrivate::StrandPrivate(qi::ExecutionContext& eventLoop)
+inline StrandPrivate::StrandPrivate(qi::ExecutionContext& eventLoop, TaskPriority priority)
   : _eventLoop(eventLoop)
+  , _priority(priority)
   , _curId(0)
   , _aliveCount(0)
   , _processing(false)
   , _processingThread(0)
   , _dying(false)
+  , _highPriorityCount(0)
+  , _processPost(0)
+  , _processPriority(priority)
+  , _processStarted(false)
+  , _statistics("a strand")
 {
 }
 
@@ -116,6 +143,11 @@ public:
   Strand();
   /// Construct a strand that will schedule work on executionContext
   Strand(qi::ExecutionContext& executionContext);
+  /// Construct a strand that will schedule work on executionContext with the given priority,
+  /// for instance TaskPriority::High for a strand serializing latency-critical work.
+  /// The callbacks of the strand still run in order. A callback posted with a higher
+  /// priority raises the priority of the strand until it has run.
+  Strand(qi::ExecutionContext& executionContext, TaskPriority priority);
   /// Call detroy()
   ~Strand();
 
@@ -185,6 +217,12 @@ public:
    */
   Future<void> defer(const boost::function<void()>& cb);
 
+  /**
+   * \return The statistics of the tasks of the strand, see EventLoop::statistics. Empty if the
+   * strand was joined.
+   */
+  ExecutionStatistics statistics() const;
+
 private:
   boost::shared_ptr<StrandPrivate> _p;
 
@@ -193,6 +231,10 @@ private:
   qi::Future<void> asyncAtImpl(boost::function<void()> cb, qi::SteadyClockTimePoint tp) override;
   qi::Future<void> asyncDelayImpl(boost::function<void()> cb, qi::Duration delay) override;
 
+  void postWithPriorityImpl(boost::function<void()> callback, TaskPriority priority) override;
+  qi::Future<void> asyncDelayWithPriorityImpl(boost::function<void()> cb, qi::Duration delay,
+                                              TaskPriority priority) override;
+
   // DEPRECATED
   template <int N, typename T>
   struct SchedulerHelper;
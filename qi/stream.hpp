@@ -0,0 +1,73 @@
+#pragma once
+
+#ifndef _QI_STREAM_HPP_
+#define _QI_STREAM_HPP_
+
+#include <boost/function.hpp>
+#include <qi/anyobject.hpp>
+#include <qi/api.hpp>
+#include <qi/buffer.hpp>
+#include <qi/future.hpp>
+
+namespace qi
+{
+  /**
+   * \brief A source of raw data that is read piece by piece.
+   *
+   * A message is sent and received as a whole, so a large payload passed as
+   * a qi::Buffer is held in memory at once on both ends. A Stream lets the
+   * consumer pull the payload in chunks of bounded size instead, each chunk
+   * being a call to read(). Pass it as a qi::Object<qi::Stream> (or AnyObject)
+   * to a remote consumer, which reads it with qi::readStream.
+   *
+   * Only raw data is streamed: sub-buffers are not supported.
+   *
+   * \includename{qi/stream.hpp}
+   */
+  class QI_API Stream
+  {
+  public:
+    /// Produces the next chunk of at most maxSize bytes. An empty buffer marks
+    /// the end of the stream. Exceptions are reported to the reader.
+    using ChunkSource = boost::function<Buffer (std::size_t maxSize)>;
+
+    explicit Stream(ChunkSource source);
+
+    /// Streams a copy of buffer.
+    static Object<Stream> fromBuffer(const Buffer& buffer);
+
+    /// Streams the content of a file, reading it as chunks are requested.
+    /// @throw std::runtime_error if the file cannot be opened.
+    static Object<Stream> fromFile(const std::string& path);
+
+    /**
+     * \brief Read the next chunk of the stream.
+     * \param maxSize The maximum size of the chunk.
+     * \return The next chunk, empty if the end of the stream was reached.
+     */
+    Buffer read(std::size_t maxSize);
+
+  private:
+    ChunkSource _source;
+    bool _ended;
+  };
+
+  /// The size of the chunks requested by readStream by default.
+  static const std::size_t defaultStreamChunkSize = 1024 * 1024;
+
+  /**
+   * \brief Read a stream until its end.
+   * Chunks are requested one after the other and given to onChunk in order,
+   * so that at most one chunk is held in memory by the reader.
+   * \param stream A qi::Stream object, local or remote.
+   * \param onChunk Called with each chunk.
+   * \param chunkSize The maximum size of the requested chunks.
+   * \return A future set when the end of the stream is reached, or in error
+   * if reading the stream or onChunk failed.
+   */
+  QI_API Future<void> readStream(AnyObject stream,
+                                 boost::function<void (const Buffer&)> onChunk,
+                                 std::size_t chunkSize = defaultStreamChunkSize);
+}
+
+#endif  // _QI_STREAM_HPP_
@@ -43,6 +43,12 @@ namespace qi
     transform = b.transform;
   }
 
+  inline AnyFunction::AnyFunction(AnyFunction&& b)
+  : type(0), value(0)
+  {
+    swap(b);
+  }
+
   inline AnyFunction::AnyFunction(FunctionTypeInterface* type, void* value)
     : type(type)
     , value(value)
@@ -61,6 +67,16 @@ namespace qi
     return *this;
   }
 
+  inline AnyFunction& AnyFunction::operator=(AnyFunction&& b)
+  {
+    if (this == &b)
+      return *this;
+
+    AnyFunction tmp(std::move(b));
+    swap(tmp);
+    return *this;
+  }
+
   inline AnyFunction::~AnyFunction()
   {
     if (type)
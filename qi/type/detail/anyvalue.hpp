@@ -14,6 +14,11 @@ namespace qi {
    *  as a pointer to the real value.
    *  to convert the value if needed and copy to the required type.
    *
+   *  Builtin integers, booleans and floating points are stored inside the AnyValue
+   *  until their address is first exposed, by asReference(), rawValue(), convert(),
+   *  as() or ptr(): they are then moved to the heap, like the other values, so that
+   *  references keep following the value when it is swapped or moved.
+   *
    *  \includename{qi/anyvalue.hpp}
    */
   class QI_API AnyValue: public detail::AnyReferenceBase
@@ -26,6 +31,8 @@ namespace qi {
      */
     AnyValue();
     AnyValue(const AnyValue& b);
+    /// Takes the value of \p b without copying it, \p b is left invalid.
+    AnyValue(AnyValue&& b);
     explicit AnyValue(const AnyReference& b, bool copy, bool free);
     explicit AnyValue(const AutoAnyReference& b);
     explicit AnyValue(qi::TypeInterface *type);
@@ -35,7 +42,8 @@ namespace qi {
     /// @return the contained value, and reset the AnyValue.
     /// @warning you should destroy the returned value or no, depending on how the AnyValue was initialized.
     AnyReference release() {
-      AnyReference ref = AnyReference(_type, _value);
+      // An inline value dies with this object, hand out a heap copy instead.
+      AnyReference ref = AnyReference(_type, isInline() ? _type->clone(_value) : _value);
       _allocated = false;
       _value = 0;
       _type = 0;
@@ -72,6 +80,7 @@ namespace qi {
     ~AnyValue();
     AnyValue& operator=(const AnyReference& b);
     AnyValue& operator=(const AnyValue& b);
+    AnyValue& operator=(AnyValue&& b);
 
     void reset();
     void reset(qi::TypeInterface *type);
@@ -85,11 +94,43 @@ namespace qi {
     void swap(AnyValue& b);
 
     AnyReference asReference() const {
+      toHeap();
       //AnyRef == AnyRefBase
       return *reinterpret_cast<const AnyReference*>(
           static_cast<const detail::AnyReferenceBase*>(this));
     }
 
+    /// @{
+    /** The following functions expose the storage of the value, which is
+     * moved to the heap first if it was inline.
+     */
+    void* rawValue() const { toHeap(); return _value; }
+
+    using detail::AnyReferenceBase::convert;
+    std::pair<AnyReference, bool> convert(TypeInterface* targetType) const
+    {
+      toHeap();
+      return detail::AnyReferenceBase::convert(targetType);
+    }
+
+    template<typename T>
+    T* ptr(bool check = true) { toHeap(); return detail::AnyReferenceBase::ptr<T>(check); }
+
+    template<typename T>
+    T& as() { toHeap(); return detail::AnyReferenceBase::as<T>(); }
+
+    int64_t&     asInt64()  { return as<int64_t>();}
+    uint64_t&    asUInt64() { return as<uint64_t>();}
+    int32_t&     asInt32()  { return as<int32_t>();}
+    uint32_t&    asUInt32() { return as<uint32_t>();}
+    int16_t&     asInt16()  { return as<int16_t>();}
+    uint16_t&    asUInt16() { return as<uint16_t>();}
+    int8_t&      asInt8()   { return as<int8_t>();}
+    uint8_t&     asUInt8()  { return as<uint8_t>();}
+    double&      asDouble() { return as<double>();}
+    float&       asFloat()  { return as<float>();}
+    /// @}
+
     template<typename T>
     static AnyValue from(const T& r) {
       //explicit AutoAnyReference to avoid ambiguous call for object implementing cast to AnyValue
@@ -103,9 +144,34 @@ namespace qi {
 
     //we dont accept GVP here.  (block set<T> with T=GVP)
     void set(const AnyReference& t);
+
+    bool isInline() const { return _value == static_cast<const void*>(&_inline); }
+    bool resetInline(qi::TypeInterface* type, const void* src);
+    /// Moves an inline value to the heap, before its address is exposed.
+    void toHeap() const { if (isInline()) moveInlineToHeap(); }
+    void moveInlineToHeap() const;
+    /// A reference on the value that does not leave this AnyValue.
+    AnyReference internalReference() const { return AnyReference(_type, _value); }
+
     bool _allocated;
+    /* Builtin integers and floating points are stored here instead of on
+     * the heap, _value then points to this member.
+     */
+    union
+    {
+      int64_t i;
+      double d;
+      void* p;
+    } _inline;
   };
 
+  namespace detail
+  {
+    /// @return the size of the values of \p type if they can be stored inline
+    /// in an AnyValue, 0 otherwise.
+    QI_API std::size_t inlineStorageSize(TypeInterface* type);
+  }
+
   /// Less than operator. Will compare the values within the AnyValue.
   QI_API bool operator<(const AnyValue& a, const AnyValue& b);
 
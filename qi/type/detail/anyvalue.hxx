@@ -8,6 +8,7 @@
 #define _QI_TYPE_DETAIL_ANYVALUE_HXX_
 
 #include <cmath>
+#include <cstring>
 
 #include <boost/type_traits/remove_const.hpp>
 #include <boost/type_traits/is_floating_point.hpp>
@@ -113,10 +114,17 @@ inline AnyValue::AnyValue(const AnyValue& b)
   *this = b;
 }
 
+inline AnyValue::AnyValue(AnyValue&& b)
+: AnyReferenceBase()
+, _allocated(false)
+{
+  swap(b);
+}
+
 inline AnyValue::AnyValue(qi::TypeInterface *type)
-  : AnyReferenceBase(type)
-  , _allocated(true)
+: _allocated(false)
 {
+  reset(type);
 }
 
 inline AnyValue::AnyValue(const AnyReference& b, bool copy, bool free)
@@ -134,7 +142,7 @@ inline AnyValue::AnyValue(const AutoAnyReference& b)
 template<typename T>
 AnyValue AnyValue::make()
 {
-  return AnyValue(AnyReference(typeOf<T>()), false, true);
+  return AnyValue(typeOf<T>());
 }
 
 inline AnyValue& AnyValue::operator=(const AnyValue& b)
@@ -142,7 +150,18 @@ inline AnyValue& AnyValue::operator=(const AnyValue& b)
   if (&b == this)
     return *this;
 
-  reset(b.asReference(), true, true);
+  reset(b.internalReference(), true, true);
+  return *this;
+}
+
+inline AnyValue& AnyValue::operator=(AnyValue&& b)
+{
+  if (&b == this)
+    return *this;
+
+  // The previous value is destroyed with tmp.
+  AnyValue tmp(std::move(b));
+  swap(tmp);
   return *this;
 }
 
@@ -160,6 +179,8 @@ inline void AnyValue::reset(const AnyReference& b)
 inline void AnyValue::reset(const AnyReference& b, bool copy, bool free)
 {
   reset();
+  if (copy && resetInline(b.type(), b.rawValue()))
+    return;
   *(AnyReferenceBase*)this = b;
   _allocated = free;
   if (copy)
@@ -168,7 +189,7 @@ inline void AnyValue::reset(const AnyReference& b, bool copy, bool free)
 
 inline void AnyValue::reset()
 {
-  if (_allocated)
+  if (_allocated && !isInline())
     AnyReferenceBase::destroy();
   _type = 0;
   _value = 0;
@@ -177,11 +198,27 @@ inline void AnyValue::reset()
 inline void AnyValue::reset(qi::TypeInterface *ttype)
 {
   reset();
+  if (resetInline(ttype, 0))
+    return;
   _allocated = true;
   _type = ttype;
   _value = _type->initializeStorage();
 }
 
+inline bool AnyValue::resetInline(qi::TypeInterface* ttype, const void* src)
+{
+  const std::size_t size = ttype ? detail::inlineStorageSize(ttype) : 0;
+  if (!size)
+    return false;
+  _inline.i = 0;
+  if (src)
+    std::memcpy(&_inline, src, size);
+  _allocated = true;
+  _type = ttype;
+  _value = &_inline;
+  return true;
+}
+
 inline AnyValue::~AnyValue()
 {
   reset();
@@ -191,6 +228,12 @@ inline void AnyValue::swap(AnyValue& b)
 {
   std::swap((::qi::AnyReference&)*this, (::qi::AnyReference&)b);
   std::swap(_allocated, b._allocated);
+  std::swap(_inline, b._inline);
+  // Inline values moved along with their storage.
+  if (_value == &b._inline)
+    _value = &_inline;
+  if (b._value == &_inline)
+    b._value = &b._inline;
 }
 
 inline bool operator != (const AnyValue& a, const AnyValue& b)
@@ -230,12 +273,15 @@ inline AnyReferenceVector asAnyReferenceVector(const AnyValueVector& vect) {
 
 inline bool operator< (const AnyValue& a, const AnyValue& b)
 {
-  return a.asReference() < b.asReference();
+  // Comparing does not expose the values, they may stay inline.
+  return AnyReference(static_cast<const detail::AnyReferenceBase&>(a))
+       < AnyReference(static_cast<const detail::AnyReferenceBase&>(b));
 }
 
 inline bool operator==(const AnyValue& a, const AnyValue& b)
 {
-  return a.asReference() == b.asReference();
+  return AnyReference(static_cast<const detail::AnyReferenceBase&>(a))
+      == AnyReference(static_cast<const detail::AnyReferenceBase&>(b));
 }
 
 } // namespace qi
@@ -114,6 +114,10 @@ QI_TYPE_STRUCT_AGREGATE_CONSTRUCTOR(qi::EventTrace,
   ("calleeContext", calleeContext));
 
 QI_TYPE_STRUCT(qi::os::timeval, tv_sec, tv_usec);
+QI_TYPE_STRUCT(qi::DurationHistogram, counts);
+QI_TYPE_STRUCT(qi::SlowTask, name, runTimeUs);
+QI_TYPE_STRUCT(qi::ExecutionStatistics, queueDepth, activeTasks, completedTasks,
+               schedulingDelay, runTime, slowestTasks);
 
 namespace qi {
 
@@ -151,6 +155,11 @@ namespace qi {
     /// Reset all statistical data
     void clearStats();
 
+    /// Statistics of the execution contexts running the calls of the object: its strand
+    /// if it has one ("strand"), the global event loop ("eventloop") and the network
+    /// event loop ("network").
+    std::map<std::string, ExecutionStatistics> executionStats() const;
+
     /// Emitted each time a call starts and finishes, and for each signal trigger.
     Signal<EventTrace> traceObject;
 
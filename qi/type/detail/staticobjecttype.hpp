@@ -10,6 +10,7 @@
 #include <qi/api.hpp>
 #include <qi/property.hpp>
 #include <qi/anyvalue.hpp>
+#include <qi/detail/executioncontext.hpp>
 #include <qi/type/typeinterface.hpp>
 #include <qi/type/metaobject.hpp>
 
@@ -44,6 +45,10 @@ struct QI_API ObjectTypeData
 
   MethodMap methodMap;
 
+  /// Priority of the methods whose calls are scheduled with another priority than the normal one.
+  using MethodPriorityMap = std::map<unsigned int, TaskPriority>;
+  MethodPriorityMap methodPriority;
+
   TypeInterface* classType;
   std::vector<std::pair<TypeInterface*, int> > parentTypes;
   ObjectThreadingModel threadingModel;
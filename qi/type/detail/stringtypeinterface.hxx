@@ -9,6 +9,7 @@
 
 #include <algorithm>
 #include <qi/os.hpp>
+#include <qi/buffer.hpp>
 #include <qi/type/detail/structtypeinterface.hxx>
 
 namespace qi
@@ -50,6 +51,29 @@ namespace qi
   class TypeImpl<std::string>: public StringTypeInterfaceImpl
   {};
 
+  class QI_API TypeStringViewImpl: public StringTypeInterface
+  {
+  public:
+    using Methods = DefaultTypeImplMethods<StringView, TypeByPointerPOD<StringView>>;
+    ManagedRawString get(void* storage) override
+    {
+      StringView* ptr = (StringView*)Methods::ptrFromStorage(&storage);
+      return ManagedRawString(RawString(const_cast<char*>(ptr->data()), ptr->size()),
+          Deleter());
+    }
+    void set(void** storage, const char* value, size_t sz) override
+    {
+      StringView* ptr = (StringView*)Methods::ptrFromStorage(storage);
+      *ptr = StringView(value, sz);
+    }
+
+    _QI_BOUNCE_TYPE_METHODS(Methods);
+  };
+
+  template<>
+  class TypeImpl<StringView>: public TypeStringViewImpl
+  {};
+
   class QI_API TypeCStringImpl: public StringTypeInterface
   {
   public:
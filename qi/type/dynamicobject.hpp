@@ -46,6 +46,8 @@ namespace qi
     MetaObject &metaObject();
 
     void setMethod(unsigned int id, AnyFunction callable, MetaCallType threadingModel = MetaCallType_Auto);
+    /// Schedules the queued calls of the method with the given priority.
+    void setMethodPriority(unsigned int id, TaskPriority priority);
     void setSignal(unsigned int id, SignalBase* signal);
     void setProperty(unsigned int id, PropertyBase* property);
 
@@ -77,6 +77,10 @@ namespace qi {
 
     void setThreadingModel(ObjectThreadingModel model);
 
+    /// Schedules the queued calls of the method with the given priority, for instance
+    /// TaskPriority::High for a latency-critical method.
+    void setMethodPriority(unsigned int id, TaskPriority priority);
+
     unsigned int xAdvertiseMethod(const Signature &sigret,
                                   const std::string &name,
                                   const Signature &signature,
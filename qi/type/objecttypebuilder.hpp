@@ -98,6 +98,10 @@ namespace detail {
 
     void setThreadingModel(ObjectThreadingModel model);
 
+    /// Schedules the queued calls of the method with the given priority, for instance
+    /// TaskPriority::High for a latency-critical method.
+    void setMethodPriority(unsigned int id, TaskPriority priority);
+
     // output
     const MetaObject& metaObject();
     AnyObject object(void* ptr, boost::function<void (GenericObject*)> onDestroy = boost::function<void (GenericObject*)>());
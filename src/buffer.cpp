@@ -7,6 +7,7 @@
 #include <qi/buffer.hpp>
 #include <qi/log.hpp>
 
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
 #include <stdexcept>
@@ -98,11 +99,14 @@ namespace qi
 
   boost::optional<size_t> BufferPrivate::indexOfSubBuffer(size_t offset) const
   {
-    for(unsigned i = 0; i < _subBuffers.size(); ++i) {
-      if (_subBuffers[i].first == offset) {
-        return i;
-      }
-    }
+    // Sub-buffers are appended at the end of the buffer, so they are sorted
+    // by offset.
+    const auto it = std::lower_bound(_subBuffers.begin(), _subBuffers.end(), offset,
+        [](const std::pair<size_t, Buffer>& subBuffer, size_t offset) {
+          return subBuffer.first < offset;
+        });
+    if (it != _subBuffers.end() && it->first == offset)
+      return static_cast<size_t>(it - _subBuffers.begin());
 
     return {};
   }
@@ -304,6 +308,39 @@ namespace qi
     return (aHasBuffer == bHasBuffer) && (!aHasBuffer || *_p == *b._p);
   }
 
+  StringView::StringView()
+    : _data(nullptr)
+    , _size(0)
+  {
+  }
+
+  StringView::StringView(const char* data, size_t size)
+    : StringView(std::string(data, size))
+  {
+  }
+
+  StringView::StringView(const std::string& str)
+    : _data(nullptr)
+    , _size(str.size())
+  {
+    auto copy = boost::make_shared<std::string>(str);
+    _data = copy->data();
+    _owner = copy;
+  }
+
+  StringView::StringView(boost::shared_ptr<const void> owner, const char* data, size_t size)
+    : _owner(std::move(owner))
+    , _data(data)
+    , _size(size)
+  {
+  }
+
+  bool operator==(const StringView& a, const StringView& b)
+  {
+    return a.size() == b.size()
+        && (a.data() == b.data() || std::equal(a.data(), a.data() + a.size(), b.data()));
+  }
+
   namespace detail {
     void printBuffer(std::ostream& stream, const Buffer& buffer)
     {
@@ -64,6 +64,14 @@ namespace qi {
     return size;
   }
 
+  StringView BufferReader::readView(size_t length)
+  {
+    const void* p = read(length);
+    if (!p)
+      return StringView();
+    return StringView(_buffer->_p, static_cast<const char*>(p), length);
+  }
+
   bool BufferReader::hasSubBuffer() const
   {
     if (_buffer->subBuffers().size() <= _subCursor)
@@ -0,0 +1,56 @@
+#include <algorithm>
+
+#include <boost/thread/tss.hpp>
+
+#include <qi/deadline.hpp>
+
+namespace qi
+{
+  const char* const deadlineExpiredError = "Call dropped: its deadline expired";
+
+  namespace
+  {
+    boost::thread_specific_ptr<SteadyClockTimePoint>& threadDeadline()
+    {
+      // Never destroyed: calls may run during static destruction.
+      static auto* deadline = new boost::thread_specific_ptr<SteadyClockTimePoint>();
+      return *deadline;
+    }
+
+    void setThreadDeadline(const boost::optional<SteadyClockTimePoint>& deadline)
+    {
+      if (deadline)
+      {
+        if (SteadyClockTimePoint* current = threadDeadline().get())
+          *current = *deadline;
+        else
+          threadDeadline().reset(new SteadyClockTimePoint(*deadline));
+      }
+      else
+        threadDeadline().reset();
+    }
+  }
+
+  ScopedDeadline::ScopedDeadline(SteadyClockTimePoint deadline)
+    : _previous(currentDeadline())
+  {
+    setThreadDeadline(_previous ? std::min(*_previous, deadline) : deadline);
+  }
+
+  ScopedDeadline::ScopedDeadline(Duration timeout)
+    : ScopedDeadline(SteadyClock::now() + timeout)
+  {
+  }
+
+  ScopedDeadline::~ScopedDeadline()
+  {
+    setThreadDeadline(_previous);
+  }
+
+  boost::optional<SteadyClockTimePoint> currentDeadline()
+  {
+    if (const SteadyClockTimePoint* deadline = threadDeadline().get())
+      return *deadline;
+    return boost::none;
+  }
+}
@@ -4,7 +4,11 @@
 */
 #include <thread>
 #include <system_error>
+#include <algorithm>
 #include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 #include <boost/program_options.hpp>
 #include <boost/make_shared.hpp>
@@ -12,6 +16,8 @@
 #include <boost/thread/synchronized_value.hpp>
 #include <boost/algorithm/cxx11/any_of.hpp>
 #include <boost/core/ignore_unused.hpp>
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
 
 #include <qi/preproc.hpp>
 #include <qi/log.hpp>
@@ -95,6 +101,31 @@ namespace qi {
       }
     }
 
+    // Joins and removes the worker threads of the given ids, which must have exited or be exiting.
+    void joinExited(const std::vector<std::thread::id>& ids)
+    {
+      Container exited;
+      {
+        auto syncedWorkers = _workers.synchronize();
+        for (auto it = syncedWorkers->begin(); it != syncedWorkers->end();)
+        {
+          if (std::find(ids.begin(), ids.end(), it->get_id()) != ids.end())
+          {
+            exited.push_back(std::move(*it));
+            it = syncedWorkers->erase(it);
+          }
+          else
+            ++it;
+        }
+      }
+
+      for (auto& worker : exited)
+      {
+        if (worker.joinable())
+          worker.join();
+      }
+    }
+
     // This method is thread safe but is ambiguous when joinAll is also being called.
     Container::size_type size() const
     {
@@ -116,6 +147,127 @@ namespace qi {
     boost::synchronized_value<Container> _workers;
   };
 
+  struct EventLoopAsio::WorkerStatistics
+  {
+    explicit WorkerStatistics(unsigned int index)
+      : index(index)
+      , started(SteadyClock::now())
+    {
+    }
+
+    void taskStarting(SteadyClockTimePoint start)
+    {
+      currentTaskStart = start.time_since_epoch().count();
+    }
+
+    void accountTask(SteadyClockTimePoint start, SteadyClockTimePoint end)
+    {
+      ++tasks;
+      busyTime += boost::chrono::duration_cast<NanoSeconds>(end - start).count();
+      lastActivity = end.time_since_epoch().count();
+      currentTaskStart = 0;
+    }
+
+    // How long the worker has been running its current task, zero if it is idle.
+    SteadyClock::duration busyFor(SteadyClockTimePoint now) const
+    {
+      const auto start = currentTaskStart.load();
+      return start ? now - SteadyClockTimePoint(SteadyClock::duration(start)) : SteadyClock::duration::zero();
+    }
+
+    // How long the worker has been idle, zero if it is running a task.
+    SteadyClock::duration idleFor(SteadyClockTimePoint now) const
+    {
+      if (currentTaskStart.load())
+        return SteadyClock::duration::zero();
+      return now - SteadyClockTimePoint(SteadyClock::duration(lastActivity.load()));
+    }
+
+    const unsigned int index;
+    int cpu = -1; // Only written by the worker before it is registered.
+    const SteadyClockTimePoint started;
+    std::atomic<uint64_t> tasks {0};
+    std::atomic<int64_t> busyTime {0}; // in nanoseconds
+    // In ticks of the steady clock since its epoch.
+    std::atomic<SteadyClock::rep> currentTaskStart {0};
+    std::atomic<SteadyClock::rep> lastActivity {started.time_since_epoch().count()};
+  };
+
+  namespace
+  {
+    void doNotDeleteWorkerStatistics(EventLoopAsio::WorkerStatistics*) {}
+
+    std::vector<int> parseCpuList(const std::string& list)
+    {
+      std::vector<std::string> ranges;
+      boost::split(ranges, list, boost::is_any_of(","));
+
+      std::vector<int> cpus;
+      for (auto& range : ranges)
+      {
+        boost::trim(range);
+        if (range.empty())
+          continue;
+        const auto dash = range.find('-');
+        const int first = boost::lexical_cast<int>(boost::trim_copy(range.substr(0, dash)));
+        const int last = dash == std::string::npos
+                       ? first
+                       : boost::lexical_cast<int>(boost::trim_copy(range.substr(dash + 1)));
+        if (first < 0 || last < first)
+          throw std::runtime_error("invalid range of CPUs \"" + range + "\"");
+        for (int cpu = first; cpu <= last; ++cpu)
+          cpus.push_back(cpu);
+      }
+      return cpus;
+    }
+
+    // Timer callbacks are late as soon as they are due, they run before the bulk of the tasks.
+    TaskPriority defaultPriority(qi::Duration delay)
+    {
+      return delay > qi::Duration::zero() ? TaskPriority::High : TaskPriority::Normal;
+    }
+
+    // Same as EventLoopThreadPolicy::fromEnvironment, but falls back to the default policy,
+    // as an implicitly created event loop must not fail because of a typo in the environment.
+    EventLoopThreadPolicy threadPolicyFromEnvironment(const std::string& prefix)
+    {
+      try
+      {
+        return EventLoopThreadPolicy::fromEnvironment(prefix);
+      }
+      catch (const std::exception& ex)
+      {
+        qiLogWarning() << ex.what() << ", using the default policy.";
+        return EventLoopThreadPolicy();
+      }
+    }
+  }
+
+  EventLoopThreadPolicy EventLoopThreadPolicy::fromEnvironment(const std::string& prefix)
+  {
+    EventLoopThreadPolicy policy;
+    try
+    {
+      policy.cpus = parseCpuList(qi::os::getenv((prefix + "_CPUS").c_str()));
+      policy.pinned = qi::os::getEnvDefault((prefix + "_PINNED").c_str(), false);
+      policy.realTime = qi::os::getEnvDefault((prefix + "_REALTIME").c_str(), false);
+      policy.priority = qi::os::getEnvDefault((prefix + "_PRIORITY").c_str(), 0);
+      policy.threadName = qi::os::getenv((prefix + "_THREAD_NAME").c_str());
+    }
+    catch (const std::exception& ex)
+    {
+      throw std::runtime_error("Invalid thread policy in the " + prefix + "_* environment variables: " + ex.what());
+    }
+    return policy;
+  }
+
+  boost::thread_specific_ptr<EventLoopAsio::WorkerStatistics>& EventLoopAsio::currentWorkerStatistics()
+  {
+    // The statistics are owned by the event loop. Never destroyed: workers may outlive static destruction.
+    static auto* current = new boost::thread_specific_ptr<WorkerStatistics>(&doNotDeleteWorkerStatistics);
+    return *current;
+  }
+
   using SteadyTimer = boost::asio::basic_waitable_timer<SteadyClock>;
 
   static std::atomic<uint64_t> gTaskId{0};
@@ -124,13 +276,24 @@ namespace qi {
   static const auto gPingTimeoutEnvVar = "QI_EVENTLOOP_PING_TIMEOUT";
   static const auto gGracePeriodEnvVar = "QI_EVENTLOOP_GRACE_PERIOD";
   static const auto gMaxTimeoutsEnvVar = "QI_EVENTLOOP_MAX_TIMEOUTS";
+  static const auto gIdleTimeoutEnvVar = "QI_EVENTLOOP_IDLE_TIMEOUT";
+  static const auto gMemoryBudgetEnvVar = "QI_EVENTLOOP_MEMORY_BUDGET";
+  static const auto gThreadMemoryEnvVar = "QI_EVENTLOOP_THREAD_MEMORY";
+  static const auto gPriorityBurstEnvVar = "QI_EVENTLOOP_PRIORITY_BURST";
+  static const auto gNetworkCountEnvVar = "QI_NETWORK_EVENTLOOP_COUNT";
+  static const auto gThreadPolicyEnvPrefix = "QI_EVENTLOOP";
+  static const auto gNetworkThreadPolicyEnvPrefix = "QI_NETWORK_EVENTLOOP";
   const char* const EventLoopAsio::defaultName = "MainEventLoop";
 
-  EventLoopAsio::EventLoopAsio(int threadCount, std::string name, bool spawnOnOverload)
+  EventLoopAsio::EventLoopAsio(int threadCount, std::string name, bool spawnOnOverload,
+                               EventLoopThreadPolicy policy)
     : EventLoopPrivate(std::move(name))
+    , _statistics(_name)
     , _work(nullptr)
     , _maxThreads(0)
     , _workerThreads(new WorkerThreadPool())
+    , _policy(std::move(policy))
+    , _priorityBurst(std::max(qi::os::getEnvDefault(gPriorityBurstEnvVar, 8), 0))
     , _spawnOnOverload(spawnOnOverload)
   {
     start(threadCount);
@@ -154,10 +317,13 @@ namespace qi {
     delete _work.exchange(new boost::asio::io_service::work(_io));
 
     _maxThreads = qi::os::getEnvDefault(gMaxThreadsEnvVar, 150);
+    _minThreads = threadCount;
+    _idleTimeout = MilliSeconds(qi::os::getEnvDefault(gIdleTimeoutEnvVar, 60000u));
+    _nextWorkerIndex = 0;
     _workerThreads->launchN(threadCount, &EventLoopAsio::runWorkerLoop, this);
     if (_spawnOnOverload)
     {
-      _pingThread = std::thread(&EventLoopAsio::runPingLoop, this);
+      _monitorThread = std::thread(&EventLoopAsio::runMonitorLoop, this);
     }
   }
 
@@ -189,32 +355,111 @@ namespace qi {
     join();
   }
 
-  void EventLoopAsio::runPingLoop()
+  int EventLoopAsio::threadLimit() const
+  {
+    static const unsigned int mbBudget = qi::os::getEnvDefault(gMemoryBudgetEnvVar, 0u);
+    static const unsigned int kbPerThread = qi::os::getEnvDefault(gThreadMemoryEnvVar, 8192u);
+
+    int limit = _maxThreads.load();
+    if (mbBudget && kbPerThread)
+    {
+      const int memoryLimit =
+          std::max(static_cast<int>(static_cast<uint64_t>(mbBudget) * 1024u / kbPerThread), _minThreads.load());
+      limit = limit ? std::min(limit, memoryLimit) : memoryLimit;
+    }
+    return limit;
+  }
+
+  void EventLoopAsio::joinExitedWorkers()
+  {
+    std::vector<std::thread::id> exited;
+    {
+      auto syncedExited = _exitedWorkers.synchronize();
+      swap(exited, *syncedExited);
+    }
+    if (!exited.empty())
+      _workerThreads->joinExited(exited);
+  }
+
+  void EventLoopAsio::retireIdleWorkers(SteadyClock::duration idleTimeout)
+  {
+    const auto now = SteadyClock::now();
+    int workerCount = 0;
+    int idleCount = 0;
+    {
+      auto workers = _workerStatistics.synchronize();
+      workerCount = static_cast<int>(workers->size());
+      for (const auto& worker : *workers)
+      {
+        if (worker->idleFor(now) >= idleTimeout)
+          ++idleCount;
+      }
+    }
+
+    // Idle workers are all waiting for a handler, so they pick the termination requests.
+    const int retiring = std::min(idleCount, workerCount - _minThreads.load());
+    if (retiring <= 0)
+      return;
+    qiLogVerbose() << _name << ": Retiring " << retiring << " idle threads (" << workerCount << ')';
+    for (int i = 0; i < retiring; ++i)
+      _io.post([] { throw detail::TerminateThread(); });
+    _poolStats->retired += static_cast<uint64_t>(retiring);
+  }
+
+  void EventLoopAsio::runMonitorLoop()
   {
     qi::os::setCurrentThreadName("EvLoop.mon");
     static const unsigned int msTimeout = qi::os::getEnvDefault(gPingTimeoutEnvVar, 500u);
     static const unsigned int msGrace = qi::os::getEnvDefault(gGracePeriodEnvVar, 0u);
     static const unsigned int maxTimeouts = qi::os::getEnvDefault(gMaxTimeoutsEnvVar, 20u);
+    const MilliSeconds timeout{msTimeout};
 
     unsigned int nbTimeout = 0;
     while (_work.load())
     {
+      joinExitedWorkers();
+      if (_idleTimeout != Duration::zero())
+        retireIdleWorkers(_idleTimeout);
+
+      // Measure the queue latency with an empty task.
       qiLogDebug() << "Ping";
-      auto calling = asyncCall(Seconds{0}, []{});
-      auto callState = calling.waitFor(MilliSeconds{msTimeout});
+      const auto pingStart = SteadyClock::now();
+      auto calling = asyncCall(Seconds{0}, []{}, TaskPriority::Normal);
+      auto callState = calling.waitFor(timeout);
       QI_ASSERT(callState != FutureState_None);
+      const auto now = SteadyClock::now();
+      _poolStats->lastLatencyUs = boost::chrono::duration_cast<MicroSeconds>(now - pingStart).count();
+
       if (callState == FutureState_Running)
       {
-        const auto workerCount = static_cast<int>(_workerThreads->size());
-        const auto maxThreads = _maxThreads.load();
-        if (maxThreads && workerCount > maxThreads) // we count in nThreads
+        // Workers stuck on a task for longer than the timeout do not serve the queue: grow the
+        // pool so that at least the initial number of workers is available.
+        int workerCount = 0;
+        int blockedCount = 0;
+        {
+          auto workers = _workerStatistics.synchronize();
+          workerCount = static_cast<int>(workers->size());
+          for (const auto& worker : *workers)
+          {
+            if (worker->busyFor(now) >= timeout)
+              ++blockedCount;
+          }
+        }
+        _poolStats->blockedThreads = static_cast<unsigned int>(blockedCount);
+
+        const int limit = threadLimit();
+        const int wanted = std::max(1, _minThreads.load() - (workerCount - blockedCount));
+        const int spawning = limit ? std::min(wanted, limit - workerCount) : wanted;
+        if (spawning <= 0)
         {
           ++nbTimeout;
+          ++_poolStats->saturations;
           qiLogInfo() << "Threadpool " << _name << " limit reached (" << nbTimeout
                       << " timeouts, number of tasks: " << _totalTask.load()
                       << ", number of active tasks: " << _activeTask.load()
                       << ", number of threads: " << workerCount
-                      << ", maximum number of threads: " << maxThreads << ")";
+                      << ", number of blocked threads: " << blockedCount
+                      << ", maximum number of threads: " << limit << ")";
 
           if (nbTimeout >= maxTimeouts)
           {
@@ -237,8 +482,11 @@ namespace qi {
         }
         else
         {
-          qiLogInfo() << _name << ": Spawning more threads (" << workerCount << ')';
-          _workerThreads->launch(&EventLoopAsio::runWorkerLoop, this);
+          qiLogInfo() << _name << ": Spawning " << spawning << " more threads (" << workerCount
+                      << " threads, " << blockedCount << " blocked)";
+          for (int i = 0; i < spawning; ++i)
+            _workerThreads->launch(&EventLoopAsio::runWorkerLoop, this);
+          _poolStats->spawned += static_cast<uint64_t>(spawning);
         }
         qi::os::msleep(msGrace);
       }
@@ -260,10 +508,53 @@ namespace qi {
     }
   }
 
+  void EventLoopAsio::applyThreadPolicy(WorkerStatistics& worker)
+  {
+    qi::os::setCurrentThreadName(_policy.threadName.empty()
+                                 ? _name
+                                 : _policy.threadName + "." + std::to_string(worker.index));
+
+    std::vector<int> cpus = _policy.cpus;
+    if (_policy.pinned)
+    {
+      if (cpus.empty())
+      {
+        for (long cpu = 0; cpu < qi::os::numberOfCPUs(); ++cpu)
+          cpus.push_back(static_cast<int>(cpu));
+      }
+      if (!cpus.empty())
+      {
+        worker.cpu = cpus[worker.index % cpus.size()];
+        cpus.assign(1, worker.cpu);
+      }
+    }
+    if (!cpus.empty() && !qi::os::setCurrentThreadCPUAffinity(cpus))
+    {
+      qiLogWarning() << "Cannot set the CPU affinity of a worker of the event loop " << _name;
+      worker.cpu = -1;
+    }
+
+    if ((_policy.realTime || _policy.priority != 0)
+        && !qi::os::setCurrentThreadPriority(_policy.priority, _policy.realTime))
+    {
+      qiLogWarning() << "Cannot set the priority of a worker of the event loop " << _name
+                     << " to " << _policy.priority << (_policy.realTime ? " (real-time)" : " (nice)");
+    }
+  }
+
   void EventLoopAsio::runWorkerLoop()
   {
     qiLogDebug() << this << "run starting from pool";
-    qi::os::setCurrentThreadName(_name);
+
+    const auto worker = std::make_shared<WorkerStatistics>(_nextWorkerIndex++);
+    applyThreadPolicy(*worker);
+    _workerStatistics->push_back(worker);
+    currentWorkerStatistics().reset(worker.get());
+    auto unregisterWorker = scoped([&] {
+      currentWorkerStatistics().reset();
+      auto workers = _workerStatistics.synchronize();
+      workers->erase(std::remove(workers->begin(), workers->end(), worker), workers->end());
+    });
 
     while (true) {
       try
@@ -272,6 +563,9 @@ namespace qi {
         //the handler finished by himself. just quit.
         break;
       } catch(const detail::TerminateThread& /* e */) {
+        // The thread is retired while the event loop goes on, it must be joined by the monitor.
+        if (_work.load())
+          _exitedWorkers->push_back(std::this_thread::get_id());
         break;
       } catch(const std::exception& e) {
         qiLogWarning() << "Error caught in eventloop(" << _name << ").async: " << e.what();
@@ -288,29 +582,47 @@ namespace qi {
 
   void EventLoopAsio::join()
   {
-    if (_pingThread.joinable())
+    if (_monitorThread.joinable())
     {
-      qiLogVerbose() << "Waiting for the ping thread ...";
-      _pingThread.join();
-      qiLogDebug()  << "Waiting for the ping thread - DONE";
+      qiLogVerbose() << "Waiting for the monitor thread ...";
+      _monitorThread.join();
+      qiLogDebug()  << "Waiting for the monitor thread - DONE";
     }
 
     qiLogVerbose()
         << "Waiting threads from the pool \"" << _name << "\", remaining tasks: "
         << _totalTask.load() << " (" << _activeTask.load() <<  " active)...";
     _workerThreads->joinAll();
+    _exitedWorkers->clear();
     qiLogDebug()  << "Waiting threads from the pool - DONE";
   }
 
   /// Destructible D
   template <typename D>
   void EventLoopAsio::invoke_maybe(boost::function<void()> f, qi::uint64_t id, qi::Promise<void> p,
-                                   const boost::system::error_code& erc, D countTask)
+                                   const boost::system::error_code& erc, D countTask,
+                                   SteadyClockTimePoint dueTime, detail::QueuedTask queued)
   {
     boost::ignore_unused(id, countTask);
     if (!erc)
     {
       auto _ = scopedIncrAndDecr(_activeTask);
+      const bool withStatistics = detail::ExecutionStatisticsRecorder::enabled();
+      WorkerStatistics* const worker = currentWorkerStatistics().get();
+      const auto taskStart = (worker || withStatistics) ? SteadyClock::now() : SteadyClockTimePoint();
+      if (withStatistics)
+        _statistics.taskStarted(queued.release(), std::max(taskStart - dueTime, SteadyClock::duration::zero()));
+      if (worker)
+        worker->taskStarting(taskStart);
+      auto accountTask = scoped([&] {
+        if (!worker && !withStatistics)
+          return;
+        const auto taskEnd = SteadyClock::now();
+        if (worker)
+          worker->accountTask(taskStart, taskEnd);
+        if (withStatistics)
+          _statistics.taskFinished(taskEnd - taskStart, f.target_type().name());
+      });
       tracepoint(qi_qi, eventloop_task_start, id);
 
       try
@@ -341,8 +653,61 @@ namespace qi {
     }
   }
 
+  SteadyClockTimePoint EventLoopAsio::queueTask(detail::QueuedTask& queued)
+  {
+    if (!detail::ExecutionStatisticsRecorder::enabled())
+      return SteadyClockTimePoint();
+    // The handler may be destroyed without running, if the event loop stops.
+    queued = detail::QueuedTask(_statistics);
+    return SteadyClock::now();
+  }
+
+  void EventLoopAsio::dispatch(boost::function<void()> task, TaskPriority priority)
+  {
+    if (priority == TaskPriority::High && _priorityBurst > 0)
+    {
+      _highPriorityTasks->push_back(std::move(task));
+      ++_pendingHighPriorityTasks;
+      // The task may already have been run by a worker taking a task of normal priority.
+      _io.post([this] { runHighPriorityTasks(1); });
+    }
+    else
+    {
+      _io.post([this, task] {
+        try
+        {
+          runHighPriorityTasks(_priorityBurst);
+        }
+        catch (const detail::TerminateThread&)
+        {
+          // The worker stops: another one runs the task of normal priority.
+          _io.post(task);
+          throw;
+        }
+        task();
+      });
+    }
+  }
+
+  void EventLoopAsio::runHighPriorityTasks(int count)
+  {
+    for (; count > 0 && _pendingHighPriorityTasks.load() > 0; --count)
+    {
+      boost::function<void()> task;
+      {
+        auto tasks = _highPriorityTasks.synchronize();
+        if (tasks->empty())
+          return;
+        task = std::move(tasks->front());
+        tasks->pop_front();
+      }
+      --_pendingHighPriorityTasks;
+      task();
+    }
+  }
+
   void EventLoopAsio::post(qi::Duration delay,
-      const boost::function<void ()>& cb)
+      const boost::function<void ()>& cb, TaskPriority priority)
   {
     static boost::system::error_code erc;
 
@@ -360,11 +725,13 @@ namespace qi {
       tracepoint(qi_qi, eventloop_post, id, cb.target_type().name());
 
       auto countTotalTask = sharedPtr(scopedIncrAndDecr(_totalTask));
-      _io.post([=] { invoke_maybe(cb, id, Promise<void>{}, erc, countTotalTask); });
+      detail::QueuedTask queued;
+      const auto dueTime = queueTask(queued);
+      dispatch([=] { invoke_maybe(cb, id, Promise<void>{}, erc, countTotalTask, dueTime, queued); }, priority);
     }
     else
     {
-      asyncCall(delay, cb).then([](const Future<void>& fut)
+      asyncCall(delay, cb, priority).then([](const Future<void>& fut)
       {
         if (fut.hasError())
         {
@@ -375,7 +742,7 @@ namespace qi {
   }
 
   qi::Future<void> EventLoopAsio::asyncCall(qi::Duration delay,
-      boost::function<void ()> cb)
+      boost::function<void ()> cb, TaskPriority priority)
   {
     static boost::system::error_code erc;
 
@@ -391,12 +758,22 @@ namespace qi {
     {
       boost::shared_ptr<boost::asio::steady_timer> timer = boost::make_shared<boost::asio::steady_timer>(boost::ref(_io));
       timer->expires_from_now(boost::chrono::duration_cast<boost::asio::steady_timer::duration>(delay));
+      const auto dueTime = detail::ExecutionStatisticsRecorder::enabled()
+                         ? SteadyClock::now() + delay
+                         : SteadyClockTimePoint();
       qi::Promise<void> prom(boost::bind(&boost::asio::steady_timer::cancel, timer));
-      timer->async_wait([=](const boost::system::error_code& erc) { invoke_maybe(cb, id, prom, erc, countTotalTask); });
+      timer->async_wait([=](const boost::system::error_code& erc) {
+        if (erc)
+          invoke_maybe(cb, id, prom, erc, countTotalTask, dueTime, detail::QueuedTask());
+        else
+          dispatch([=] { invoke_maybe(cb, id, prom, erc, countTotalTask, dueTime, detail::QueuedTask()); }, priority);
+      });
       return prom.future();
     }
     Promise<void> prom;
-    _io.post([=] { invoke_maybe(cb, id, prom, erc, countTotalTask); });
+    detail::QueuedTask queued;
+    const auto dueTime = queueTask(queued);
+    dispatch([=] { invoke_maybe(cb, id, prom, erc, countTotalTask, dueTime, queued); }, priority);
     return prom.future();
   }
 
@@ -426,7 +803,13 @@ namespace qi {
     boost::shared_ptr<SteadyTimer> timer = boost::make_shared<SteadyTimer>(boost::ref(_io));
     timer->expires_at(timepoint);
     qi::Promise<void> prom(boost::bind(&SteadyTimer::cancel, timer));
-    timer->async_wait([=](const boost::system::error_code& erc) { invoke_maybe(cb, id, prom, erc, countTotalTask); });
+    timer->async_wait([=](const boost::system::error_code& erc) {
+      if (erc)
+        invoke_maybe(cb, id, prom, erc, countTotalTask, timepoint, detail::QueuedTask());
+      else
+        dispatch([=] { invoke_maybe(cb, id, prom, erc, countTotalTask, timepoint, detail::QueuedTask()); },
+                 TaskPriority::High);
+    });
     return prom.future();
   }
 
@@ -435,13 +818,51 @@ namespace qi {
     _maxThreads = static_cast<int>(max);
   }
 
+  std::vector<EventLoopThreadStatistics> EventLoopAsio::threadStatistics() const
+  {
+    const auto now = SteadyClock::now();
+    std::vector<EventLoopThreadStatistics> result;
+    auto workers = _workerStatistics.synchronize();
+    result.reserve(workers->size());
+    for (const auto& worker : *workers)
+    {
+      EventLoopThreadStatistics stats;
+      stats.index = worker->index;
+      stats.cpu = worker->cpu;
+      stats.tasks = worker->tasks.load();
+      stats.busyTime = NanoSeconds(worker->busyTime.load());
+      stats.upTime = boost::chrono::duration_cast<NanoSeconds>(now - worker->started);
+      result.push_back(stats);
+    }
+    return result;
+  }
+
+  EventLoopPoolStatistics EventLoopAsio::poolStatistics() const
+  {
+    EventLoopPoolStatistics stats = _poolStats.get();
+    stats.threads = static_cast<unsigned int>(_workerStatistics->size());
+    stats.minThreads = static_cast<unsigned int>(std::max(_minThreads.load(), 0));
+    stats.maxThreads = static_cast<unsigned int>(std::max(threadLimit(), 0));
+    return stats;
+  }
+
+  ExecutionStatistics EventLoopAsio::statistics() const
+  {
+    return _statistics.statistics();
+  }
+
   void* EventLoopAsio::nativeHandle()
   {
     return static_cast<void*>(&_io);
   }
 
   EventLoop::EventLoop(std::string name, int nthreads, bool spawnOnOverload)
-    : _p(std::make_shared<EventLoopAsio>(nthreads, name, spawnOnOverload))
+    : EventLoop(name, nthreads, spawnOnOverload, threadPolicyFromEnvironment(gThreadPolicyEnvPrefix))
+  {
+  }
+
+  EventLoop::EventLoop(std::string name, int nthreads, bool spawnOnOverload, EventLoopThreadPolicy policy)
+    : _p(std::make_shared<EventLoopAsio>(nthreads, name, spawnOnOverload, std::move(policy)))
     , _name(name)
   {
   }
@@ -522,11 +943,18 @@ namespace qi {
   {
     return safeCall(_p, [&](const ImplPtr& impl){
       qiLogDebug() << this << " EventLoop post " << &callback;
-      impl->post(delay, callback);
+      impl->post(delay, callback, defaultPriority(delay));
       qiLogDebug() << this << " EventLoop post done " << &callback;
     });
   }
 
+  void EventLoop::postWithPriorityImpl(boost::function<void()> callback, TaskPriority priority)
+  {
+    return safeCall(_p, [&](const ImplPtr& impl){
+      impl->post(qi::Duration(0), callback, priority);
+    });
+  }
+
   void EventLoop::post(const boost::function<void()>& callback,
       qi::SteadyClockTimePoint timepoint)
   {
@@ -548,7 +976,16 @@ namespace qi {
   qi::Future<void> EventLoop::asyncDelayImpl(boost::function<void()> callback, qi::Duration delay)
   {
     return safeCall(_p, [&](const ImplPtr& impl) {
-        return impl->asyncCall(delay, callback);
+        return impl->asyncCall(delay, callback, defaultPriority(delay));
+      }, onDestructingError );
+  }
+
+  qi::Future<void> EventLoop::asyncDelayWithPriorityImpl(boost::function<void()> callback,
+                                                         qi::Duration delay,
+                                                         TaskPriority priority)
+  {
+    return safeCall(_p, [&](const ImplPtr& impl) {
+        return impl->asyncCall(delay, callback, priority);
       }, onDestructingError );
   }
 
@@ -573,6 +1010,30 @@ namespace qi {
     });
   }
 
+  EventLoopPoolStatistics EventLoop::poolStatistics() const
+  {
+    return safeCall(_p, [](const ImplPtr& impl){
+      return impl->poolStatistics();
+    }
+    , []{ return EventLoopPoolStatistics(); });
+  }
+
+  ExecutionStatistics EventLoop::statistics() const
+  {
+    return safeCall(_p, [](const ImplPtr& impl){
+      return impl->statistics();
+    }
+    , []{ return ExecutionStatistics(); });
+  }
+
+  std::vector<EventLoopThreadStatistics> EventLoop::threadStatistics() const
+  {
+    return safeCall(_p, [](const ImplPtr& impl){
+      return impl->threadStatistics();
+    }
+    , []{ return std::vector<EventLoopThreadStatistics>(); });
+  }
+
   struct MonitorContext
   {
     EventLoop* target;
@@ -661,13 +1122,22 @@ namespace qi {
 
   static EventLoop* _poolEventLoop = nullptr;
   static EventLoop* _networkEventLoop = nullptr;
+  // Network event loops other than _networkEventLoop, see getNextNetworkEventLoop().
+  static std::vector<EventLoop*> _networkEventLoopShards;
+
+  static void eventloop_shards_stop()
+  {
+    for (auto& shard : _networkEventLoopShards)
+      eventloop_stop(shard);
+    _networkEventLoopShards.clear();
+  }
 
   namespace
   {
     // The initialisation is protected by a mutex,
     // We then use an atomic to prevent having a mutex on a fastpath.
     EventLoop* _getInternal(EventLoop* &ctx, int nthreads, const std::string& name,
-      bool spawnOnOverload, boost::mutex& mutex, std::atomic<int>& init)
+      bool spawnOnOverload, const char* policyEnvPrefix, boost::mutex& mutex, std::atomic<int>& init)
     {
       if (init.load())
         return ctx;
@@ -680,7 +1150,8 @@ namespace qi {
           {
             qiLogVerbose() << "Creating event loop while no qi::Application() is running";
           }
-          ctx = new EventLoop(name, nthreads, spawnOnOverload); // TODO: use make_unique once we can use C++14
+          ctx = new EventLoop(name, nthreads, spawnOnOverload,
+                              threadPolicyFromEnvironment(policyEnvPrefix)); // TODO: use make_unique once we can use C++14
           Application::atExit(boost::bind(&eventloop_stop, boost::ref(ctx)));
         }
       }
@@ -693,14 +1164,49 @@ namespace qi {
   {
     static boost::mutex mutex;
     static std::atomic<int> init(0);
-    return _getInternal(ctx, nthreads, EventLoopAsio::defaultName, true, mutex, init);
+    return _getInternal(ctx, nthreads, EventLoopAsio::defaultName, true, gThreadPolicyEnvPrefix, mutex, init);
   }
 
   static EventLoop* _getNetwork(EventLoop* &ctx)
   {
     static boost::mutex mutex;
     static std::atomic<int> init(0);
-    return _getInternal(ctx, 1, "EventLoopNetwork", false, mutex, init);
+    return _getInternal(ctx, 1, "EventLoopNetwork", false, gNetworkThreadPolicyEnvPrefix, mutex, init);
+  }
+
+  static const std::vector<EventLoop*>& _getNetworkShards()
+  {
+    static boost::mutex mutex;
+    static std::atomic<int> init(0);
+    if (init.load())
+      return _networkEventLoopShards;
+
+    {
+      boost::mutex::scoped_lock _sl(mutex);
+      if (!init.load())
+      {
+        const int count = qi::os::getEnvDefault(gNetworkCountEnvVar, 1);
+        const auto policy = threadPolicyFromEnvironment(gNetworkThreadPolicyEnvPrefix);
+        for (int i = 1; i < count; ++i)
+        {
+          // Pinned network event loops each get their own CPU, the main one taking the first.
+          auto shardPolicy = policy;
+          if (shardPolicy.pinned && !shardPolicy.cpus.empty())
+          {
+            const auto shift = static_cast<std::size_t>(i) % shardPolicy.cpus.size();
+            std::rotate(shardPolicy.cpus.begin(), shardPolicy.cpus.begin() + shift, shardPolicy.cpus.end());
+          }
+          // Same settings as the main network event loop: one thread, no spawn on overload,
+          // so that the handlers of a given socket stay serialized.
+          _networkEventLoopShards.push_back(
+                new EventLoop("EventLoopNetwork." + std::to_string(i), 1, false, shardPolicy));
+        }
+        if (!_networkEventLoopShards.empty())
+          Application::atExit(&eventloop_shards_stop);
+        ++init;
+      }
+    }
+    return _networkEventLoopShards;
   }
 
   void startEventLoop(int nthread)
@@ -718,6 +1224,20 @@ namespace qi {
     return _getNetwork(_networkEventLoop);
   }
 
+  EventLoop* getNextNetworkEventLoop()
+  {
+    static std::atomic<unsigned int> next(0);
+    const auto& shards = _getNetworkShards();
+    if (shards.empty())
+      return getNetworkEventLoop();
+
+    // Index 0 stands for the main network event loop.
+    const auto index = next++ % (shards.size() + 1);
+    if (index == 0)
+      return getNetworkEventLoop();
+    return shards[index - 1];
+  }
+
   boost::asio::io_service& getIoService()
   {
     return *(boost::asio::io_service*)getEventLoop()->nativeHandle();
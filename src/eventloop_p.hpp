@@ -8,10 +8,15 @@
 #define _SRC_EVENTLOOP_P_HPP_
 
 #include <atomic>
+#include <deque>
+#include <memory>
 #include <thread>
+#include <vector>
 #include <boost/asio.hpp>
 #include <qi/eventloop.hpp>
+#include <qi/detail/executionstatistics.hpp>
 #include <boost/thread/synchronized_value.hpp>
+#include <boost/thread/tss.hpp>
 
 namespace qi {
   class AsyncCallHandlePrivate
@@ -45,12 +50,17 @@ namespace qi {
     virtual void start(int nthreads)=0; // 0=auto
     virtual void join()=0;
     virtual void stop()=0;
-    virtual qi::Future<void> asyncCall(qi::Duration delay, boost::function<void ()> callback)=0;
-    virtual void post(qi::Duration delay, const boost::function<void ()>& callback)=0;
+    virtual qi::Future<void> asyncCall(qi::Duration delay, boost::function<void ()> callback,
+                                       TaskPriority priority)=0;
+    virtual void post(qi::Duration delay, const boost::function<void ()>& callback,
+                      TaskPriority priority)=0;
     virtual qi::Future<void> asyncCall(qi::SteadyClockTimePoint timepoint, boost::function<void ()> callback)=0;
     virtual void post(qi::SteadyClockTimePoint timepoint, const boost::function<void ()>& callback)=0;
     virtual void* nativeHandle()=0;
     virtual void setMaxThreads(unsigned int max)=0;
+    virtual std::vector<EventLoopThreadStatistics> threadStatistics() const=0;
+    virtual ExecutionStatistics statistics() const=0;
+    virtual EventLoopPoolStatistics poolStatistics() const=0;
     boost::synchronized_value<boost::function<void()>> _emergencyCallback;
     const std::string _name;
   };
@@ -61,7 +71,7 @@ namespace qi {
     static const char* const defaultName;
 
     explicit EventLoopAsio(int threadCount = 0, std::string name = defaultName,
-      bool spawnOnOverload = true);
+      bool spawnOnOverload = true, EventLoopThreadPolicy policy = EventLoopThreadPolicy());
     ~EventLoopAsio() override;
 
     bool isInThisContext() const override;
@@ -69,31 +79,67 @@ namespace qi {
     void join() override;
     void stop() override;
     qi::Future<void> asyncCall(qi::Duration delay,
-      boost::function<void ()> callback) override;
+      boost::function<void ()> callback, TaskPriority priority) override;
     void post(qi::Duration delay,
-      const boost::function<void ()>& callback) override;
+      const boost::function<void ()>& callback, TaskPriority priority) override;
     qi::Future<void> asyncCall(qi::SteadyClockTimePoint timepoint,
         boost::function<void ()> callback) override;
     void post(qi::SteadyClockTimePoint timepoint,
         const boost::function<void ()>& callback) override;
     void* nativeHandle() override;
     void setMaxThreads(unsigned int max) override;
+    std::vector<EventLoopThreadStatistics> threadStatistics() const override;
+    ExecutionStatistics statistics() const override;
+    EventLoopPoolStatistics poolStatistics() const override;
+
+    struct WorkerStatistics;
 
   private:
+    // The statistics of the worker running on the current thread, if any.
+    static boost::thread_specific_ptr<WorkerStatistics>& currentWorkerStatistics();
+
     /// Destructible D
     template<typename D>
     void invoke_maybe(boost::function<void()> f, qi::uint64_t id, qi::Promise<void> p,
-                      const boost::system::error_code& erc, D countTask);
+                      const boost::system::error_code& erc, D countTask,
+                      SteadyClockTimePoint dueTime, detail::QueuedTask queued);
+    // Accounts for a task posted for immediate execution, returns the time it is due.
+    SteadyClockTimePoint queueTask(detail::QueuedTask& queued);
+    // Queues a task for immediate execution.
+    void dispatch(boost::function<void()> task, TaskPriority priority);
+    // Runs up to count pending tasks of high priority.
+    void runHighPriorityTasks(int count);
     void runWorkerLoop();
-    void runPingLoop();
+    void runMonitorLoop();
+    // The maximum number of workers, given the maximum number of threads and the memory budget, 0 if unlimited.
+    int threadLimit() const;
+    void joinExitedWorkers();
+    void retireIdleWorkers(SteadyClock::duration idleTimeout);
+    void applyThreadPolicy(WorkerStatistics& worker);
+
+    // Declared before the queues, the tasks they drop unqueue themselves from it.
+    detail::ExecutionStatisticsRecorder _statistics;
 
     boost::asio::io_service _io;
     std::atomic<boost::asio::io_service::work*> _work; // keep io.run() alive
     std::atomic<int> _maxThreads;
+    std::atomic<int> _minThreads {0};
+    Duration _idleTimeout; // written before the monitor starts
 
     class WorkerThreadPool;
     std::unique_ptr<WorkerThreadPool> _workerThreads;
-    std::thread _pingThread;
+    std::thread _monitorThread;
+    boost::synchronized_value<std::vector<std::thread::id>> _exitedWorkers;
+    boost::synchronized_value<EventLoopPoolStatistics> _poolStats;
+
+    const EventLoopThreadPolicy _policy;
+    std::atomic<unsigned int> _nextWorkerIndex {0};
+    boost::synchronized_value<std::vector<std::shared_ptr<WorkerStatistics>>> _workerStatistics;
+
+    // The tasks of high priority, each one also has a handler in _io which runs the first pending one.
+    boost::synchronized_value<std::deque<boost::function<void()>>> _highPriorityTasks;
+    std::atomic<int> _pendingHighPriorityTasks {0};
+    const int _priorityBurst;
 
     std::atomic<int64_t> _totalTask {0};
     std::atomic<int64_t> _activeTask {0};
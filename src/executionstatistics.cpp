@@ -0,0 +1,119 @@
+#include <algorithm>
+
+#include <boost/core/demangle.hpp>
+
+#include <qi/detail/executionstatistics.hpp>
+#include <qi/getenv.hpp>
+#include <qi/log.hpp>
+
+qiLogCategory("qi.executionstatistics");
+
+namespace qi
+{
+namespace detail
+{
+  namespace
+  {
+    qi::int64_t toUs(SteadyClock::duration duration)
+    {
+      return boost::chrono::duration_cast<MicroSeconds>(duration).count();
+    }
+  }
+
+  ExecutionStatisticsRecorder::ExecutionStatisticsRecorder(std::string contextName)
+    : _contextName(std::move(contextName))
+    , _queued(0)
+    , _active(0)
+    , _completed(0)
+    , _slowTaskThresholdUs(0)
+  {
+    for (auto& count : _schedulingDelay)
+      count = 0;
+    for (auto& count : _runTime)
+      count = 0;
+  }
+
+  bool ExecutionStatisticsRecorder::enabled()
+  {
+    static const bool enabled = qi::os::getEnvDefault("QI_EXECUTION_STATISTICS", true);
+    return enabled;
+  }
+
+  void ExecutionStatisticsRecorder::taskStarted(bool queued, SteadyClock::duration schedulingDelay)
+  {
+    if (queued)
+      --_queued;
+    ++_active;
+    push(_schedulingDelay, schedulingDelay);
+  }
+
+  void ExecutionStatisticsRecorder::taskFinished(SteadyClock::duration runTime, const char* name)
+  {
+    static const qi::int64_t longTaskUs =
+        qi::os::getEnvDefault<qi::int64_t>("QI_EXECUTION_LONG_TASK_MS", 0) * 1000;
+
+    --_active;
+    ++_completed;
+    push(_runTime, runTime);
+
+    const auto runTimeUs = toUs(runTime);
+    if (runTimeUs > _slowTaskThresholdUs.load(std::memory_order_relaxed))
+      recordSlowTask(runTimeUs, name);
+    if (longTaskUs > 0 && runTimeUs >= longTaskUs)
+    {
+      qiLogWarning() << "Task " << boost::core::demangle(name) << " ran for " << runTimeUs / 1000
+                     << "ms in " << _contextName;
+    }
+  }
+
+  void ExecutionStatisticsRecorder::push(Histogram& histogram, SteadyClock::duration duration)
+  {
+    histogram[DurationHistogram::bucketIndex(toUs(duration))].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  DurationHistogram ExecutionStatisticsRecorder::load(const Histogram& histogram)
+  {
+    DurationHistogram result;
+    for (std::size_t i = 0; i < histogram.size(); ++i)
+      result.counts[i] = histogram[i].load(std::memory_order_relaxed);
+    return result;
+  }
+
+  void ExecutionStatisticsRecorder::recordSlowTask(qi::int64_t runTimeUs, const char* name)
+  {
+    boost::mutex::scoped_lock lock(_slowTasksMutex);
+    auto byRunTime = [](const std::pair<qi::int64_t, const char*>& a,
+                        const std::pair<qi::int64_t, const char*>& b) { return a.first > b.first; };
+    const auto task = std::make_pair(runTimeUs, name);
+    _slowTasks.insert(std::upper_bound(_slowTasks.begin(), _slowTasks.end(), task, byRunTime), task);
+    if (_slowTasks.size() > slowTaskCount)
+      _slowTasks.pop_back();
+    if (_slowTasks.size() == slowTaskCount)
+      _slowTaskThresholdUs = _slowTasks.back().first;
+  }
+
+  ExecutionStatistics ExecutionStatisticsRecorder::statistics() const
+  {
+    ExecutionStatistics stats;
+    stats.queueDepth = std::max<qi::int64_t>(_queued.load(), 0);
+    stats.activeTasks = _active.load();
+    stats.completedTasks = _completed.load();
+    stats.schedulingDelay = load(_schedulingDelay);
+    stats.runTime = load(_runTime);
+
+    std::vector<std::pair<qi::int64_t, const char*>> slowTasks;
+    {
+      boost::mutex::scoped_lock lock(_slowTasksMutex);
+      slowTasks = _slowTasks;
+    }
+    for (const auto& task : slowTasks)
+    {
+      SlowTask slowTask;
+      slowTask.name = boost::core::demangle(task.second);
+      slowTask.runTimeUs = task.first;
+      stats.slowestTasks.push_back(slowTask);
+    }
+    return stats;
+  }
+}
+}
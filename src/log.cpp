@@ -29,6 +29,7 @@
 #include <boost/thread/condition_variable.hpp>
 #include <boost/thread/recursive_mutex.hpp>
 #include <boost/thread/locks.hpp>
+#include <boost/thread/tss.hpp>
 #include <boost/program_options.hpp>
 #include <boost/unordered_map.hpp>
 #include <boost/algorithm/string.hpp>
@@ -225,6 +226,7 @@ namespace qi {
     using privateLog = struct sPrivateLog
     {
       qi::LogLevel               _logLevel;
+      CategoryType               _categoryType; // may be null, then use _category
       char                       _category[CAT_SIZE];
       char                       _file[FILE_SIZE];
       char                       _function[FUNC_SIZE];
@@ -517,6 +519,304 @@ namespace qi {
             return result;
           }
       }
+
+      namespace
+      {
+        const std::size_t initialLogBufferSize = 512;
+        // Buffers that grew larger are shrunk when given back to the pool.
+        const std::size_t maxKeptLogBufferSize = 64 * 1024;
+        // More buffers are only needed by nested logs.
+        const std::size_t maxPooledLogBuffers = 4;
+
+        struct LogStreamBufferPool
+        {
+          LogStreamBufferPool()
+          {
+            buffers.reserve(maxPooledLogBuffers);
+          }
+
+          ~LogStreamBufferPool()
+          {
+            for (LogStreamBuffer* buffer : buffers)
+              delete buffer;
+          }
+
+          std::vector<LogStreamBuffer*> buffers;
+        };
+
+        boost::thread_specific_ptr<LogStreamBufferPool>& logStreamBufferPools()
+        {
+          // Never destroyed: logs may be emitted at static destruction time.
+          static auto* pools = new boost::thread_specific_ptr<LogStreamBufferPool>();
+          return *pools;
+        }
+      }
+
+      LogStreamBuffer::LogStreamBuffer()
+        : _data(initialLogBufferSize)
+        , _stream(this)
+      {
+        clear();
+      }
+
+      const char* LogStreamBuffer::c_str()
+      {
+        // There is always room for the terminating null, see clear().
+        *pptr() = '\0';
+        return pbase();
+      }
+
+      void LogStreamBuffer::clear()
+      {
+        if (_data.size() > maxKeptLogBufferSize)
+          std::vector<char>(initialLogBufferSize).swap(_data);
+        setp(_data.data(), _data.data() + _data.size() - 1);
+        _stream.clear();
+        _stream.flags(std::ios_base::dec | std::ios_base::skipws);
+        _stream.width(0);
+        _stream.precision(6);
+        _stream.fill(' ');
+      }
+
+      LogStreamBuffer::int_type LogStreamBuffer::overflow(int_type c)
+      {
+        if (traits_type::eq_int_type(c, traits_type::eof()))
+          return traits_type::not_eof(c);
+        const std::ptrdiff_t used = pptr() - pbase();
+        _data.resize(_data.size() * 2);
+        setp(_data.data(), _data.data() + _data.size() - 1);
+        pbump(static_cast<int>(used));
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+        return c;
+      }
+
+      LogStreamBuffer* acquireLogStreamBuffer()
+      {
+        LogStreamBufferPool* pool = logStreamBufferPools().get();
+        if (!pool || pool->buffers.empty())
+          return new LogStreamBuffer();
+        LogStreamBuffer* buffer = pool->buffers.back();
+        pool->buffers.pop_back();
+        return buffer;
+      }
+
+      void releaseLogStreamBuffer(LogStreamBuffer* buffer)
+      {
+        boost::thread_specific_ptr<LogStreamBufferPool>& pools = logStreamBufferPools();
+        LogStreamBufferPool* pool = pools.get();
+        if (!pool)
+        {
+          pool = new LogStreamBufferPool();
+          pools.reset(pool);
+        }
+        if (pool->buffers.size() >= maxPooledLogBuffers)
+        {
+          delete buffer;
+          return;
+        }
+        buffer->clear();
+        pool->buffers.push_back(buffer);
+      }
+
+      namespace
+      {
+        struct FormatSpec
+        {
+          FormatSpec()
+            : index(-1)
+            , flags(std::ios_base::dec)
+            , width(0)
+            , precision(-1)
+            , fill(' ')
+          {}
+
+          int index; // -1 for the next argument
+          std::ios_base::fmtflags flags;
+          std::streamsize width;
+          std::streamsize precision;
+          char fill;
+        };
+
+        bool isDigit(char c)
+        {
+          return c >= '0' && c <= '9';
+        }
+
+        int parseNumber(const char*& p)
+        {
+          int n = 0;
+          while (isDigit(*p))
+            n = n * 10 + (*p++ - '0');
+          return n;
+        }
+
+        // Parses "[N$][flags][width][.precision][length]type" starting at p.
+        // Returns the end of the directive, or null if it is not valid.
+        // Inside "%|...|", the type is optional.
+        const char* parsePrintfSpec(const char* p, FormatSpec& spec, bool inPipes)
+        {
+          const char* start = p;
+          if (isDigit(*p))
+          {
+            const int n = parseNumber(p);
+            if (*p == '$' && n > 0)
+            {
+              spec.index = n - 1;
+              ++p;
+            }
+            else
+              p = start;
+          }
+
+          for (;; ++p)
+          {
+            if (*p == '-')
+              spec.flags |= std::ios_base::left;
+            else if (*p == '0')
+              spec.fill = '0';
+            else if (*p == '+')
+              spec.flags |= std::ios_base::showpos;
+            else if (*p == '#')
+              spec.flags |= std::ios_base::showbase | std::ios_base::showpoint;
+            else if (*p != ' ')
+              break;
+          }
+          if (spec.fill == '0' && !(spec.flags & std::ios_base::left))
+            spec.flags |= std::ios_base::internal;
+
+          spec.width = parseNumber(p);
+          if (*p == '.')
+          {
+            ++p;
+            spec.precision = parseNumber(p);
+          }
+          while (*p && std::strchr("hlLqjzt", *p))
+            ++p;
+
+          switch (*p)
+          {
+          case 'd': case 'i': case 'u': case 's': case 'c': case 'p': case 'g':
+            break;
+          case 'x':
+            spec.flags = (spec.flags & ~std::ios_base::dec) | std::ios_base::hex;
+            break;
+          case 'X':
+            spec.flags = (spec.flags & ~std::ios_base::dec) | std::ios_base::hex | std::ios_base::uppercase;
+            break;
+          case 'o':
+            spec.flags = (spec.flags & ~std::ios_base::dec) | std::ios_base::oct;
+            break;
+          case 'e':
+            spec.flags |= std::ios_base::scientific;
+            break;
+          case 'E':
+            spec.flags |= std::ios_base::scientific | std::ios_base::uppercase;
+            break;
+          case 'f': case 'F':
+            spec.flags |= std::ios_base::fixed;
+            break;
+          case 'G':
+            spec.flags |= std::ios_base::uppercase;
+            break;
+          default:
+            return inPipes ? p : nullptr;
+          }
+          return p + 1;
+        }
+
+        void printArg(std::ostream& os, const FormatArg& arg, const FormatSpec& spec)
+        {
+          const std::ios_base::fmtflags oldFlags = os.flags(spec.flags);
+          const std::streamsize oldPrecision = os.precision();
+          const char oldFill = os.fill(spec.fill);
+          if (spec.precision >= 0)
+            os.precision(spec.precision);
+          os.width(spec.width);
+          arg.print(os, arg.value);
+          os.width(0);
+          os.precision(oldPrecision);
+          os.fill(oldFill);
+          os.flags(oldFlags);
+        }
+      }
+
+      void format(std::ostream& os, const char* fmt, const FormatArg* args, std::size_t count)
+      {
+        std::size_t next = 0;
+        const char* literal = fmt; // start of the text not written yet
+        const char* p = fmt;
+        while (*p)
+        {
+          if ((*p == '{' && p[1] == '{') || (*p == '}' && p[1] == '}'))
+          {
+            os.write(literal, p + 1 - literal);
+            p += 2;
+            literal = p;
+            continue;
+          }
+          if (*p == '{' && p[1] == '}')
+          {
+            if (next < count)
+            {
+              os.write(literal, p - literal);
+              args[next].print(os, args[next].value);
+              ++next;
+              literal = p + 2;
+            }
+            p += 2;
+            continue;
+          }
+          if (*p != '%')
+          {
+            ++p;
+            continue;
+          }
+
+          os.write(literal, p - literal);
+          const char* directive = p++;
+          if (*p == '%')
+          {
+            os.put('%');
+            literal = ++p;
+            continue;
+          }
+
+          FormatSpec spec;
+          const char* end = nullptr;
+          if (*p == '|')
+          {
+            end = parsePrintfSpec(p + 1, spec, true);
+            end = (end && *end == '|') ? end + 1 : nullptr;
+          }
+          else
+          {
+            const char* q = p;
+            const int n = parseNumber(q);
+            if (n > 0 && *q == '%')
+            {
+              spec.index = n - 1;
+              end = q + 1;
+            }
+            else
+              end = parsePrintfSpec(p, spec, false);
+          }
+
+          if (!end)
+          {
+            // Not a directive, keep the text as is.
+            literal = directive;
+            p = directive + 1;
+            continue;
+          }
+          const std::size_t index = spec.index >= 0 ? static_cast<std::size_t>(spec.index) : next++;
+          if (index < count)
+            printArg(os, args[index], spec);
+          p = end;
+          literal = p;
+        }
+        os.write(literal, p - literal);
+      }
     }
 
     namespace detail {
@@ -613,8 +913,12 @@ namespace qi {
       boost::lock(lock, lockHandlers);
       while (logs.pop(pl))
       {
-        dispatch_unsynchronized(pl->_logLevel, pl->_date, pl->_systemDate, pl->_category, pl->_log,
-                                pl->_file, pl->_function, pl->_line);
+        if (pl->_categoryType)
+          dispatch_unsynchronized(pl->_logLevel, pl->_date, pl->_systemDate, *pl->_categoryType,
+                                  pl->_log, pl->_file, pl->_function, pl->_line);
+        else
+          dispatch_unsynchronized(pl->_logLevel, pl->_date, pl->_systemDate, pl->_category, pl->_log,
+                                  pl->_file, pl->_function, pl->_line);
       }
     }
 
@@ -763,6 +1067,19 @@ namespace qi {
       ::qi::log::detail::log(verb, category, category->name.c_str(), msg.c_str(), file, fct, line);
     }
 
+    void log(const qi::LogLevel    verb,
+             CategoryType          category,
+             const char           *msg,
+             const char           *file,
+             const char           *fct,
+             const int             line)
+    {
+      if (!isVisible(category, verb))
+        return;
+
+      ::qi::log::detail::log(verb, category, category->name.c_str(), msg, file, fct, line);
+    }
+
     void log(const qi::LogLevel    verb,
              const char           *categoryStr,
              const char           *msg,
@@ -770,10 +1087,11 @@ namespace qi {
              const char           *fct,
              const int             line)
     {
-      if (!isVisible(categoryStr, verb))
+      CategoryType category = addCategory(categoryStr);
+      if (!isVisible(category, verb))
         return;
 
-      ::qi::log::detail::log(verb, NULL, categoryStr, msg, file, fct, line);
+      ::qi::log::detail::log(verb, category, categoryStr, msg, file, fct, line);
     }
 
     void detail::log(const qi::LogLevel    verb,
@@ -809,6 +1127,7 @@ namespace qi {
         privateLog* pl = &(LogBuffer[tmpRtLogPush]);
 
         pl->_logLevel = verb;
+        pl->_categoryType = category;
         pl->_line = line;
         pl->_date = date;
         pl->_systemDate = systemDate;
@@ -4,10 +4,13 @@
 */
 
 #include <boost/make_shared.hpp>
+#include <boost/optional.hpp>
 
 #include <qi/anyobject.hpp>
+#include <qi/deadline.hpp>
 #include <qi/type/objecttypebuilder.hpp>
 #include "boundobject.hpp"
+#include "traceprobes.hpp"
 
 qiLogCategory("qimessaging.boundobject");
 
@@ -98,6 +101,7 @@ namespace qi {
     , _callType(mct)
     , _owner(owner)
   {
+    _admission = boost::make_shared<CallAdmissionControl>(defaultCallAdmissionPolicy());
     _self = createServiceBoundObjectType(this, bindTerminate);
   }
 
@@ -206,6 +210,14 @@ namespace qi {
   }
 
 
+  qi::MetaObject ServiceBoundObject::serializedMetaObject()
+  {
+    boost::recursive_mutex::scoped_lock lock(_mutex);
+    if (!_serializedMetaObject)
+      _serializedMetaObject = metaObject(_objectId);
+    return *_serializedMetaObject;
+  }
+
   void ServiceBoundObject::terminate(unsigned int)
   {
     qiLogDebug() << "terminate() received";
@@ -226,6 +238,42 @@ namespace qi {
   }
 
   void ServiceBoundObject::onMessage(const qi::Message &msg, MessageSocketPtr socket) {
+    QI_TRACE_MESSAGE(server_message, msg);
+    // The time spent in transit is not known, the deadline of a call starts on its reception.
+    const SteadyClockTimePoint receivedAt = SteadyClock::now();
+    if (msg.type() != Message::Type_Call || !(msg.flags() & Message::TypeFlag_Sequential)
+        || msg.object() != _objectId)
+    {
+      processMessage(msg, socket, receivedAt, CallAdmissionControl::Ticket(), SequenceToken());
+      return;
+    }
+
+    // A sequential call starts once the previous one from the socket has returned. The
+    // continuation is asynchronous, as the token may be released while holding _callMutex.
+    Promise<void> done(FutureCallbackType_Async);
+    SequenceToken sequence(static_cast<void*>(nullptr), [done](void*) mutable { done.setValue(nullptr); });
+    Future<void> previous;
+    {
+      boost::mutex::scoped_lock lock(_sequencesMutex);
+      Future<void>& last = _sequences[socket];
+      previous = last;
+      last = done.future();
+    }
+    if (!previous.isValid() || previous.isFinished())
+    {
+      processMessage(msg, socket, receivedAt, CallAdmissionControl::Ticket(), sequence);
+      return;
+    }
+    qiLogDebug() << "Call " << msg.address() << " waits for the previous sequential call";
+    previous.connect(qi::track([=](Future<void>) {
+      processMessage(msg, socket, receivedAt, CallAdmissionControl::Ticket(), sequence);
+    }, this));
+  }
+
+  void ServiceBoundObject::processMessage(const qi::Message& msg, MessageSocketPtr socket,
+                                          SteadyClockTimePoint receivedAt,
+                                          CallAdmissionControl::Ticket admission,
+                                          SequenceToken sequence) {
     boost::mutex::scoped_lock lock(_callMutex);
     try {
       if (msg.version() > Message::Header::currentVersion())
@@ -261,9 +309,22 @@ namespace qi {
 
       qi::Signature sigparam;
       GenericFunctionParameters mfp;
+      boost::optional<SteadyClockTimePoint> deadline;
 
       // Validate call target
       if (msg.type() == qi::Message::Type_Call) {
+        // Do not even decode the calls whose caller has given up.
+        if (const auto timeLeft = msg.timeLeft())
+        {
+          deadline = receivedAt + *timeLeft;
+          if (SteadyClock::now() >= *deadline)
+          {
+            qiLogVerbose() << "Dropping call " << msg.address() << ": its deadline expired";
+            serverResultAdapter(qi::makeFutureError<AnyReference>(deadlineExpiredError), Signature(),
+                                _gethost(), socket, msg.address(), Signature(), CancelableKitWeak());
+            return;
+          }
+        }
         const qi::MetaMethod *mm = obj.metaObject().method(funcId);
         if (!mm) {
           std::stringstream ss;
@@ -272,6 +333,26 @@ namespace qi {
           throw std::runtime_error(ss.str());
         }
         sigparam = mm->parametersSignature();
+
+        // Calls waiting for admission come back here with their ticket.
+        if (!isSpecialFunction && !admission)
+        {
+          auto start = qi::track([=](CallAdmissionControl::Ticket ticket) {
+            processMessage(msg, socket, receivedAt, ticket, sequence);
+          }, this);
+          switch (_admission->admit(socket, admission, start))
+          {
+          case CallAdmissionControl::Admission::Admitted:
+            break;
+          case CallAdmissionControl::Admission::Queued:
+            qiLogDebug() << "Queuing call " << msg.address();
+            return;
+          case CallAdmissionControl::Admission::Rejected:
+            serverResultAdapter(qi::makeFutureError<AnyReference>(serviceOverloadedError), Signature(),
+                                _gethost(), socket, msg.address(), Signature(), CancelableKitWeak());
+            return;
+          }
+        }
       }
 
       else if (msg.type() == qi::Message::Type_Post) {
@@ -360,7 +441,14 @@ namespace qi {
         qi::MetaCallType callType = isUserDefinedFunction ? _callType : MetaCallType_Direct;
 
         qi::Signature sig = returnSignature.empty() ? Signature() : Signature(returnSignature);
+        // The call is dropped if its deadline expires before it is executed, and the deadline
+        // propagates to the calls it makes.
+        boost::optional<ScopedDeadline> scopedDeadline;
+        if (deadline)
+          scopedDeadline.emplace(*deadline);
+        QI_TRACE_MESSAGE(server_call_start, msg);
         qi::Future<AnyReference> fut = obj.metaCall(funcId, mfp, callType, sig);
+        scopedDeadline = boost::none;
         AtomicIntPtr cancelRequested = boost::make_shared<Atomic<int> >(0);
         {
           qiLogDebug() << this << " Registering future for " << socket.get() << ", message:" << msg.id();
@@ -376,6 +464,11 @@ namespace qi {
         fut.connect(boost::bind<void>
                     (&ServiceBoundObject::serverResultAdapter, _1, retSig, _gethost(), socket, msg.address(), sig,
                      CancelableKitWeak(_cancelables), cancelRequested));
+        // The call holds its admission ticket and its sequence token until it returns.
+        fut.connect([admission, sequence](Future<AnyReference>) mutable {
+          admission.reset();
+          sequence.reset();
+        });
       }
         break;
       case Message::Type_Post: {
@@ -487,6 +580,11 @@ namespace qi {
       boost::mutex::scoped_lock lock(_cancelables->guard);
       _cancelables->map.erase(client);
     }
+    _admission->dropQueued(client);
+    {
+      boost::mutex::scoped_lock lock(_sequencesMutex);
+      _sequences.erase(client);
+    }
     BySocketServiceSignalLinks::iterator it = _links.find(client);
     if (it != _links.end())
     {
@@ -669,6 +767,8 @@ namespace qi {
                                                CancelableKitWeak kit,
                                                AtomicIntPtr cancelRequested)
   {
+    QI_TRACEPOINT(qi_qi, server_call_result, replyaddr.messageId, replyaddr.serviceId,
+               replyaddr.objectId, replyaddr.functionId, qi::Message::Type_Reply);
     if(!socket->isConnected())
     {
       _removeCachedFuture(kit, socket, replyaddr.messageId);
@@ -17,6 +17,7 @@
 #include <qi/atomic.hpp>
 #include <qi/strand.hpp>
 
+#include "calladmission.hpp"
 #include "objecthost.hpp"
 
 using AtomicBoolptr = boost::shared_ptr<qi::Atomic<bool>>;
@@ -92,6 +93,8 @@ namespace qi {
     qi::Future<SignalLink> registerEventWithSignature(unsigned int serviceId, unsigned int eventId, SignalLink linkId, const std::string& signature);
     qi::Future<void> unregisterEvent(unsigned int serviceId, unsigned int eventId, SignalLink linkId);
     qi::MetaObject metaObject(unsigned int serviceId);
+    // The metaObject sent along with the object when it is passed by value, computed once.
+    qi::MetaObject serializedMetaObject();
     void           terminate(unsigned int serviceId); //bound only in special cases
     qi::Future<AnyValue> property(const AnyValue& name);
     Future<void>   setProperty(const AnyValue& name, AnyValue value);
@@ -115,6 +118,9 @@ namespace qi {
     }
 
     inline AnyObject object() { return _object;}
+
+    // Admission of the calls to the methods of the object.
+    inline const CallAdmissionControlPtr& callAdmission() const { return _admission; }
   public:
     //BoundObject Interface
     virtual void onMessage(const qi::Message &msg, MessageSocketPtr socket);
@@ -124,6 +130,13 @@ namespace qi {
     void cancelCall(MessageSocketPtr origSocket, const Message& cancelMessage, MessageId origMsgId);
 
   private:
+    // Held by a sequential call until it returns, see Message::TypeFlag_Sequential.
+    using SequenceToken = boost::shared_ptr<void>;
+
+    void processMessage(const qi::Message& msg, MessageSocketPtr socket,
+                        SteadyClockTimePoint receivedAt, CallAdmissionControl::Ticket admission,
+                        SequenceToken sequence);
+
     using FutureMap = std::map<MessageId, std::pair<Future<AnyReference>, AtomicIntPtr>>;
     using CancelableMap = std::map<MessageSocketPtr, FutureMap>;
     struct CancelableKit;
@@ -154,6 +167,10 @@ namespace qi {
     BySocketServiceSignalLinks  _links;
 
     boost::mutex _callMutex;
+    CallAdmissionControlPtr _admission;
+    // The completion of the last sequential call received from each socket.
+    boost::mutex _sequencesMutex;
+    std::map<MessageSocketPtr, Future<void>> _sequences;
   private:
     qi::MessageSocketPtr _currentSocket;
     unsigned int           _serviceId;
@@ -165,6 +182,7 @@ namespace qi {
     // prevents parallel onMessage on self execution and protects the current socket
     mutable boost::recursive_mutex           _mutex;
     boost::function<void (MessageSocketPtr, std::string)> _onSocketDisconnectedCallback;
+    boost::optional<qi::MetaObject> _serializedMetaObject;
 
     static qi::Atomic<unsigned int> _nextId;
 
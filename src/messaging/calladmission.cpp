@@ -0,0 +1,159 @@
+#include <qi/eventloop.hpp>
+#include <qi/getenv.hpp>
+#include <qi/log.hpp>
+#include "calladmission.hpp"
+
+qiLogCategory("qimessaging.calladmission");
+
+namespace qi
+{
+  const char* const serviceOverloadedError = "Call rejected: the service is overloaded";
+
+  CallAdmissionPolicy CallAdmissionPolicy::fromEnvironment()
+  {
+    CallAdmissionPolicy policy;
+    try
+    {
+      policy.maxCalls = qi::os::getEnvDefault("QI_SERVICE_MAX_CALLS", 0u);
+      policy.maxCallsPerSocket = qi::os::getEnvDefault("QI_SERVICE_MAX_CALLS_PER_SOCKET", 0u);
+      policy.maxQueued = qi::os::getEnvDefault("QI_SERVICE_MAX_QUEUED_CALLS", 0u);
+    }
+    catch (const boost::bad_lexical_cast& e)
+    {
+      throw std::runtime_error(std::string("Invalid call admission limit in the environment: ") + e.what());
+    }
+    return policy;
+  }
+
+  const CallAdmissionPolicy& defaultCallAdmissionPolicy()
+  {
+    // Read once: a bound object is created for each service and each object returned by a call.
+    static const CallAdmissionPolicy policy = []() -> CallAdmissionPolicy
+    {
+      try
+      {
+        return CallAdmissionPolicy::fromEnvironment();
+      }
+      catch (const std::exception& ex)
+      {
+        qiLogWarning() << ex.what() << ", the calls to the services are not limited.";
+        return CallAdmissionPolicy();
+      }
+    }();
+    return policy;
+  }
+
+  CallAdmissionControl::CallAdmissionControl(const CallAdmissionPolicy& policy)
+    : _policy(policy)
+  {
+  }
+
+  bool CallAdmissionControl::isAdmissible(const MessageSocketPtr& socket) const
+  {
+    if (_policy.maxCalls && _statistics.inFlight >= _policy.maxCalls)
+      return false;
+    if (_policy.maxCallsPerSocket)
+    {
+      const auto it = _inFlightPerSocket.find(socket);
+      if (it != _inFlightPerSocket.end() && it->second >= _policy.maxCallsPerSocket)
+        return false;
+    }
+    return true;
+  }
+
+  CallAdmissionControl::Ticket CallAdmissionControl::makeTicket(const MessageSocketPtr& socket)
+  {
+    ++_statistics.inFlight;
+    ++_inFlightPerSocket[socket];
+    ++_statistics.admitted;
+    // The ticket must not keep the control alive: the bound object owning it may be gone when
+    // the last call finishes.
+    boost::weak_ptr<CallAdmissionControl> weakSelf = shared_from_this();
+    return Ticket(static_cast<void*>(nullptr), [weakSelf, socket](void*) {
+      if (auto self = weakSelf.lock())
+        self->release(socket);
+    });
+  }
+
+  CallAdmissionControl::Admission CallAdmissionControl::admit(const MessageSocketPtr& socket,
+                                                              Ticket& ticket,
+                                                              StartCall start)
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    // Calls do not overtake the queued ones.
+    if (_queue.empty() && isAdmissible(socket))
+    {
+      ticket = makeTicket(socket);
+      return Admission::Admitted;
+    }
+    if (_queue.size() < _policy.maxQueued)
+    {
+      _queue.push_back(QueuedCall{socket, std::move(start)});
+      ++_statistics.delayed;
+      return Admission::Queued;
+    }
+    ++_statistics.rejected;
+    qiLogVerbose() << "Rejecting call: " << _statistics.inFlight << " calls in flight, "
+                   << _queue.size() << " queued";
+    return Admission::Rejected;
+  }
+
+  void CallAdmissionControl::release(const MessageSocketPtr& socket)
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    --_statistics.inFlight;
+    const auto it = _inFlightPerSocket.find(socket);
+    if (it != _inFlightPerSocket.end() && --it->second == 0)
+      _inFlightPerSocket.erase(it);
+    admitQueued();
+  }
+
+  void CallAdmissionControl::admitQueued()
+  {
+    auto it = _queue.begin();
+    while (it != _queue.end())
+    {
+      if (_policy.maxCalls && _statistics.inFlight >= _policy.maxCalls)
+        return;
+      if (!isAdmissible(it->socket))
+      {
+        ++it;
+        continue;
+      }
+      Ticket ticket = makeTicket(it->socket);
+      // The ticket may be released from the thread starting the call, which might hold locks
+      // of the caller of release.
+      StartCall start = std::move(it->start);
+      qi::getEventLoop()->post([start, ticket] { start(ticket); });
+      it = _queue.erase(it);
+    }
+  }
+
+  void CallAdmissionControl::dropQueued(const MessageSocketPtr& socket)
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    for (auto it = _queue.begin(); it != _queue.end();)
+    {
+      if (it->socket == socket)
+        it = _queue.erase(it);
+      else
+        ++it;
+    }
+  }
+
+  void CallAdmissionControl::setPolicy(const CallAdmissionPolicy& policy)
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    _policy = policy;
+    // The calls already queued stay queued even if the queue is now too long.
+    admitQueued();
+  }
+
+  CallAdmissionStatistics CallAdmissionControl::statistics() const
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    CallAdmissionStatistics statistics = _statistics;
+    statistics.queued = static_cast<unsigned int>(_queue.size());
+    return statistics;
+  }
+}
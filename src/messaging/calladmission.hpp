@@ -0,0 +1,75 @@
+#pragma once
+
+#ifndef _SRC_CALLADMISSION_HPP_
+#define _SRC_CALLADMISSION_HPP_
+
+#include <deque>
+#include <map>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <qi/session.hpp>
+#include "messagesocket.hpp"
+
+namespace qi
+{
+  /// The policy of the services, read from the environment on first use. Unlike
+  /// CallAdmissionPolicy::fromEnvironment(), invalid values are logged and the calls are not limited.
+  const CallAdmissionPolicy& defaultCallAdmissionPolicy();
+
+  /**
+   * Decides whether the calls to a bound object may start, following a CallAdmissionPolicy.
+   *
+   * An admitted call holds a ticket for as long as it runs. Releasing the ticket admits the
+   * queued calls which fit the limits again, in their order of arrival. They are started
+   * asynchronously, so that a ticket may be released from anywhere.
+   */
+  class CallAdmissionControl : public boost::enable_shared_from_this<CallAdmissionControl>
+  {
+  public:
+    /// Held by an admitted call until it finishes.
+    using Ticket = boost::shared_ptr<void>;
+    using StartCall = boost::function<void (Ticket)>;
+
+    enum class Admission
+    {
+      Admitted, ///< the ticket is set, the call may start
+      Queued,   ///< start will be called with a ticket once the call is admitted
+      Rejected, ///< the service is overloaded
+    };
+
+    explicit CallAdmissionControl(const CallAdmissionPolicy& policy);
+
+    Admission admit(const MessageSocketPtr& socket, Ticket& ticket, StartCall start);
+
+    /// Forgets the calls queued for a socket which got disconnected.
+    void dropQueued(const MessageSocketPtr& socket);
+
+    void setPolicy(const CallAdmissionPolicy& policy);
+    CallAdmissionStatistics statistics() const;
+
+  private:
+    struct QueuedCall
+    {
+      MessageSocketPtr socket;
+      StartCall start;
+    };
+
+    // Call with _mutex locked.
+    bool isAdmissible(const MessageSocketPtr& socket) const;
+    Ticket makeTicket(const MessageSocketPtr& socket);
+    void release(const MessageSocketPtr& socket);
+    void admitQueued();
+
+    mutable boost::mutex _mutex;
+    CallAdmissionPolicy _policy;
+    CallAdmissionStatistics _statistics;
+    std::map<MessageSocketPtr, unsigned int> _inFlightPerSocket;
+    std::deque<QueuedCall> _queue;
+  };
+
+  using CallAdmissionControlPtr = boost::shared_ptr<CallAdmissionControl>;
+}
+
+#endif  // _SRC_CALLADMISSION_HPP_
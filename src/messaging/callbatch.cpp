@@ -0,0 +1,87 @@
+#include <boost/thread/tss.hpp>
+#include <qi/log.hpp>
+#include "callbatch_p.hpp"
+
+qiLogCategory("qimessaging.callbatch");
+
+namespace qi
+{
+namespace detail
+{
+  namespace
+  {
+    // Batches are owned by their ScopedCallBatch, not by the thread.
+    void doNotDelete(CallBatch*)
+    {
+    }
+
+    boost::thread_specific_ptr<CallBatch>& threadBatch()
+    {
+      // Never destroyed: calls may run during static destruction.
+      static auto* batch = new boost::thread_specific_ptr<CallBatch>(&doNotDelete);
+      return *batch;
+    }
+  }
+
+  CallBatch::CallBatch(ScopedCallBatch::CallOrder order)
+    : _order(order)
+  {
+  }
+
+  void CallBatch::add(MessageSocketPtr socket, Message msg, boost::function<void()> onSendError)
+  {
+    _calls.push_back(Call{std::move(socket), std::move(msg), std::move(onSendError)});
+  }
+
+  void CallBatch::flush()
+  {
+    std::vector<Call> calls;
+    calls.swap(_calls);
+    std::vector<bool> grouped(calls.size(), false);
+    for (std::size_t first = 0; first < calls.size(); ++first)
+    {
+      if (grouped[first])
+        continue;
+      // The calls to the same socket, in the order they were made.
+      const MessageSocketPtr socket = calls[first].socket;
+      std::vector<std::size_t> group;
+      std::vector<Message> msgs;
+      for (std::size_t i = first; i < calls.size(); ++i)
+      {
+        if (calls[i].socket != socket)
+          continue;
+        grouped[i] = true;
+        group.push_back(i);
+        msgs.push_back(std::move(calls[i].msg));
+      }
+      const std::size_t sent = socket->sendAll(std::move(msgs));
+      qiLogDebug() << "Sent " << sent << "/" << group.size() << " calls to socket " << socket.get();
+      for (std::size_t i = sent; i < group.size(); ++i)
+        calls[group[i]].onSendError();
+    }
+  }
+
+  CallBatch* currentCallBatch()
+  {
+    return threadBatch().get();
+  }
+}
+
+  ScopedCallBatch::ScopedCallBatch(CallOrder order)
+    : _batch(new detail::CallBatch(order))
+    , _previous(detail::currentCallBatch())
+  {
+    detail::threadBatch().reset(_batch.get());
+  }
+
+  ScopedCallBatch::~ScopedCallBatch()
+  {
+    detail::threadBatch().reset(_previous);
+    flush();
+  }
+
+  void ScopedCallBatch::flush()
+  {
+    _batch->flush();
+  }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#ifndef _SRC_CALLBATCH_P_HPP_
+#define _SRC_CALLBATCH_P_HPP_
+
+#include <vector>
+#include <boost/function.hpp>
+#include <qi/messaging/callbatch.hpp>
+#include "message.hpp"
+#include "messagesocket.hpp"
+
+namespace qi
+{
+namespace detail
+{
+  /// The calls of a ScopedCallBatch waiting to be sent.
+  class CallBatch
+  {
+  public:
+    explicit CallBatch(ScopedCallBatch::CallOrder order);
+
+    ScopedCallBatch::CallOrder order() const { return _order; }
+
+    /// onSendError is called if the message cannot be handed over to the socket.
+    void add(MessageSocketPtr socket, Message msg, boost::function<void()> onSendError);
+
+    /// Sends the messages, grouped by socket, in order.
+    void flush();
+
+  private:
+    struct Call
+    {
+      MessageSocketPtr socket;
+      Message msg;
+      boost::function<void()> onSendError;
+    };
+
+    const ScopedCallBatch::CallOrder _order;
+    std::vector<Call> _calls;
+  };
+
+  /// The innermost batch of the current thread, null if none.
+  CallBatch* currentCallBatch();
+}
+}
+
+#endif  // _SRC_CALLBATCH_P_HPP_
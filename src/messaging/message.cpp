@@ -208,26 +208,38 @@ namespace qi
       if (!host || !strCtxt)
         throw std::runtime_error("Unable to serialize object without a valid ObjectHost and StreamContext");
       unsigned int sid = host->service();
-      unsigned int oid = host->nextId();
-      ServiceBoundObject* sbo =
-          new ServiceBoundObject(sid, oid, object, MetaCallType_Queued, true, context);
-      boost::shared_ptr<BoundObject> bo(sbo);
-      host->addObject(bo, strCtxt, oid);
-      qiLogDebug() << "Hooking " << oid <<" on " << host.get();
-      qiLogDebug() << "sbo " << sbo << "obj " << object.asGenericObject();
+      const PtrUid uid = object.ptrUid();
+      // An object sent again on the same stream keeps its id, so that the remote end reuses its
+      // proxy. It stays bound until the remote end released all the references it received.
+      unsigned int oid = 0;
+      auto sbo = boost::dynamic_pointer_cast<ServiceBoundObject>(host->addReference(uid, strCtxt, oid));
+      if (sbo)
+        qiLogDebug() << "Reusing " << oid << " on " << host.get();
+      else
+      {
+        oid = host->nextId();
+        sbo.reset(new ServiceBoundObject(sid, oid, object, MetaCallType_Queued, true, context));
+        host->addSharedObject(sbo, uid, strCtxt, oid);
+        qiLogDebug() << "Hooking " << oid <<" on " << host.get();
+        qiLogDebug() << "sbo " << sbo.get() << "obj " << object.asGenericObject();
+      }
       // Transmit the metaObject augmented by ServiceBoundObject.
       ObjectSerializationInfo res;
-      res.metaObject = sbo->metaObject(oid);
+      res.metaObject = sbo->serializedMetaObject();
       res.serviceId = sid;
       res.objectId = oid;
-      res.objectPtrUid = object.ptrUid();
+      res.objectPtrUid = uid;
       return res;
     }
 
-    void onProxyLost(GenericObject* ptr)
+    void onProxyLost(GenericObject* ptr, boost::weak_ptr<MessageSocket> weakSocket,
+                     StreamContext::ReceivedReferences references)
     {
       qiLogDebug() << "Proxy on argument object lost, invoking terminate...";
       DynamicObject* dobj = reinterpret_cast<DynamicObject*>(ptr->value);
+      RemoteObject* ro = static_cast<RemoteObject*>(dobj);
+      if (auto socket = weakSocket.lock())
+        socket->forgetReceivedObject(ro->service(), ro->object(), references);
       // dobj is a RemoteObject
       /* Warning, we are in a shared_ptr destruction callback.
       * So we cannot reacquire the shared_ptr, which call/post will try to
@@ -243,9 +255,11 @@ namespace qi
       }
       GenericFunctionParameters params;
       // Argument is unused by remote end, but better pass something valid just in case.
-      int sid = static_cast<RemoteObject*>(dobj)->service();
+      int sid = ro->service();
       params.push_back(AnyReference::from(sid));
-      dobj->metaPost(AnyObject(), mid, params);
+      // The remote end releases one reference per terminate.
+      for (unsigned int i = references->load(); i; --i)
+        dobj->metaPost(AnyObject(), mid, params);
     }
 
     AnyObject deserializeObject(const ObjectSerializationInfo& osi,
@@ -253,16 +267,44 @@ namespace qi
     {
       if (!context)
         throw std::runtime_error("Unable to deserialize object without a valid TransportSocket");
+      if (AnyObject o = context->receivedObject(osi.serviceId, osi.objectId))
+      {
+        qiLogDebug() << "Reusing object " << osi.serviceId << '/' << osi.objectId
+                     << " on " << context.get();
+        return o;
+      }
       qiLogDebug() << "Creating unregistered object " << osi.serviceId << '/' << osi.objectId
                    << " on " << context.get();
+      auto references = boost::make_shared<Atomic<unsigned int>>(1);
       RemoteObject* ro = new RemoteObject(osi.serviceId, osi.objectId, osi.metaObject, context);
-      AnyObject o = makeDynamicAnyObject(ro, true, osi.objectPtrUid, &onProxyLost);
+      AnyObject o = makeDynamicAnyObject(ro, true, osi.objectPtrUid,
+          boost::bind(&onProxyLost, _1, boost::weak_ptr<MessageSocket>(context), references));
       qiLogDebug() << "New object is " << o.asGenericObject() << "on ro " << ro;
       QI_ASSERT(o);
+      context->setReceivedObject(osi.serviceId, osi.objectId, o, references);
       return o;
     }
   }
 
+  void Message::setTimeLeft(MicroSeconds timeLeft)
+  {
+    QI_ASSERT(_buffer.totalSize() == 0 && "the deadline must prefix the payload");
+    const qi::int64_t us = timeLeft.count();
+    _buffer.write(&us, sizeof(us));
+    _header.size = static_cast<qi::uint32_t>(_buffer.totalSize());
+    addFlags(TypeFlag_Deadline);
+  }
+
+  boost::optional<MicroSeconds> Message::timeLeft() const
+  {
+    if (!(flags() & TypeFlag_Deadline))
+      return boost::none;
+    qi::int64_t us = 0;
+    if (_buffer.read(&us, 0, sizeof(us)) != sizeof(us))
+      throw std::runtime_error("Message flagged with a deadline is too short to hold it");
+    return MicroSeconds(us);
+  }
+
   AnyReference Message::value(const qi::Signature& signature,
                               const qi::MessageSocketPtr& socket) const
   {
@@ -272,6 +314,8 @@ namespace qi
       throw std::runtime_error("Could not construct type for " + signature.toString());
     }
     qi::BufferReader br(_buffer);
+    if (flags() & TypeFlag_Deadline)
+      br.seek(sizeof(qi::int64_t));
     //TODO: not exception safe
     AnyReference res(type);
     return decodeBinary(&br, res, boost::bind(deserializeObject, _1, socket), socket.get());
@@ -11,12 +11,14 @@
 #include <qi/api.hpp>
 #include <qi/anyvalue.hpp>
 #include <qi/buffer.hpp>
+#include <qi/clock.hpp>
 #include <qi/binarycodec.hpp>
 #include <qi/anyfunction.hpp>
 #include <qi/types.hpp>
 #include <qi/macroregular.hpp>
 #include <qi/assert.hpp>
 #include <qi/scoped.hpp>
+#include <boost/optional.hpp>
 #include <boost/weak_ptr.hpp>
 
 namespace qi {
@@ -161,6 +163,16 @@ namespace qi {
      * NOT IMPLEMENTED
      */
     static const unsigned int TypeFlag_ReturnType = 2;
+    /* If flag is set, the payload of a call is prefixed by the time the caller
+     * still waits for its result, in microseconds, as a signed 64 bits integer.
+     * Only sent to remote ends having the CallDeadline capability.
+     */
+    static const unsigned int TypeFlag_Deadline = 4;
+    /* If flag is set, the call starts once the previous call with this flag,
+     * received from the same socket on the same object, has returned.
+     * Only sent to remote ends having the SequentialCalls capability.
+     */
+    static const unsigned int TypeFlag_Sequential = 8;
 
     QI_API static const char* typeToString(Type t);
     QI_API static const char* actionToString(unsigned int action, unsigned int service);
@@ -296,6 +308,14 @@ namespace qi {
       setValue(AnyReference::from(v), "m");
     }
 
+    /// Prefixes the payload with the time left before the deadline of the call, and sets
+    /// TypeFlag_Deadline. Must be called before the payload is set.
+    QI_API void setTimeLeft(MicroSeconds timeLeft);
+
+    /// @return the time that was left before the deadline of the call when it was sent,
+    /// if the message has TypeFlag_Deadline.
+    QI_API boost::optional<MicroSeconds> timeLeft() const;
+
     ///@return signature, set by setParameters() or setSignature()
     QI_API AnyReference value(const Signature &signature, const qi::MessageSocketPtr &socket) const;
 
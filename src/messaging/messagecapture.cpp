@@ -0,0 +1,90 @@
+#include <atomic>
+#include <stdexcept>
+#include <qi/application.hpp>
+#include <qi/log.hpp>
+#include <qi/os.hpp>
+#include <qi/messaging/sock/send.hpp>
+#include "messagecapture.hpp"
+
+qiLogCategory("qimessaging.capture");
+
+namespace qi
+{
+  namespace
+  {
+    // Bounds the messages lost if the process does not exit normally.
+    const MilliSeconds flushPeriod{100};
+
+    MessageCapture* openCapture()
+    {
+      const std::string path = qi::os::getenv("QI_MESSAGE_CAPTURE");
+      if (path.empty())
+        return nullptr;
+      try
+      {
+        // Leaked on purpose: sockets may still be used while the process exits.
+        MessageCapture* capture = new MessageCapture(path);
+        qi::Application::atExit([capture] { capture->flush(); });
+        qiLogWarning() << "Capturing the messages, credentials included, into " << path;
+        return capture;
+      }
+      catch (const std::exception& e)
+      {
+        qiLogError() << "Messages will not be captured: " << e.what();
+        return nullptr;
+      }
+    }
+  }
+
+  const qi::uint32_t MessageCapture::fileMagic;
+  const qi::uint32_t MessageCapture::fileVersion;
+
+  MessageCapture* MessageCapture::instance()
+  {
+    static MessageCapture* const capture = openCapture();
+    return capture;
+  }
+
+  MessageCapture::MessageCapture(const std::string& path)
+    : _file(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc)
+    , _start(SteadyClock::now())
+    , _lastFlush(_start)
+  {
+    if (!_file.is_open())
+      throw std::runtime_error("Cannot open " + path);
+    _file.write(reinterpret_cast<const char*>(&fileMagic), sizeof(fileMagic));
+    _file.write(reinterpret_cast<const char*>(&fileVersion), sizeof(fileVersion));
+  }
+
+  qi::uint32_t MessageCapture::newConnection()
+  {
+    static std::atomic<qi::uint32_t> lastConnection{0};
+    return ++lastConnection;
+  }
+
+  void MessageCapture::record(Direction direction, qi::uint32_t connection, const Message& msg)
+  {
+    const SteadyClockTimePoint now = SteadyClock::now();
+    const qi::int64_t elapsed = boost::chrono::duration_cast<NanoSeconds>(now - _start).count();
+
+    boost::mutex::scoped_lock lock(_mutex);
+    const qi::uint8_t dir = static_cast<qi::uint8_t>(direction);
+    _file.write(reinterpret_cast<const char*>(&elapsed), sizeof(elapsed));
+    _file.write(reinterpret_cast<const char*>(&connection), sizeof(connection));
+    _file.write(reinterpret_cast<const char*>(&dir), sizeof(dir));
+    sock::forEachMessageChunk(msg, [this](const void* data, std::size_t size) {
+      _file.write(static_cast<const char*>(data), size);
+    });
+    if (now - _lastFlush >= flushPeriod)
+    {
+      _file.flush();
+      _lastFlush = now;
+    }
+  }
+
+  void MessageCapture::flush()
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    _file.flush();
+  }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#ifndef _SRC_MESSAGECAPTURE_HPP_
+#define _SRC_MESSAGECAPTURE_HPP_
+
+#include <fstream>
+#include <string>
+#include <boost/thread/mutex.hpp>
+#include <qi/clock.hpp>
+#include <qi/types.hpp>
+#include "message.hpp"
+
+namespace qi
+{
+  /**
+   * Records the messages sent and received by the sockets of the process into a file.
+   * It is enabled by setting QI_MESSAGE_CAPTURE to the path of the file, which is overwritten.
+   *
+   * The messages are captured in clear, authentication included: the file contains the
+   * credentials given to the sessions of the process and must be protected as such.
+   *
+   * All integers are in the byte order of the recording machine, as the messages are on
+   * the network: a reader detects a different byte order from the magic. The file starts with:
+   * - uint32 magic, fileMagic
+   * - uint32 version, fileVersion
+   * Then comes one record per message:
+   * - int64 nanoseconds elapsed since the capture started
+   * - uint32 connection id, see newConnection()
+   * - uint8 direction, see Direction
+   * - the message as sent on the network: its header (Message::Header) followed by
+   *   header.size bytes of payload.
+   */
+  class MessageCapture
+  {
+  public:
+    enum class Direction : qi::uint8_t
+    {
+      Sent = 0,
+      Received = 1,
+    };
+
+    static const qi::uint32_t fileMagic = 0x50414351; // "QCAP"
+    static const qi::uint32_t fileVersion = 1;
+
+    /// The capture of the process, null if QI_MESSAGE_CAPTURE is not set.
+    static MessageCapture* instance();
+
+    /// \throw std::runtime_error if the file cannot be opened.
+    explicit MessageCapture(const std::string& path);
+
+    /// A new connection id. Ids increase in the order connections are established and are
+    /// never reused by the process, unlike the addresses of the sockets.
+    static qi::uint32_t newConnection();
+
+    void record(Direction direction, qi::uint32_t connection, const Message& msg);
+
+    void flush();
+
+  private:
+    boost::mutex _mutex;
+    std::ofstream _file;
+    const SteadyClockTimePoint _start;
+    SteadyClockTimePoint _lastFlush;
+  };
+}
+
+#endif  // _SRC_MESSAGECAPTURE_HPP_
@@ -3,6 +3,7 @@
 **  See COPYING for the license
 */
 #include "messagedispatcher.hpp"
+#include "traceprobes.hpp"
 
 qiLogCategory("qimessaging.messagedispatcher");
 
@@ -39,6 +40,7 @@ namespace qi {
   }
 
   void MessageDispatcher::dispatch(const qi::Message& msg) {
+    QI_TRACE_MESSAGE(message_dispatch, msg);
     //remove the address from the messageSent map
     if (msg.type() == qi::Message::Type_Reply)
     {
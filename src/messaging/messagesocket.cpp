@@ -25,6 +25,18 @@ namespace qi
     return status() == qi::MessageSocket::Status::Connected;
   }
 
+  std::size_t MessageSocket::sendAll(std::vector<qi::Message> msgs)
+  {
+    std::size_t sent = 0;
+    for (const auto& msg : msgs)
+    {
+      if (!send(msg))
+        break;
+      ++sent;
+    }
+    return sent;
+  }
+
   MessageSocketPtr makeMessageSocket(const std::string &protocol, qi::EventLoop *eventLoop)
   {
     return makeTcpMessageSocket(protocol, eventLoop);
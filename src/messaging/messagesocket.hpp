@@ -12,6 +12,7 @@
 # include <qi/signal.hpp>
 # include <qi/binarycodec.hpp>
 # include <string>
+# include <vector>
 # include "messagedispatcher.hpp"
 # include "streamcontext.hpp"
 
@@ -73,6 +74,10 @@ namespace qi
 
     virtual bool send(const qi::Message &msg)                = 0;
 
+    /// Sends the messages in order, with fewer dispatches than one send() each.
+    /// \return The number of messages accepted, the first ones. Sending stops at the first failure.
+    virtual std::size_t sendAll(std::vector<qi::Message> msgs);
+
     /// Start reading if is not already reading.
     /// Must be called once if the socket is obtained through TransportServer::newConnection()
     virtual bool  ensureReading() = 0;
@@ -112,7 +117,7 @@ namespace qi
   };
 
   using MessageSocketPtr = boost::shared_ptr<MessageSocket>;
-  MessageSocketPtr makeMessageSocket(const std::string &protocol, qi::EventLoop *eventLoop = getNetworkEventLoop());
+  MessageSocketPtr makeMessageSocket(const std::string &protocol, qi::EventLoop *eventLoop = getNextNetworkEventLoop());
 }
 
 #endif  // _SRC_MESSAGESOCKET_HPP_
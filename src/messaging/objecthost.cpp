@@ -90,6 +90,29 @@ unsigned int ObjectHost::addObject(BoundAnyObject obj, StreamContext* remoteRef,
   return id;
 }
 
+unsigned int ObjectHost::addSharedObject(BoundAnyObject obj, const PtrUid& uid, StreamContext* remoteRef,
+                                         unsigned int id)
+{
+  boost::recursive_mutex::scoped_lock lock(_mutex);
+  id = addObject(obj, remoteRef, id);
+  const SharedObjectKey key(remoteRef, uid);
+  QI_ASSERT(_sharedObjectIds.find(key) == _sharedObjectIds.end());
+  _sharedObjectIds[key] = id;
+  _sharedObjects[id] = SharedObject{key, 1};
+  return id;
+}
+
+BoundAnyObject ObjectHost::addReference(const PtrUid& uid, StreamContext* remoteRef, unsigned int& id)
+{
+  boost::recursive_mutex::scoped_lock lock(_mutex);
+  auto it = _sharedObjectIds.find(SharedObjectKey(remoteRef, uid));
+  if (it == _sharedObjectIds.end())
+    return BoundAnyObject();
+  id = it->second;
+  ++_sharedObjects[id].references;
+  return _objectMap[id];
+}
+
 void ObjectHost::removeRemoteReferences(MessageSocketPtr socket)
 {
   boost::recursive_mutex::scoped_lock lock(_mutex);
@@ -99,7 +122,13 @@ void ObjectHost::removeRemoteReferences(MessageSocketPtr socket)
     return;
   Future<void> fut{nullptr};
   for (auto id : it->second)
+  {
+    // The remote end is gone with all its references.
+    auto shared = _sharedObjects.find(id);
+    if (shared != _sharedObjects.end())
+      shared->second.references = 1;
     fut = removeObject(id, fut);
+  }
 
   _remoteReferences.erase(it);
 }
@@ -142,6 +171,18 @@ Future<void> ObjectHost::removeObject(unsigned int id, Future<void> fut)
       qiLogDebug() << this << " No match in host for " << id;
       return fut;
     }
+    auto shared = _sharedObjects.find(id);
+    if (shared != _sharedObjects.end())
+    {
+      if (--shared->second.references)
+      {
+        qiLogDebug() << this << " Object " << id << " still has "
+                     << shared->second.references << " remote references";
+        return fut;
+      }
+      _sharedObjectIds.erase(shared->second.key);
+      _sharedObjects.erase(shared);
+    }
     const auto obj = it->second;
     _objectMap.erase(it);
     qiLogDebug() << this << " count " << obj.use_count();
@@ -169,6 +210,8 @@ void ObjectHost::clear()
       sbo->_owner.reset();
   }
   _objectMap.clear();
+  _sharedObjectIds.clear();
+  _sharedObjects.clear();
 }
 
 }
@@ -13,6 +13,7 @@
 #include <boost/shared_ptr.hpp>
 
 #include <qi/atomic.hpp>
+#include <qi/ptruid.hpp>
 
 #include <qi/type/fwd.hpp>
 
@@ -33,6 +34,12 @@ namespace qi
     virtual ~ObjectHost();
     void onMessage(const qi::Message &msg, MessageSocketPtr socket);
     unsigned int addObject(BoundAnyObject obj, StreamContext* remoteReferencer, unsigned int objId = 0);
+    /// Returns the object bound with that uid for remoteReferencer and sets objId, or returns null.
+    /// The object then needs one more call to removeObject to be removed.
+    BoundAnyObject addReference(const PtrUid& uid, StreamContext* remoteReferencer, unsigned int& objId);
+    /// Like addObject, and lets addReference find the object by its uid.
+    unsigned int addSharedObject(BoundAnyObject obj, const PtrUid& uid, StreamContext* remoteReferencer,
+                                 unsigned int objId);
     Future<void> removeObject(unsigned int id, Future<void> fut = Future<void>{nullptr});
     void removeRemoteReferences(MessageSocketPtr socket);
     unsigned int service() { return _service;}
@@ -48,10 +55,20 @@ namespace qi
     /// (ObjectHost) children knows it.
     BoundAnyObject recursiveFindObject(uint32_t objectId);
     using RemoteReferencesMap = std::map<StreamContext*, std::vector<unsigned int>>;
+    /// An object sent several times on a stream is bound once, and removed once the remote end
+    /// released all its references to it.
+    using SharedObjectKey = std::pair<StreamContext*, PtrUid>;
+    struct SharedObject
+    {
+      SharedObjectKey key;
+      unsigned int references;
+    };
     boost::recursive_mutex    _mutex;
     unsigned int    _service;
     ObjectMap       _objectMap;
     RemoteReferencesMap _remoteReferences;
+    std::map<SharedObjectKey, unsigned int> _sharedObjectIds;
+    std::map<unsigned int, SharedObject> _sharedObjects;
   };
 }
 
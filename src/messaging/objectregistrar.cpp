@@ -258,6 +258,15 @@ namespace qi {
     return AnyObject();
   }
 
+  CallAdmissionControlPtr ObjectRegistrar::callAdmission(const std::string &service)
+  {
+    const unsigned int serviceId = objectId(service);
+    auto bound = boost::dynamic_pointer_cast<ServiceBoundObject>(Server::boundObject(serviceId));
+    if (!serviceId || !bound)
+      throw std::runtime_error("Service " + service + " is not registered on this session");
+    return bound->callAdmission();
+  }
+
   void ObjectRegistrar::registerSocket(MessageSocketPtr socket)
   {
     onTransportServerNewConnection(socket, false);
@@ -13,6 +13,7 @@
 #include <qi/api.hpp>
 #include <qi/session.hpp>
 #include <qi/atomic.hpp>
+#include "calladmission.hpp"
 #include "server.hpp"
 
 namespace qi {
@@ -53,6 +54,8 @@ namespace qi {
     std::vector<qi::ServiceInfo>  registeredServices();
     qi::ServiceInfo               registeredService(const std::string &service);
     qi::AnyObject                 registeredServiceObject(const std::string &service);
+    // Throws if the service is not registered.
+    CallAdmissionControlPtr       callAdmission(const std::string &service);
 
     // Add an existing running socket to the list
     void registerSocket(MessageSocketPtr socket);
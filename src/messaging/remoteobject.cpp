@@ -10,11 +10,14 @@
 #endif
 
 #include "remoteobject_p.hpp"
+#include "callbatch_p.hpp"
 #include "message.hpp"
 #include "messagesocket.hpp"
+#include "traceprobes.hpp"
 #include <qi/log.hpp>
 #include <boost/thread/mutex.hpp>
 #include <qi/eventloop.hpp>
+#include <qi/deadline.hpp>
 
 qiLogCategory("qimessaging.remoteobject");
 
@@ -299,8 +302,17 @@ namespace qi {
       }
     }
 
+    // Fail fast rather than sending a call the server would drop.
+    const auto deadline = currentDeadline();
+    const auto timeLeft = deadline
+                        ? boost::chrono::duration_cast<MicroSeconds>(*deadline - SteadyClock::now())
+                        : MicroSeconds::max();
+    if (timeLeft <= MicroSeconds::zero())
+      return makeFutureError<AnyReference>(deadlineExpiredError);
+
     qi::Promise<AnyReference> out;
     qi::Message msg;
+    QI_TRACEPOINT(qi_qi, rpc_call, msg.id(), _service, _object, method, qi::Message::Type_Call);
     MessageSocketPtr sock;
     // qiLogDebug() << this << " metacall " << msg.service() << " " << msg.function() <<" " << msg.id();
     {
@@ -321,6 +333,8 @@ namespace qi {
       qiLogDebug() << "Adding promise id:" << msg.id();
       (*syncPromises)[msg.id()] = out;
     }
+    if (deadline && sock->sharedCapability<bool>("CallDeadline", false))
+      msg.setTimeLeft(timeLeft);
     qi::Signature funcSig = mm->parametersSignature();
     try {
       msg.setValues(in, funcSig, weakPtr(), sock.get());
@@ -344,32 +358,58 @@ namespace qi {
     msg.setObject(_object);
     msg.setFunction(method);
 
-    //error will come back as a error message
-    if (!sock->isConnected() || !sock->send(msg)) {
-      qi::MetaMethod*   meth = metaObject().method(method);
-      std::stringstream ss;
-      if (meth) {
-        ss << "Network error while sending data to method: '";
-        ss << meth->toString();
-        ss << "'.";
-      } else {
-        ss << "Network error while sending data an unknown method (id=" << method << ").";
-      }
-      if (!sock->isConnected()) {
-        ss << " Socket is not connected.";
-        qiLogVerbose() << ss.str();
-      } else {
-        qiLogError() << ss.str();
-      }
-      out.setError(ss.str());
-      qiLogDebug() << "Removing promise id:" << msg.id();
-      _promises->erase(msg.id());
+    const unsigned int id = msg.id();
+    detail::CallBatch* batch = detail::currentCallBatch();
+    // Only the asynchronous calls to the methods of services are deferred: the caller of a
+    // synchronous call waits for it, and so does the library for its own calls (events,
+    // properties, service directory).
+    if (batch && callType == MetaCallType_Queued && method >= qiObjectSpecialMemberMaxUid
+        && _service != Message::Service_ServiceDirectory)
+    {
+      if (batch->order() == ScopedCallBatch::CallOrder::Sequential
+          && sock->sharedCapability<bool>("SequentialCalls", false))
+        msg.addFlags(Message::TypeFlag_Sequential);
+      out.setOnCancel(qi::bind(&RemoteObject::onFutureCancelled, this, id));
+      // Sent when the batch is flushed.
+      batch->add(sock, std::move(msg), qi::track([=] { onSendError(out, method, id, sock); }, this));
+      return out.future();
     }
+    // The calls batched before this one are sent first.
+    if (batch)
+      batch->flush();
+
+    //error will come back as a error message
+    if (!sock->isConnected() || !sock->send(msg))
+      onSendError(out, method, id, sock);
     else
-      out.setOnCancel(qi::bind(&RemoteObject::onFutureCancelled, this, msg.id()));
+      out.setOnCancel(qi::bind(&RemoteObject::onFutureCancelled, this, id));
     return out.future();
   }
 
+  void RemoteObject::onSendError(qi::Promise<AnyReference> out, unsigned int method,
+                                 unsigned int id, const MessageSocketPtr& sock)
+  {
+    qi::MetaMethod*   meth = metaObject().method(method);
+    std::stringstream ss;
+    if (meth) {
+      ss << "Network error while sending data to method: '";
+      ss << meth->toString();
+      ss << "'.";
+    } else {
+      ss << "Network error while sending data an unknown method (id=" << method << ").";
+    }
+    if (!sock->isConnected()) {
+      ss << " Socket is not connected.";
+      qiLogVerbose() << ss.str();
+    } else {
+      qiLogError() << ss.str();
+    }
+    qiLogDebug() << "Removing promise id:" << id;
+    // The promise may have been set already, by close() for instance.
+    if (_promises->erase(id))
+      out.setError(ss.str());
+  }
+
   void RemoteObject::onFutureCancelled(unsigned int originalMessageId)
   {
     qiLogDebug() << "Cancel request for message " << originalMessageId;
@@ -77,6 +77,15 @@ namespace qi {
     return true;
   }
 
+  qi::BoundAnyObject Server::boundObject(unsigned int idx)
+  {
+    boost::mutex::scoped_lock sl(_boundObjectsMutex);
+    BoundAnyObjectMap::iterator it = _boundObjects.find(idx);
+    if (it == _boundObjects.end())
+      return BoundAnyObject();
+    return it->second;
+  }
+
   void Server::setAuthProviderFactory(AuthProviderFactoryPtr factory)
   {
     _authProviderFactory = factory;
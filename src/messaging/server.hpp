@@ -38,6 +38,8 @@ namespace qi {
     bool addObject(unsigned int idx, qi::AnyObject obj);
     bool addObject(unsigned int idx, qi::BoundAnyObject obj);
     bool removeObject(unsigned int idx);
+    // Null if there is no such object.
+    qi::BoundAnyObject boundObject(unsigned int idx);
 
     std::vector<qi::Url> endpoints() const;
 
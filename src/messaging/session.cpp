@@ -320,6 +320,16 @@ namespace qi {
     return _p->_serverObject.unregisterService(idx);
   }
 
+  void Session::setCallAdmissionPolicy(const std::string& serviceName, const CallAdmissionPolicy& policy)
+  {
+    _p->_serverObject.callAdmission(serviceName)->setPolicy(policy);
+  }
+
+  CallAdmissionStatistics Session::callAdmissionStatistics(const std::string& serviceName) const
+  {
+    return _p->_serverObject.callAdmission(serviceName)->statistics();
+  }
+
   std::vector<qi::Url> Session::endpoints() const
   {
     return _p->_serverObject.endpoints();
@@ -82,6 +82,36 @@ void StreamContext::receiveCacheSet(unsigned int uid, const MetaObject& mo)
   _receiveMetaObjectCache[uid] = mo;
 }
 
+AnyObject StreamContext::receivedObject(unsigned int serviceId, unsigned int objectId)
+{
+  boost::mutex::scoped_lock lock(_contextMutex);
+  const auto it = _receivedObjects.find(std::make_pair(serviceId, objectId));
+  if (it == _receivedObjects.end())
+    return AnyObject();
+  // Once locked, the proxy is not destroyed before the reference is counted.
+  AnyObject proxy = it->second.proxy.lock();
+  if (proxy)
+    ++*it->second.references;
+  return proxy;
+}
+
+void StreamContext::setReceivedObject(unsigned int serviceId, unsigned int objectId,
+                                      const AnyObject& proxy, ReceivedReferences references)
+{
+  boost::mutex::scoped_lock lock(_contextMutex);
+  _receivedObjects[std::make_pair(serviceId, objectId)] = ReceivedObject{proxy, std::move(references)};
+}
+
+void StreamContext::forgetReceivedObject(unsigned int serviceId, unsigned int objectId,
+                                         const ReceivedReferences& references)
+{
+  boost::mutex::scoped_lock lock(_contextMutex);
+  const auto it = _receivedObjects.find(std::make_pair(serviceId, objectId));
+  // The object may have been received again since, with a new proxy.
+  if (it != _receivedObjects.end() && it->second.references == references)
+    _receivedObjects.erase(it);
+}
+
 std::pair<unsigned int, bool> StreamContext::sendCacheSet(const MetaObject& mo)
 {
   boost::mutex::scoped_lock lock(_contextMutex);
@@ -116,6 +146,14 @@ static void initCapabilities()
   /* RemoteCancelableCalls: remote end supports call cancelations.
    */
   (*_defaultCapabilities)["RemoteCancelableCalls"] = AnyValue::from(true);
+  /* CallDeadline: remote end accepts calls carrying the time left before their
+   * deadline (Message::TypeFlag_Deadline), and drops them once it expired.
+   */
+  (*_defaultCapabilities)["CallDeadline"] = AnyValue::from(true);
+  /* SequentialCalls: remote end executes the calls flagged with
+   * Message::TypeFlag_Sequential in the order they were received.
+   */
+  (*_defaultCapabilities)["SequentialCalls"] = AnyValue::from(true);
   // Process override from environment
   std::string capstring = qi::os::getenv("QI_TRANSPORT_CAPABILITIES");
   std::vector<std::string> caps;
@@ -8,7 +8,9 @@
 #define _QI_MESSAGING_STREAMCONTEXT_HPP_
 
 #include <qi/api.hpp>
+#include <qi/anyobject.hpp>
 #include <qi/anyvalue.hpp>
+#include <qi/atomic.hpp>
 #include <qi/type/metaobject.hpp>
 #include <map>
 
@@ -24,6 +26,8 @@ using CapabilityMap = std::map<std::string, AnyValue>;
  *   perform the actual sending of local capabilities to the remote endpoint.
  * - A MetaObject cache so that any given MetaObject is sent in full only once
  *   for each transport stream.
+ * - The proxies of the objects received, so that an object received several
+ *   times has a single proxy.
  */
 class QI_API StreamContext
 {
@@ -75,6 +79,20 @@ public:
 
   MetaObject receiveCacheGet(unsigned int uid) const;
 
+  /// Number of times a proxy was received, each of which the remote end expects to be released.
+  using ReceivedReferences = boost::shared_ptr<qi::Atomic<unsigned int>>;
+
+  /// Return the proxy of a remote object if it is still alive, counting one more reference to it.
+  AnyObject receivedObject(unsigned int serviceId, unsigned int objectId);
+
+  /// Record a new proxy of a remote object, references being its count.
+  void setReceivedObject(unsigned int serviceId, unsigned int objectId,
+                         const AnyObject& proxy, ReceivedReferences references);
+
+  /// Forget the proxy of a remote object counted by references, once it is destroyed.
+  void forgetReceivedObject(unsigned int serviceId, unsigned int objectId,
+                            const ReceivedReferences& references);
+
   /// Default capabilities injected on all transports upon connection
   static const CapabilityMap& defaultCapabilities();
 
@@ -91,6 +109,14 @@ protected:
   using ReceiveMetaObjectCache = std::map<unsigned int, MetaObject>;
   SendMetaObjectCache _sendMetaObjectCache;
   ReceiveMetaObjectCache _receiveMetaObjectCache;
+
+  struct ReceivedObject
+  {
+    AnyWeakObject proxy;
+    ReceivedReferences references;
+  };
+  using ReceivedObjectMap = std::map<std::pair<unsigned int, unsigned int>, ReceivedObject>;
+  ReceivedObjectMap _receivedObjects;
 };
 
 template<typename T>
@@ -1,11 +1,18 @@
 #include <string>
+#include <list>
+#include <map>
+#include <sstream>
+#include <vector>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/thread/mutex.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/optional.hpp>
 #include <qi/os.hpp>
 #include <qi/log.hpp>
 #include <qi/messaging/sock/networkasio.hpp>
 #include <qi/messaging/sock/option.hpp>
+#include "message.hpp"
+#include "traceprobes.hpp"
 
 #if BOOST_OS_WINDOWS
 # include <Winsock2.h> // needed by mstcpip.h
@@ -123,6 +130,21 @@ namespace qi {
     else                 return {};
   }
 
+  void traceMessageEnqueued(const Message& msg)
+  {
+    QI_TRACE_MESSAGE(message_enqueue, msg);
+  }
+
+  void traceMessageSent(const Message& msg)
+  {
+    QI_TRACE_MESSAGE(message_sent, msg);
+  }
+
+  void traceMessageReceived(const Message& msg)
+  {
+    QI_TRACE_MESSAGE(message_received, msg);
+  }
+
   size_t getMaxPayloadFromEnv(size_t defaultValue)
   {
     std::string l = os::getenv("QI_MAX_MESSAGE_PAYLOAD");
@@ -143,6 +165,140 @@ namespace qi { namespace sock {
     return warnThreshold;
   }
 
+  namespace
+  {
+    /// Client-side TLS sessions, by remote endpoint.
+    /// When the cache is full, the least recently used session is evicted.
+    ///
+    /// The sessions are kept serialized: OpenSSL marks a session as not resumable when a
+    /// connection using it is closed without a TLS shutdown, which is how sockets are
+    /// usually closed, so the SSL objects must not share the cached sessions.
+    class SslSessionCache
+    {
+    public:
+      // Avoids growing without bound when connecting to many peers.
+      static const std::size_t maxSize = 256;
+
+      /// Returns a new session, that the caller must free, or null if none.
+      SSL_SESSION* get(const std::string& endpoint)
+      {
+        boost::mutex::scoped_lock lock(_mutex);
+        auto it = _index.find(endpoint);
+        if (it == _index.end())
+          return nullptr;
+        touch(it->second);
+        const SessionData& data = it->second->second;
+        const unsigned char* begin = data.data();
+        return d2i_SSL_SESSION(nullptr, &begin, static_cast<long>(data.size()));
+      }
+
+      /// Does not take ownership of the session.
+      void set(const std::string& endpoint, SSL_SESSION* session)
+      {
+        const int size = i2d_SSL_SESSION(session, nullptr);
+        if (size <= 0)
+          return;
+        SessionData data(static_cast<std::size_t>(size));
+        unsigned char* begin = data.data();
+        i2d_SSL_SESSION(session, &begin);
+
+        boost::mutex::scoped_lock lock(_mutex);
+        auto it = _index.find(endpoint);
+        if (it != _index.end())
+        {
+          it->second->second.swap(data);
+          touch(it->second);
+          return;
+        }
+        if (_sessions.size() >= maxSize)
+        {
+          _index.erase(_sessions.back().first);
+          _sessions.pop_back();
+        }
+        _sessions.emplace_front(endpoint, std::move(data));
+        _index.emplace(endpoint, _sessions.begin());
+      }
+
+    private:
+      using SessionData = std::vector<unsigned char>;
+      // Most recently used first.
+      using Sessions = std::list<std::pair<std::string, SessionData>>;
+
+      void touch(Sessions::iterator it)
+      {
+        _sessions.splice(_sessions.begin(), _sessions, it);
+      }
+
+      boost::mutex _mutex;
+      Sessions _sessions;
+      std::map<std::string, Sessions::iterator> _index;
+    };
+
+    SslSessionCache& sslSessionCache()
+    {
+      static SslSessionCache cache;
+      return cache;
+    }
+
+    boost::optional<std::string> remoteEndpointKey(NetworkAsio::ssl_socket_type& s)
+    {
+      boost::system::error_code erc;
+      const auto endpoint = s.lowest_layer().remote_endpoint(erc);
+      if (erc)
+        return {};
+      std::ostringstream oss;
+      oss << endpoint;
+      return oss.str();
+    }
+
+    void freeEndpointKey(void*, void* key, CRYPTO_EX_DATA*, int, long, void*)
+    {
+      delete static_cast<std::string*>(key);
+    }
+
+    // The remote endpoint key of a client SSL object is attached to it, for onNewSession.
+    int endpointKeyIndex()
+    {
+      static const int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, &freeEndpointKey);
+      return index;
+    }
+
+    // Called by OpenSSL each time a client session is established. With TLS 1.3, the
+    // resumable sessions are only received after the handshake, possibly several times.
+    int onNewSession(SSL* ssl, SSL_SESSION* session)
+    {
+      const auto key = static_cast<const std::string*>(SSL_get_ex_data(ssl, endpointKeyIndex()));
+      if (key)
+        sslSessionCache().set(*key, session);
+      return 0; // The SSL object keeps the session.
+    }
+  } // anonymous
+
+  void NetworkAsio::sslEnableSessionResumption(ssl_context_type& c)
+  {
+    SSL_CTX* context = c.native_handle();
+    SSL_CTX_set_session_cache_mode(context, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(context, &onNewSession);
+  }
+
+  void NetworkAsio::sslResumeSession(ssl_socket_type& s)
+  {
+    const auto key = remoteEndpointKey(s);
+    if (!key)
+      return;
+    SSL* ssl = s.native_handle();
+    delete static_cast<std::string*>(SSL_get_ex_data(ssl, endpointKeyIndex()));
+    SSL_set_ex_data(ssl, endpointKeyIndex(), new std::string(*key));
+
+    if (SSL_SESSION* session = sslSessionCache().get(*key))
+    {
+      // The SSL object takes its own reference on the session.
+      if (SSL_set_session(ssl, session) != 1)
+        qiLogDebug() << "Failed to reuse the TLS session with " << *key;
+      SSL_SESSION_free(session);
+    }
+  }
+
   void NetworkAsio::setSocketNativeOptions(
     boost::asio::ip::tcp::socket::native_handle_type socketNativeHandle, int timeoutInSeconds)
   {
@@ -3,6 +3,7 @@
 #ifndef _SRC_TCPMESSAGESOCKET_HPP_
 #define _SRC_TCPMESSAGESOCKET_HPP_
 
+#include <atomic>
 #include <string>
 #include <functional>
 #include <memory>
@@ -16,6 +17,7 @@
 #include <qi/url.hpp>
 #include <qi/type/traits.hpp>
 #include <qi/macroregular.hpp>
+#include "messagecapture.hpp"
 #include "messagedispatcher.hpp"
 #include "messagesocket.hpp"
 #include <qi/messaging/sock/disconnectedstate.hpp>
@@ -34,6 +36,12 @@ namespace qi {
 
   boost::optional<Seconds> getTcpPingTimeout(Seconds defaultTimeout);
 
+  // Tracepoints of the messages of the sockets, defined in tcpmessagesocket.cpp: the
+  // socket templates must compile the same way in every file, with or without probes.
+  void traceMessageEnqueued(const Message& msg);
+  void traceMessageSent(const Message& msg);
+  void traceMessageReceived(const Message& msg);
+
   template<typename N, typename S>
   class TcpMessageSocket;
 
@@ -216,6 +224,10 @@ namespace qi {
     /// One failure case (return `false`) is when the socket is not connected.
     bool send(const Message &msg) override;
 
+    /// All the messages are enqueued at once, or none if the socket is not connected.
+    /// Messages enqueued together are written to the socket with a single write.
+    std::size_t sendAll(std::vector<Message> msgs) override;
+
     Status status() const override
     {
       boost::recursive_mutex::scoped_lock lock(_stateMutex);
@@ -239,6 +251,12 @@ namespace qi {
       return {};
     }
     bool ensureReading() override;
+
+    /// Server side: the returned future is set when the socket is ready to be
+    /// read, that is when the SSL handshake done at construction is over. It is
+    /// in error if the handshake failed.
+    /// ensureReading() does not block once this future is set.
+    Future<void> handshakeComplete();
   private:
     /// Handler called when we transition outside the connected state.
     /// It is the responsibility of the caller to ensure the socket pointer is
@@ -281,6 +299,9 @@ namespace qi {
     using State = boost::variant<DisconnectedState, ConnectingState, ConnectedState, DisconnectingState>;
     State _state;
     boost::synchronized_value<Url> _url;
+    // Identifies the current connection in the message capture. Set before entering the
+    // connected state.
+    std::atomic<qi::uint32_t> _captureConnection;
 
     bool mustTreatAsServerAuthentication(const Message& msg) const;
     bool handleCapabilityMessage(const Message& msg);
@@ -325,6 +346,7 @@ namespace qi {
     , _ssl(ssl)
     , _ioService(io)
     , _state{DisconnectedState{}}
+    , _captureConnection{0}
   {
     if (socket)
     {
@@ -378,6 +400,7 @@ namespace qi {
         return false;
       }
       auto self = shared_from_this();
+      _captureConnection = MessageCapture::newConnection();
       _state = ConnectedState(res.socket, _ssl, maxPayload, sock::HandleMessage<N, S>{self});
       auto& connected = asConnected(_state);
       connected.complete().then(connected.ioServiceStranded(
@@ -388,6 +411,20 @@ namespace qi {
     return true;
   }
 
+  template<typename N, typename S>
+  Future<void> TcpMessageSocket<N, S>::handshakeComplete()
+  {
+    boost::recursive_mutex::scoped_lock lock(_stateMutex);
+    if (getStatus() != Status::Connecting)
+      return makeFutureError<void>("handshakeComplete: socket must be in connecting state.");
+    return asConnecting(_state).complete().then(
+          [](Future<sock::SyncConnectingResultPtr<N, S>> fut) {
+      const auto res = fut.value()->get(); // copy the result
+      if (hasError(res))
+        throw std::runtime_error("Handshake error: " + res.errorMessage);
+    });
+  }
+
   /// Connect the socket to start receiving and sending messages.
   ///
   /// The operation completes when the returned future is set.
@@ -410,8 +447,9 @@ namespace qi {
     _state =
         ConnectingState{ _ioService, url, _ssl,
                          [&] {
-                           return sock::makeSocketWithContextPtr<N>(
-                                 _ioService, sock::makeSslContextPtr<N>(Method::sslv23));
+                           auto context = sock::makeSslContextPtr<N>(Method::sslv23);
+                           N::sslEnableSessionResumption(*context);
+                           return sock::makeSocketWithContextPtr<N>(_ioService, context);
                          },
                          !disableIpV6, Side::client,
                          getTcpPingTimeout(Seconds{ sock::defaultTimeoutInSeconds }) };
@@ -441,6 +479,7 @@ namespace qi {
         // Connecting was successful, so we enter the connected state (to be able
         // send and receive messages).
         static const auto maxPayload = getMaxPayloadFromEnv();
+        _captureConnection = MessageCapture::newConnection();
         _state = ConnectedState(res.socket, _ssl, maxPayload, sock::HandleMessage<N, S>{self});
         auto& connected = asConnected(_state);
         connected.complete().then(connected.ioServiceStranded(
@@ -566,6 +605,9 @@ namespace qi {
   template<typename N, typename S>
   bool TcpMessageSocket<N, S>::handleMessage(const Message& msg)
   {
+    traceMessageReceived(msg);
+    if (auto capture = MessageCapture::instance())
+      capture->record(MessageCapture::Direction::Received, _captureConnection, msg);
     bool success = false;
     if (mustTreatAsServerAuthentication(msg) || msg.type() == Message::Type_Capability)
     {
@@ -594,16 +636,50 @@ namespace qi {
       QI_LOG_DEBUG_SOCKET(this) << "Socket must be connected to send().";
       return false;
     }
-    asConnected(_state).send(msg, _ssl);
+    traceMessageEnqueued(msg);
+    if (auto capture = MessageCapture::instance())
+      capture->record(MessageCapture::Direction::Sent, _captureConnection, msg);
+    asConnected(_state).send(msg, _ssl,
+      [](const sock::ErrorCode<N>& erc, std::list<Message>::const_iterator itMsg) {
+        if (!erc)
+          traceMessageSent(*itMsg);
+        return true;
+      });
     return true;
   }
 
+  template<typename N, typename S>
+  std::size_t TcpMessageSocket<N, S>::sendAll(std::vector<Message> msgs)
+  {
+    boost::recursive_mutex::scoped_lock lock(_stateMutex);
+    if (getStatus() != Status::Connected)
+    {
+      QI_LOG_DEBUG_SOCKET(this) << "Socket must be connected to sendAll().";
+      return 0;
+    }
+    const auto capture = MessageCapture::instance();
+    for (const auto& msg : msgs)
+    {
+      traceMessageEnqueued(msg);
+      if (capture)
+        capture->record(MessageCapture::Direction::Sent, _captureConnection, msg);
+    }
+    const std::size_t count = msgs.size();
+    asConnected(_state).sendAll(std::move(msgs), _ssl,
+      [](const sock::ErrorCode<N>& erc, std::list<Message>::const_iterator itMsg) {
+        if (!erc)
+          traceMessageSent(*itMsg);
+        return true;
+      });
+    return count;
+  }
+
   /// Network N,
   /// With NetSslSocket S:
   ///   S is compatible with N
   template <typename N = sock::NetworkAsio, typename S = sock::SocketWithContext<N>>
   TcpMessageSocketPtr<N, S> makeTcpMessageSocket(const std::string& protocol,
-                                                 EventLoop* eventLoop = getNetworkEventLoop())
+                                                 EventLoop* eventLoop = getNextNetworkEventLoop())
   {
     using Socket = TcpMessageSocket<N, S>;
     if (protocol == "tcp")
@@ -0,0 +1,21 @@
+#pragma once
+
+#ifndef _SRC_MESSAGING_TRACEPROBES_HPP_
+#define _SRC_MESSAGING_TRACEPROBES_HPP_
+
+// Tracepoints of the lifecycle of the messages, defined in src/tp_qi.in.h.
+// Only include this header from source files, listed in qiprobes_instrument_files:
+// the tracepoints compile to nothing when WITH_PROBES is not set, so code shared
+// between files, such as templates and inline functions, must not use them.
+#ifdef WITH_PROBES
+# include "tp_qi.h"
+# define QI_TRACEPOINT(...) tracepoint(__VA_ARGS__)
+#else
+# define QI_TRACEPOINT(...) static_cast<void>(0)
+#endif
+
+#define QI_TRACE_MESSAGE(event, msg)                                       \
+  QI_TRACEPOINT(qi_qi, event, (msg).id(), (msg).service(), (msg).object(), \
+                (msg).function(), (msg).type())
+
+#endif  // _SRC_MESSAGING_TRACEPROBES_HPP_
@@ -13,6 +13,7 @@
 #include <cstring>
 #include <cstdlib>
 #include <queue>
+#include <algorithm>
 #include <qi/log.hpp>
 #include <qi/os.hpp>
 #include <cerrno>
@@ -97,6 +98,23 @@ namespace qi
     return r;
   }
 
+  TransportServer::AcceptStatistics TransportServer::acceptStatistics() const
+  {
+    AcceptStatistics total;
+    boost::mutex::scoped_lock l(_implMutex);
+    for (const auto& impl : _impl)
+    {
+      const AcceptStatistics stats = impl->acceptStatistics();
+      total.accepted += stats.accepted;
+      total.acceptErrors += stats.acceptErrors;
+      total.handshakeFailures += stats.handshakeFailures;
+      total.pendingHandshakes += stats.pendingHandshakes;
+      total.totalHandshakeTime += stats.totalHandshakeTime;
+      total.maxHandshakeTime = std::max(total.maxHandshakeTime, stats.maxHandshakeTime);
+    }
+    return total;
+  }
+
   void TransportServer::close() {
     boost::mutex::scoped_lock l(_implMutex);
     for (std::vector<TransportServerImplPtr>::const_iterator it = _impl.begin();
@@ -7,8 +7,10 @@
 #ifndef _SRC_TRANSPORTSERVER_HPP_
 #define _SRC_TRANSPORTSERVER_HPP_
 
+#include <cstdint>
 #include <utility>
 # include <boost/noncopyable.hpp>
+# include <qi/clock.hpp>
 # include <qi/url.hpp>
 # include <qi/eventloop.hpp>
 # include <qi/signal.hpp>
@@ -32,6 +34,17 @@ namespace qi {
     virtual qi::Future<void> listen(const qi::Url& listenUrl) = 0;
     virtual void close() = 0;
 
+    struct AcceptStatistics
+    {
+      std::uint64_t accepted = 0;
+      std::uint64_t acceptErrors = 0;
+      std::uint64_t handshakeFailures = 0;
+      std::size_t   pendingHandshakes = 0;
+      qi::NanoSeconds totalHandshakeTime{0};
+      qi::NanoSeconds maxHandshakeTime{0};
+    };
+    virtual AcceptStatistics acceptStatistics() const { return {}; }
+
   public:
     TransportServer                        *self;
     boost::mutex                            mutexCallback;
@@ -70,6 +83,12 @@ namespace qi {
 
     std::vector<qi::Url> endpoints() const;
 
+    using AcceptStatistics = TransportServerImpl::AcceptStatistics;
+    /// Counters of accepted connections and of their handshakes, summed over
+    /// all the endpoints. Sample them over time to get the accept rate and the
+    /// mean handshake latency.
+    AcceptStatistics acceptStatistics() const;
+
   public:
     /** Emitted each time a new connection happens. startReading must be
      * called on the socket
@@ -6,6 +6,7 @@
 #include <cstring>
 #include <cstdlib>
 #include <queue>
+#include <algorithm>
 #include <qi/log.hpp>
 #include <cerrno>
 
@@ -20,6 +21,7 @@
 #include <qi/messaging/sock/sslcontextptr.hpp>
 
 #include <qi/eventloop.hpp>
+#include <qi/getenv.hpp>
 
 #include "transportserverasio_p.hpp"
 
@@ -55,48 +57,190 @@ namespace qi
       qiLogWarning() << this << " No context available, acceptor will stay down.";
   }
 
+  namespace
+  {
+    int listenBacklog()
+    {
+      static const int backlog = qi::os::getEnvDefault("QI_TRANSPORTSERVER_LISTEN_BACKLOG",
+          static_cast<int>(boost::asio::socket_base::max_connections));
+      return backlog;
+    }
+
+    // Several accepts are kept outstanding so that a burst of incoming
+    // connections is not serialized on a single completion handler.
+    unsigned int acceptCount()
+    {
+      static const unsigned int count =
+          std::max(qi::os::getEnvDefault("QI_TRANSPORTSERVER_ACCEPT_COUNT", 4u), 1u);
+      return count;
+    }
+
+    // Beyond this many SSL handshakes in progress, accepting stops and the
+    // incoming connections wait in the listen backlog.
+    // Read for each server, as are the following settings.
+    std::size_t maxPendingHandshakes()
+    {
+      return std::max(qi::os::getEnvDefault("QI_TRANSPORTSERVER_MAX_PENDING_HANDSHAKES", 64u), 1u);
+    }
+
+    // A client that does not complete its SSL handshake in time is disconnected, so that
+    // stalled clients cannot hold all the pending handshakes and lock accepting out.
+    qi::Seconds handshakeTimeout()
+    {
+      return qi::Seconds{
+          std::max(qi::os::getEnvDefault("QI_TRANSPORTSERVER_HANDSHAKE_TIMEOUT", 10u), 1u)};
+    }
+  }
+
   void TransportServerAsioPrivate::onAccept(const boost::system::error_code& erc,
     sock::SocketWithContextPtr<sock::NetworkAsio> s
     )
   {
     qiLogDebug() << this << " onAccept";
-    boost::mutex::scoped_lock lock(_acceptCloseMutex);
-    if (!_live)
-    {
-      s.reset();
-      return;
-    }
-    if (erc)
+    boost::shared_ptr<TcpMessageSocket<>> handshakingSocket;
     {
-      qiLogDebug() << "accept error " << erc.message();
-      s.reset();
-      self->acceptError(erc.value());
-      if (isFatalAcceptError(erc.value()))
+      boost::mutex::scoped_lock lock(_acceptCloseMutex);
+      if (!_live)
       {
-        delete _acceptor;
-        _acceptor = 0;
-        qiLogError() << "fatal accept error: " << erc.value();
-        qiLogDebug() << this << " Disabling acceptor for now, retrying in " << AcceptDownRetryTimerUs << "us";
-        context->asyncDelay(boost::bind(&TransportServerAsioPrivate::restartAcceptor, this),
-            qi::MicroSeconds(AcceptDownRetryTimerUs));
+        s.reset();
         return;
       }
-    }
-    else
-    {
-        auto socket = boost::make_shared<qi::TcpMessageSocket<>>(*asIoServicePtr(context), _ssl, s);
+      if (!_acceptor)
+      {
+        // The acceptor was disabled after a fatal error, the other pending
+        // accepts complete with an error.
+        return;
+      }
+      if (erc)
+      {
+        qiLogDebug() << "accept error " << erc.message();
+        ++_acceptStats.acceptErrors;
+        s.reset();
+        self->acceptError(erc.value());
+        if (isFatalAcceptError(erc.value()))
+        {
+          delete _acceptor;
+          _acceptor = 0;
+          qiLogError() << "fatal accept error: " << erc.value();
+          qiLogDebug() << this << " Disabling acceptor for now, retrying in " << AcceptDownRetryTimerUs << "us";
+          context->asyncDelay(boost::bind(&TransportServerAsioPrivate::restartAcceptor, this),
+              qi::MicroSeconds(AcceptDownRetryTimerUs));
+          return;
+        }
+      }
+      else
+      {
+        ++_acceptStats.accepted;
+        // The socket is bound to the io_service it was accepted on, see acceptIoService().
+        auto socket = boost::make_shared<qi::TcpMessageSocket<>>(s->get_io_service(), _ssl, s);
         qiLogDebug() << "New socket accepted: " << socket.get();
 
-        self->newConnection(std::pair<MessageSocketPtr, Url>{
-          socket, sock::remoteEndpoint(*s, _ssl)});
+        // The SSL handshake runs asynchronously on the socket's io_service. The
+        // connection is only given away once it is over, so that neither this
+        // handler nor the newConnection handlers wait for it.
+        if (_ssl)
+        {
+          ++_acceptStats.pendingHandshakes;
+          handshakingSocket = socket;
+        }
+        else
+          emitNewConnection(socket, s);
+      }
 
-        if (socket.unique()) {
-            qiLogError() << "bug: socket not stored by the newConnection handler (usecount:" << socket.use_count() << ")";
+      if (_acceptStats.pendingHandshakes >= _maxPendingHandshakes)
+      {
+        qiLogVerbose() << this << " " << _acceptStats.pendingHandshakes
+                       << " handshakes pending, suspending an accept";
+        ++_suspendedAccepts;
+      }
+      else
+        startAccept();
+    }
+
+    // Out of the lock: the handshake may already be over, calling us back immediately.
+    if (handshakingSocket)
+    {
+      const auto acceptTime = SteadyClock::now();
+      Future<void> handshake = handshakingSocket->handshakeComplete();
+      boost::weak_ptr<TcpMessageSocket<>> weakSocket = handshakingSocket;
+      // Disconnecting fails the handshake, which frees its slot in onHandshakeComplete.
+      Future<void> timeout = context->asyncDelay([weakSocket, handshake]() {
+        if (handshake.isFinished())
+          return;
+        if (auto socket = weakSocket.lock())
+        {
+          qiLogVerbose() << "Handshake of " << socket.get() << " timed out, disconnecting";
+          socket->disconnect().async();
         }
+      }, _handshakeTimeout);
+      handshake.then(
+          boost::bind(&TransportServerAsioPrivate::onHandshakeComplete, shared_from_this(),
+                      _1, handshakingSocket, s, acceptTime, timeout));
     }
-    _s = sock::makeSocketWithContextPtr<sock::NetworkAsio>(_acceptor->get_io_service(), _sslContext);
-    _acceptor->async_accept(_s->lowest_layer(),
-                           boost::bind(_onAccept, shared_from_this(), _1, _s));
+  }
+
+  void TransportServerAsioPrivate::onHandshakeComplete(Future<void> handshake,
+                                                       MessageSocketPtr socket,
+                                                       sock::SocketWithContextPtr<sock::NetworkAsio> s,
+                                                       SteadyClock::time_point acceptTime,
+                                                       Future<void> timeout)
+  {
+    timeout.cancel();
+    const auto elapsed = boost::chrono::duration_cast<NanoSeconds>(SteadyClock::now() - acceptTime);
+    boost::mutex::scoped_lock lock(_acceptCloseMutex);
+    --_acceptStats.pendingHandshakes;
+    _acceptStats.totalHandshakeTime += elapsed;
+    _acceptStats.maxHandshakeTime = std::max(_acceptStats.maxHandshakeTime, elapsed);
+    if (!_live)
+      return;
+    if (_suspendedAccepts && _acceptor)
+    {
+      --_suspendedAccepts;
+      startAccept();
+    }
+    if (handshake.hasError())
+    {
+      ++_acceptStats.handshakeFailures;
+      qiLogVerbose() << this << " dropping connection: " << handshake.error();
+      return;
+    }
+    qiLogDebug() << "Handshake of " << socket.get() << " done in "
+                 << boost::chrono::duration_cast<MilliSeconds>(elapsed).count() << "ms";
+    emitNewConnection(socket, s);
+  }
+
+  void TransportServerAsioPrivate::emitNewConnection(MessageSocketPtr socket,
+                                                     sock::SocketWithContextPtr<sock::NetworkAsio> s)
+  {
+    self->newConnection(std::pair<MessageSocketPtr, Url>{
+      socket, sock::remoteEndpoint(*s, _ssl)});
+
+    if (socket.unique()) {
+        qiLogError() << "bug: socket not stored by the newConnection handler (usecount:" << socket.use_count() << ")";
+    }
+  }
+
+  void TransportServerAsioPrivate::startAccept()
+  {
+    auto s = sock::makeSocketWithContextPtr<sock::NetworkAsio>(acceptIoService(), _sslContext);
+    _acceptor->async_accept(s->lowest_layer(),
+                           boost::bind(_onAccept, shared_from_this(), _1, s));
+  }
+
+  TransportServerImpl::AcceptStatistics TransportServerAsioPrivate::acceptStatistics() const
+  {
+    boost::mutex::scoped_lock lock(_acceptCloseMutex);
+    return _acceptStats;
+  }
+
+  boost::asio::io_service& TransportServerAsioPrivate::acceptIoService()
+  {
+    // When the server runs on the network event loop, accepted sockets are spread
+    // over all the network event loops so that a single thread does not handle all
+    // the connections. Otherwise, we stay on the event loop we were given.
+    if (context == getNetworkEventLoop())
+      return *asIoServicePtr(getNextNetworkEventLoop());
+    return _acceptor->get_io_service();
   }
 
   void TransportServerAsioPrivate::close() {
@@ -246,7 +390,7 @@ namespace qi
     }
 
     boost::system::error_code ec;
-    _acceptor->listen(socket_base::max_connections, ec);
+    _acceptor->listen(listenBacklog(), ec);
     if (ec)
     {
       qiLogError("qimessaging.server.listen") << ec.message();
@@ -297,9 +441,12 @@ namespace qi
       _sslContext->use_private_key_file(self->_identityKey.c_str(), boost::asio::ssl::context::pem);
     }
 
-    _s = sock::makeSocketWithContextPtr<sock::NetworkAsio>(_acceptor->get_io_service(), _sslContext);
-    _acceptor->async_accept(_s->lowest_layer(),
-      boost::bind(_onAccept, shared_from_this(), _1, _s));
+    {
+      boost::mutex::scoped_lock lock(_acceptCloseMutex);
+      _suspendedAccepts = 0;
+      for (unsigned int i = 0; i < acceptCount(); ++i)
+        startAccept();
+    }
     _connectionPromise.setValue(0);
     return _connectionPromise.future();
   }
@@ -333,9 +480,11 @@ namespace qi
     , _live(true)
     , _sslContext(sock::makeSslContextPtr<sock::NetworkAsio>(*asIoServicePtr(ctx),
                                                              sock::SslContext<sock::NetworkAsio>::sslv23))
-    , _s()
     , _ssl(false)
     , _port(0)
+    , _suspendedAccepts(0)
+    , _maxPendingHandshakes(maxPendingHandshakes())
+    , _handshakeTimeout(handshakeTimeout())
   {
   }
 
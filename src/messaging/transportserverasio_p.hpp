@@ -36,6 +36,7 @@ namespace qi
 
     virtual qi::Future<void> listen(const qi::Url& listenUrl);
     virtual void close();
+    AcceptStatistics acceptStatistics() const override;
     void updateEndpoints();
     static bool isFatalAcceptError(int errorCode);
     TransportServer* _self;
@@ -45,7 +46,6 @@ namespace qi
     TransportServerAsioPrivate();
     std::atomic<bool> _live;
     sock::SslContextPtr<sock::NetworkAsio> _sslContext;
-    sock::SocketWithContextPtr<sock::NetworkAsio> _s;
     bool _ssl;
     unsigned short _port;
     boost::synchronized_value<qi::Future<void>> _asyncEndpoints;
@@ -55,12 +55,31 @@ namespace qi
     // Typically, the TransportServer this class has a pointer to closes implementations
     // in its destructor. Without protection, this class can end up using a
     // dangling pointer on the TransportServer.
-    boost::mutex _acceptCloseMutex;
+    mutable boost::mutex _acceptCloseMutex;
 
     static const int64_t AcceptDownRetryTimerUs;
 
   private:
     void restartAcceptor();
+    boost::asio::io_service& acceptIoService();
+
+    // _acceptCloseMutex must be locked when calling these.
+    void startAccept();
+    void emitNewConnection(MessageSocketPtr socket,
+                           sock::SocketWithContextPtr<sock::NetworkAsio> s);
+
+    void onHandshakeComplete(Future<void> handshake,
+                             MessageSocketPtr socket,
+                             sock::SocketWithContextPtr<sock::NetworkAsio> s,
+                             SteadyClock::time_point acceptTime,
+                             Future<void> timeout);
+
+    // Accepts that were not restarted because too many handshakes are pending.
+    // They are restarted as handshakes complete.
+    unsigned int _suspendedAccepts;
+    AcceptStatistics _acceptStats;
+    const std::size_t _maxPendingHandshakes;
+    const qi::Seconds _handshakeTimeout;
   };
 }
 
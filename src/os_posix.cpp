@@ -36,6 +36,7 @@
 #if defined (__linux__)
 # include <sys/prctl.h>
 # include <sys/resource.h>
+# include <sys/syscall.h>
 #endif
 
 #if defined (__MACH__)
@@ -412,6 +413,28 @@ namespace qi {
       return false;
     }
 
+    bool setCurrentThreadPriority(int priority, bool realTime) {
+      if (realTime)
+      {
+        sched_param param;
+        param.sched_priority = priority;
+        const int ret = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (ret)
+          qiLogVerbose() << "Cannot set the real-time priority of the thread: " << strerror(ret);
+        return !ret;
+      }
+     #if defined (__linux__)
+      // On Linux, the nice value is an attribute of the thread, not of the process.
+      if (setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), priority))
+      {
+        qiLogVerbose() << "Cannot set the nice value of the thread: " << strerror(errno);
+        return false;
+      }
+      return true;
+     #endif
+      return false;
+    }
+
     static std::string readLink(const std::string &link)
     {
       boost::filesystem::path p(link, qi::unicodeFacet());
@@ -493,6 +493,27 @@ namespace qi {
       return true;
     }
 
+    bool setCurrentThreadPriority(int priority, bool realTime) {
+      int level = THREAD_PRIORITY_NORMAL;
+      if (realTime)
+        level = THREAD_PRIORITY_TIME_CRITICAL;
+      else if (priority <= -10)
+        level = THREAD_PRIORITY_HIGHEST;
+      else if (priority < 0)
+        level = THREAD_PRIORITY_ABOVE_NORMAL;
+      else if (priority >= 10)
+        level = THREAD_PRIORITY_LOWEST;
+      else if (priority > 0)
+        level = THREAD_PRIORITY_BELOW_NORMAL;
+
+      if (!SetThreadPriority(GetCurrentThread(), level))
+      {
+        qiLogError() << GetLastErrorMessage(GetLastError());
+        return false;
+      }
+      return true;
+    }
+
     std::string timezone()
     {
       TIME_ZONE_INFORMATION tzInfo;
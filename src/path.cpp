@@ -321,6 +321,11 @@ namespace qi
         return getInstance()->clearOptionalSdkPrefix();
       }
 
+      void invalidateCache()
+      {
+        getInstance()->invalidateCache();
+      }
+
 
       std::vector<std::string> getSdkPrefixes()
       {
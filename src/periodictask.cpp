@@ -46,7 +46,7 @@ namespace qi
   struct PeriodicTaskPrivate: Trackable<PeriodicTaskPrivate>
   {
     using ScheduleCallback =
-        boost::function<qi::Future<void>(const PeriodicTask::Callback&, qi::Duration)>;
+        boost::function<qi::Future<void>(const PeriodicTask::Callback&, qi::SteadyClockTimePoint)>;
 
     MethodStatistics        _callStats;
     qi::SteadyClockTimePoint _statsDisplayTime;
@@ -57,6 +57,9 @@ namespace qi
     qi::Future<void>        _task;
     std::string             _name;
     bool                    _compensateCallTime;
+    PeriodicTask::Scheduling _scheduling;
+    qi::SteadyClockTimePoint _deadline; //< of the scheduled call
+    PeriodicTask::Statistics _stats;
     int                     _tid;
     using Mutex = boost::recursive_mutex;
     using ScopedLock = Mutex::scoped_lock;
@@ -77,7 +80,12 @@ namespace qi
 
     ~PeriodicTaskPrivate();
 
-    void _reschedule(qi::Duration delay = qi::Duration(0));
+    void _reschedule(qi::SteadyClockTimePoint deadline);
+    qi::SteadyClockTimePoint _nextDeadline(qi::SteadyClockTimePoint deadline,
+                                           qi::SteadyClockTimePoint start,
+                                           qi::SteadyClockTimePoint end,
+                                           bool compensate,
+                                           PeriodicTask::Scheduling scheduling);
     void _wrap();
     void _onTaskFinished(const qi::Future<void>& fut);
 
@@ -93,6 +101,7 @@ namespace qi
     _p->_period = qi::Duration(-1);
     _p->_tid = invalidThreadId;
     _p->_compensateCallTime =false;
+    _p->_scheduling = Scheduling::Relative;
     _p->_statsDisplayTime = qi::SteadyClock::now();
     _p->_name = "PeriodicTask_" + boost::lexical_cast<std::string>(this);
     _p->_state = TaskState::Stopped;
@@ -119,8 +128,8 @@ namespace qi
   void PeriodicTask::setStrand(qi::Strand* strand)
   {
     if (strand)
-      _p->_scheduleCallback = [=](const boost::function<void()>& cb, qi::Duration delay) {
-        return qi::getEventLoop()->asyncDelay([=] { return strand->defer(cb); }, delay).unwrap();
+      _p->_scheduleCallback = [=](const boost::function<void()>& cb, qi::SteadyClockTimePoint deadline) {
+        return qi::getEventLoop()->asyncAt([=] { return strand->defer(cb); }, deadline).unwrap();
       };
     else
       _p->_scheduleCallback = PeriodicTaskPrivate::ScheduleCallback();
@@ -157,7 +166,8 @@ namespace qi
       return; // Already running or being started.
     }
     _p->_taskSynchro.reset(new PeriodicTaskPrivate::TaskSynchronizer);
-    _p->_reschedule(immediate ? qi::Duration(0) : _p->_period);
+    _p->_stats = Statistics();
+    _p->_reschedule(qi::SteadyClock::now() + (immediate ? qi::Duration(0) : _p->_period));
   }
 
   void PeriodicTask::asyncStop()
@@ -216,7 +226,8 @@ namespace qi
         qiLogDebug() << "already triggered";
         return;
       }
-      _p->_reschedule();
+      // With a fixed rate, the following deadlines are counted from now.
+      _p->_reschedule(qi::SteadyClock::now());
     }
   }
 
@@ -255,16 +266,19 @@ namespace qi
     }
   }
 
-  void PeriodicTaskPrivate::_reschedule(qi::Duration delay)
+  void PeriodicTaskPrivate::_reschedule(qi::SteadyClockTimePoint deadline)
   {
-    qiLogDebug() << "rescheduling in " << qi::to_string(delay);
+    qiLogDebug() << "rescheduling in " << qi::to_string(deadline - qi::SteadyClock::now());
 
     QI_ASSERT_TRUE(_taskSynchro);
     auto task = qi::track([&]{ _wrap(); }, _taskSynchro.get());
+    // Scheduling at a time point rather than after a delay, so that the time
+    // spent until the timer is armed does not delay the call.
+    _deadline = deadline;
     if (_scheduleCallback)
-      _task = _scheduleCallback(std::move(task), delay);
+      _task = _scheduleCallback(std::move(task), deadline);
     else
-      _task = getEventLoop()->asyncDelay(std::move(task), delay);
+      _task = getEventLoop()->asyncAt(std::move(task), deadline);
     _state = TaskState::Scheduled;
 
     // We track this callback with this object instance just to make sure it won't be called
@@ -278,6 +292,31 @@ namespace qi
           &PeriodicTaskPrivate::_onTaskFinished, this, _1), this), qi::FutureCallbackType_Sync);
   }
 
+  // _mutex must be locked.
+  qi::SteadyClockTimePoint PeriodicTaskPrivate::_nextDeadline(qi::SteadyClockTimePoint deadline,
+                                                              qi::SteadyClockTimePoint start,
+                                                              qi::SteadyClockTimePoint end,
+                                                              bool compensate,
+                                                              PeriodicTask::Scheduling scheduling)
+  {
+    if (scheduling == PeriodicTask::Scheduling::Relative || _period <= qi::Duration(0))
+    {
+      if (_period > qi::Duration(0) && end - start > _period)
+        ++_stats.overruns;
+      return compensate ? std::max(end, start + _period) : end + _period;
+    }
+
+    const qi::SteadyClockTimePoint next = deadline + _period;
+    if (next >= end)
+      return next;
+    ++_stats.overruns;
+    if (scheduling == PeriodicTask::Scheduling::FixedRateCatchUp)
+      return next;
+    const auto missed = (end - next) / _period + 1;
+    _stats.skipped += missed;
+    return next + missed * _period;
+  }
+
   void PeriodicTaskPrivate::_wrap()
   {
     qiLogDebug() << "callback start";
@@ -298,6 +337,9 @@ namespace qi
       _state = TaskState::Running;
       _cond.notify_all();
     }
+    qi::SteadyClockTimePoint start;
+    qi::SteadyClockTimePoint deadline;
+    PeriodicTask::Scheduling scheduling;
     bool shouldAbort = false;
     qi::SteadyClockTimePoint now;
     qi::Duration delta;
@@ -305,11 +347,13 @@ namespace qi
     bool compensate = _compensateCallTime; // we don't want that bool to change in the middle
     try
     {
-      qi::SteadyClockTimePoint start = qi::SteadyClock::now();
+      start = qi::SteadyClock::now();
       std::pair<qi::int64_t, qi::int64_t> cpu = qi::os::cputime();
       {
         ScopedLock l(_mutex);
         _tid = os::gettid();
+        deadline = _deadline;
+        scheduling = _scheduling;
       }
 
       _callback();
@@ -351,6 +395,11 @@ namespace qi
           (float)usr / 1e6f,
           (float)sys / 1e6f);
 
+      const qi::Duration jitter = std::max(qi::Duration(0), start - deadline);
+      ++_stats.calls;
+      _stats.totalJitter += jitter;
+      _stats.maxJitter = std::max(_stats.maxJitter, jitter);
+
       if (now - _statsDisplayTime >= qi::Seconds(20))
       {
         float secTime = float(boost::chrono::duration_cast<qi::MicroSeconds>(now - _statsDisplayTime).count()) / 1e6f;
@@ -377,7 +426,7 @@ namespace qi
         _cond.notify_all();
         return;
       }
-      _reschedule(std::max(qi::Duration(0), _period - (compensate ? delta : qi::Duration(0))));
+      _reschedule(_nextDeadline(deadline, start, now, compensate, scheduling));
     }
   }
 
@@ -387,6 +436,18 @@ namespace qi
     _p->_compensateCallTime = enable;
   }
 
+  void PeriodicTask::setScheduling(Scheduling scheduling)
+  {
+    PeriodicTaskPrivate::ScopedLock l(_p->_mutex);
+    _p->_scheduling = scheduling;
+  }
+
+  PeriodicTask::Statistics PeriodicTask::statistics() const
+  {
+    PeriodicTaskPrivate::ScopedLock l(_p->_mutex);
+    return _p->_stats;
+  }
+
   bool PeriodicTask::isRunning() const
   {
     TaskState s;
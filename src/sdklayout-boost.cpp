@@ -6,17 +6,23 @@
 
 #include <sstream>
 #include <numeric>
+#include <map>
+#include <memory>
+#include <unordered_map>
 
 #include <qi/application.hpp>
 #include <qi/path.hpp>
 #include <qi/os.hpp>
 #include <qi/log.hpp>
 
+#include <boost/algorithm/string/case_conv.hpp>
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
 #include <boost/predef/os.h>
 #include <boost/regex.hpp>
+#include <boost/thread/mutex.hpp>
 #include <locale>
 #include <set>
 #include "sdklayout.hpp"
@@ -62,6 +68,96 @@ std::string relative(
   return relative.string(qi::unicodeFacet());
 }
 
+bool isSeparator(char c)
+{
+#ifdef _WIN32
+  return c == '\\' || c == '/';
+#else
+  return c == '/';
+#endif
+}
+
+std::string withoutTrailingSeparators(std::string path)
+{
+  while (path.size() > 1 && isSeparator(path[path.size() - 1]))
+    path.erase(path.size() - 1);
+  return path;
+}
+
+// Key of a relative path in a DirectoryIndex.
+std::string indexKey(const std::string& relativePath)
+{
+#ifdef _WIN32
+  // The filesystem is case insensitive.
+  return boost::algorithm::to_lower_copy(relativePath, std::locale::classic());
+#else
+  return relativePath;
+#endif
+}
+
+// Snapshot of the entries below a directory of an sdk prefix.
+struct DirectoryIndex
+{
+  DirectoryIndex()
+    : hasDirectorySymlinks(false)
+  {
+  }
+
+  // relative path -> is a directory
+  std::unordered_map<std::string, bool> entries;
+  // files in walk order, as (full path, relative path)
+  std::vector<std::pair<std::string, std::string> > files;
+  // directory symlinks are not walked: lookups below them cannot be answered
+  bool hasDirectorySymlinks;
+};
+using DirectoryIndexPtr = std::shared_ptr<const DirectoryIndex>;
+
+// Walks root and returns its index, or null if it could not be walked.
+DirectoryIndexPtr buildDirectoryIndex(const std::string& root, bool recursive)
+{
+  auto index = std::make_shared<DirectoryIndex>();
+  const boost::filesystem::path rootPath(root, qi::unicodeFacet());
+  try
+  {
+    boost::system::error_code ec;
+    boost::filesystem::recursive_directory_iterator it(rootPath,
+        boost::filesystem::symlink_option::none, ec);
+    if (ec)
+    {
+      if (ec == boost::system::errc::no_such_file_or_directory)
+        return index;
+      qiLogError() << "Cannot index '" << root << "': " << ec.message();
+      return DirectoryIndexPtr();
+    }
+    for (; it != boost::filesystem::recursive_directory_iterator(); ++it)
+    {
+      if (!recursive)
+        it.no_push();
+
+      const boost::filesystem::path& path = it->path();
+      boost::system::error_code statusError;
+      const boost::filesystem::file_status status = boost::filesystem::status(path, statusError);
+      if (!boost::filesystem::exists(status))
+        continue; // dangling symlink
+      const bool isDirectory = boost::filesystem::is_directory(status);
+      if (recursive && isDirectory && boost::filesystem::is_symlink(it->symlink_status()))
+        index->hasDirectorySymlinks = true;
+
+      const std::string relativePath = ::relative(rootPath, path);
+      index->entries.emplace(indexKey(relativePath), isDirectory);
+      if (!isDirectory)
+        index->files.emplace_back(path.string(qi::unicodeFacet()), relativePath);
+    }
+  }
+  catch (const boost::filesystem::filesystem_error& e)
+  {
+    qiLogError() << "Cannot index '" << root << "': " << e.what();
+    return DirectoryIndexPtr();
+  }
+  qiLogDebug() << "Indexed " << index->entries.size() << " entries below " << root;
+  return index;
+}
+
 } // anonymous
 
 namespace qi {
@@ -90,6 +186,15 @@ namespace detail {
     std::string _mode;
     std::string _writablePath;
 
+    /* The directories of the sdk prefixes are indexed on first use and the
+     * index is kept until invalidateCache() is called. The user writable
+     * path is never indexed since it is modified at runtime.
+     */
+    boost::mutex _cacheMutex;
+    std::map<std::string, DirectoryIndexPtr> _recursiveIndexes;
+    std::map<std::string, DirectoryIndexPtr> _flatIndexes;
+    std::map<std::string, boost::regex> _globRegexes;
+
     PrivateSDKLayout()
       : _sdkPrefixes(),
         _mode()
@@ -180,6 +285,99 @@ namespace detail {
       _sdkPrefixes.push_back(execPath.parent_path().parent_path().string(qi::unicodeFacet()));
     }
 
+    void invalidateCache()
+    {
+      boost::mutex::scoped_lock lock(_cacheMutex);
+      _recursiveIndexes.clear();
+      _flatIndexes.clear();
+      _globRegexes.clear();
+    }
+
+    boost::regex globRegex(const std::string& glob)
+    {
+      boost::mutex::scoped_lock lock(_cacheMutex);
+      auto it = _globRegexes.find(glob);
+      if (it != _globRegexes.end())
+        return it->second;
+      // Patterns are usually a handful of literals, this only bounds misuse.
+      if (_globRegexes.size() >= 256)
+        _globRegexes.clear();
+      boost::regex regex(globToRegex(glob));
+      _globRegexes.emplace(glob, regex);
+      return regex;
+    }
+
+    // Returns the index of the directory, or null if it cannot be indexed.
+    // A recursive index also answers non-recursive queries.
+    DirectoryIndexPtr directoryIndex(const std::string& directory, bool recursive)
+    {
+      const std::string root = withoutTrailingSeparators(directory);
+      {
+        boost::mutex::scoped_lock lock(_cacheMutex);
+        auto it = _recursiveIndexes.find(root);
+        if (it != _recursiveIndexes.end())
+          return it->second;
+        if (!recursive)
+        {
+          it = _flatIndexes.find(root);
+          if (it != _flatIndexes.end())
+            return it->second;
+        }
+      }
+
+      // Walk without the lock, concurrent walks of the same root are harmless.
+      DirectoryIndexPtr index = buildDirectoryIndex(root, recursive);
+      if (!index)
+        return index;
+
+      boost::mutex::scoped_lock lock(_cacheMutex);
+      auto& indexes = recursive ? _recursiveIndexes : _flatIndexes;
+      return indexes.emplace(root, index).first->second;
+    }
+
+    /* Tells whether path, which must be below directory, exists according to
+     * the index of directory. Returns none if the index cannot tell, in which
+     * case the filesystem must be checked.
+     */
+    boost::optional<bool> cachedExists(const std::string& directory,
+                                       const std::string& path,
+                                       bool recursive,
+                                       bool fileOnly)
+    {
+      const std::string root = withoutTrailingSeparators(directory);
+      if (path.size() <= root.size() + 1
+          || path.compare(0, root.size(), root) != 0
+          || !isSeparator(path[root.size()]))
+        return boost::none;
+
+      const std::string key = path.substr(root.size() + 1);
+      std::size_t begin = 0;
+      while (begin <= key.size())
+      {
+        std::size_t end = begin;
+        while (end < key.size() && !isSeparator(key[end]))
+          ++end;
+        const std::string component = key.substr(begin, end - begin);
+        if (component.empty() || component == "." || component == "..")
+          return boost::none;
+        if (end < key.size() && !recursive)
+          return boost::none;
+        begin = end + 1;
+      }
+
+      DirectoryIndexPtr index = directoryIndex(root, recursive);
+      if (!index)
+        return boost::none;
+      auto it = index->entries.find(indexKey(key));
+      if (it == index->entries.end())
+      {
+        if (index->hasDirectorySymlinks)
+          return boost::none;
+        return false;
+      }
+      return !fileOnly || !it->second;
+    }
+
     void checkInit()
     {
       if (_mode == "error" || _sdkPrefixes.empty()) {
@@ -305,18 +503,35 @@ namespace detail {
     return _p->_sdkPrefixes;
   }
 
+  void SDKLayout::invalidateCache()
+  {
+    _p->invalidateCache();
+  }
+
+  // When sdk is set, prefix is a directory of one of its sdk prefixes and
+  // its index is used instead of the filesystem.
   static std::string existsFile(boost::filesystem::path prefix,
-                               const std::string& fileName)
+                               const std::string& fileName,
+                               PrivateSDKLayout* sdk = nullptr)
   {
     const boost::filesystem::path file(fileName, qi::unicodeFacet());
 
     try
     {
-      const boost::filesystem::path pathFile(fsconcat(prefix.string(qi::unicodeFacet()),
+      const std::string prefixString = prefix.string(qi::unicodeFacet());
+      const boost::filesystem::path pathFile(fsconcat(prefixString,
                                                       file.string(qi::unicodeFacet())),
                                              qi::unicodeFacet());
       const boost::filesystem::path pathFileSysComplete(boost::filesystem::system_complete(pathFile));
 
+      if (sdk)
+      {
+        const boost::optional<bool> exists =
+            sdk->cachedExists(prefixString, pathFile.string(qi::unicodeFacet()), false, true);
+        if (exists)
+          return *exists ? pathFileSysComplete.string(qi::unicodeFacet()) : std::string();
+      }
+
       if (boost::filesystem::exists(pathFileSysComplete)
           && !boost::filesystem::is_directory(pathFileSysComplete))
         return (pathFileSysComplete.string(qi::unicodeFacet()));
@@ -342,17 +557,17 @@ namespace detail {
       {
         const boost::filesystem::path p(path / "bin");
 
-        std::string res = existsFile(p, name);
+        std::string res = existsFile(p, name, _p);
         if (!res.empty())
           return res;
 #ifdef _WIN32
 //DEBUG
 #ifndef NDEBUG
-        res = existsFile(p, name + "_d.exe");
+        res = existsFile(p, name + "_d.exe", _p);
         if (!res.empty())
           return res;
 #endif
-        res = existsFile(p, name + ".exe");
+        res = existsFile(p, name + ".exe", _p);
         if (!res.empty())
           return res;
 #endif
@@ -422,50 +637,50 @@ namespace detail {
         boost::filesystem::path p;
         p = boost::filesystem::path(fsconcat(*it, "lib", prefix.string(qi::unicodeFacet())), qi::unicodeFacet());
 
-        res = existsFile(p, libName);
+        res = existsFile(p, libName, _p);
         if (res != std::string())
           return res;
-        res = existsFile(p, libName + ".so");
+        res = existsFile(p, libName + ".so", _p);
         if (res != std::string())
           return res;
-        res = existsFile(p, "lib" + libName + ".so");
+        res = existsFile(p, "lib" + libName + ".so", _p);
         if (res != std::string())
           return res;
-        res = existsFile(p, "lib" + libName);
+        res = existsFile(p, "lib" + libName, _p);
         if (res != std::string())
           return res;
 #ifdef __APPLE__
-        res = existsFile(p, libName + ".dylib");
+        res = existsFile(p, libName + ".dylib", _p);
         if (res != std::string())
           return res;
-        res = existsFile(p, "lib" + libName + ".dylib");
+        res = existsFile(p, "lib" + libName + ".dylib", _p);
         if (res != std::string())
           return res;
-        res = existsFile(p, "lib" + libName);
+        res = existsFile(p, "lib" + libName, _p);
         if (res != std::string())
           return res;
 #endif
 #ifdef _WIN32
 //DEBUG
 #ifndef NDEBUG
-        res = existsFile(p, libName + "_d.dll");
+        res = existsFile(p, libName + "_d.dll", _p);
         if (res != std::string())
           return res;
-        res = existsFile(p, "lib" + libName + "_d.dll");
+        res = existsFile(p, "lib" + libName + "_d.dll", _p);
         if (res != std::string())
           return res;
-        res = existsFile(p, "lib" + libName);
+        res = existsFile(p, "lib" + libName, _p);
         if (res != std::string())
           return res;
 #endif
 
-        res = existsFile(p, libName + ".dll");
+        res = existsFile(p, libName + ".dll", _p);
         if (res != std::string())
           return res;
-        res = existsFile(p, "lib" + libName + ".dll");
+        res = existsFile(p, "lib" + libName + ".dll", _p);
         if (res != std::string())
           return res;
-        res = existsFile(p, "lib" + libName);
+        res = existsFile(p, "lib" + libName, _p);
         if (res != std::string())
           return res;
 
@@ -473,24 +688,24 @@ namespace detail {
         p = boost::filesystem::path(fsconcat(*it, "bin", prefix.string(qi::unicodeFacet())), qi::unicodeFacet());
 
 #ifndef NDEBUG
-        res = existsFile(p, libName + "_d.dll");
+        res = existsFile(p, libName + "_d.dll", _p);
         if (res != std::string())
           return res;
-        res = existsFile(p, "lib" + libName + "_d.dll");
+        res = existsFile(p, "lib" + libName + "_d.dll", _p);
         if (res != std::string())
           return res;
-        res = existsFile(p, "lib" + libName);
+        res = existsFile(p, "lib" + libName, _p);
         if (res != std::string())
           return res;
 #endif
 
-        res = existsFile(p, libName + ".dll");
+        res = existsFile(p, libName + ".dll", _p);
         if (res != std::string())
           return res;
-        res = existsFile(p, "lib" + libName + ".dll");
+        res = existsFile(p, "lib" + libName + ".dll", _p);
         if (res != std::string())
           return res;
-        res = existsFile(p, "lib" + libName);
+        res = existsFile(p, "lib" + libName, _p);
         if (res != std::string())
           return res;
 #endif
@@ -542,10 +757,22 @@ namespace detail {
     std::vector<std::string> paths = dataPaths(applicationName, excludeUserWritablePath);
     try
     {
-      std::vector<std::string>::const_iterator it;
-      for (it = paths.begin(); it != paths.end(); ++it)
+      for (std::size_t i = 0; i < paths.size(); ++i)
       {
-        boost::filesystem::path p(fsconcat(*it, filename), qi::unicodeFacet());
+        const std::string candidate = fsconcat(paths[i], filename);
+        const bool isUserWritablePath = !excludeUserWritablePath && i == 0;
+        if (!isUserWritablePath)
+        {
+          const boost::optional<bool> exists = _p->cachedExists(paths[i], candidate, true, false);
+          if (exists)
+          {
+            if (*exists)
+              return boost::filesystem::path(candidate, qi::unicodeFacet()).string(qi::unicodeFacet());
+            continue;
+          }
+        }
+
+        boost::filesystem::path p(candidate, qi::unicodeFacet());
 
         if (boost::filesystem::exists(p))
           return p.string(qi::unicodeFacet());
@@ -558,8 +785,11 @@ namespace detail {
     return std::string();
   }
 
-  static std::vector<std::string> listFiles(std::vector<std::string> filePaths,
-                                            const std::string &pattern)
+  // The first path is not looked up in the index if firstIsUserWritable is set.
+  static std::vector<std::string> listFiles(PrivateSDKLayout* sdk,
+                                            std::vector<std::string> filePaths,
+                                            const std::string &pattern,
+                                            bool firstIsUserWritable = false)
   {
     std::set<std::string> matchedPaths;
     std::vector<std::string> fullPaths;
@@ -574,7 +804,23 @@ namespace detail {
       // ensures the pattern is formatted in the same way than the input.
       // Otherwise on Windows we might fail when trying to match
       // foo\data\model.txt with foo\data/*.txt (instead of foo\data\*.txt)
-      boost::regex pathRegex(globToRegex(fsconcat(*it, pattern)));
+      boost::regex pathRegex(sdk->globRegex(fsconcat(*it, pattern)));
+
+      if (!(firstIsUserWritable && it == paths.begin()))
+      {
+        DirectoryIndexPtr index = sdk->directoryIndex(*it, true);
+        if (index)
+        {
+          for (const auto& file : index->files)
+          {
+            if (boost::regex_match(file.first, pathRegex)
+                && matchedPaths.insert(file.second).second)
+              fullPaths.push_back(file.first);
+          }
+          continue;
+        }
+      }
+
       try
       {
         boost::system::error_code ec;
@@ -628,7 +874,7 @@ namespace detail {
   std::vector<std::string> SDKLayout::listLib(const std::string &subfolder,
                                               const std::string &pattern) const
   {
-    std::vector<std::string> files = listFiles(libPaths(subfolder), pattern);
+    std::vector<std::string> files = listFiles(_p, libPaths(subfolder), pattern);
     std::vector<std::string> libs;
     for (unsigned i = 0; i < files.size(); ++i)
     {
@@ -654,7 +900,8 @@ namespace detail {
                                                const std::string &pattern,
                                                bool excludeUserWritablePath) const
   {
-    return listFiles(dataPaths(applicationName, excludeUserWritablePath), pattern);
+    return listFiles(_p, dataPaths(applicationName, excludeUserWritablePath), pattern,
+                     !excludeUserWritablePath);
   }
 
 
@@ -79,6 +79,9 @@ namespace qi
     /** @copydoc qi::path::clearOptionalSdkPrefix */
     void clearOptionalSdkPrefix();
 
+    /** @copydoc qi::path::detail::invalidateCache */
+    void invalidateCache();
+
 
 
     /** @copydoc qi::path::findBinary */
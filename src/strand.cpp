@@ -3,7 +3,9 @@
 **  See COPYING for the license
 */
 #include <atomic>
+#include <iterator>
 #include <boost/atomic.hpp>
+#include <boost/optional.hpp>
 
 #include <qi/strand.hpp>
 #include <qi/log.hpp>
@@ -41,19 +43,46 @@ enum class StrandPrivate::State
 struct StrandPrivate::Callback
 {
   uint32_t id;
-  State state;
+  // Transitions from Scheduled are done with compare and swap, as the processing of a batch of
+  // callbacks does not hold the mutex.
+  std::atomic<State> state;
   boost::function<void()> callback;
-  qi::Promise<void> promise;
+  // Unset for the callbacks that are posted, nobody observes their result.
+  boost::optional<qi::Promise<void>> promise;
   qi::Future<void> asyncFuture;
+  TaskPriority priority;
+  qi::SteadyClockTimePoint enqueued; // only set when statistics are enabled
+
+  void setValue()
+  {
+    if (promise)
+      promise->setValue(0);
+  }
+
+  void setError(const std::string& error)
+  {
+    if (promise)
+      promise->setError(error);
+    else
+      qiLogWarning() << "Callback posted to a strand failed: " << error;
+  }
+
+  void setCanceled()
+  {
+    if (promise)
+      promise->setCanceled();
+  }
 };
 
-boost::shared_ptr<StrandPrivate::Callback> StrandPrivate::createCallback(boost::function<void()> cb)
+boost::shared_ptr<StrandPrivate::Callback> StrandPrivate::createCallback(
+    boost::function<void()> cb, TaskPriority priority)
 {
   ++_aliveCount;
   boost::shared_ptr<Callback> cbStruct = boost::make_shared<Callback>();
   cbStruct->id = ++_curId;
   cbStruct->state = State::None;
   cbStruct->callback = std::move(cb);
+  cbStruct->priority = priority;
   return cbStruct;
 }
 
@@ -66,15 +95,23 @@ Future<void> StrandPrivate::asyncAtImpl(boost::function<void()> cb, qi::SteadyCl
 }
 
 Future<void> StrandPrivate::asyncDelayImpl(boost::function<void()> cb, qi::Duration delay)
+{
+  return asyncDelayWithPriorityImpl(std::move(cb), delay, TaskPriority::Normal);
+}
+
+Future<void> StrandPrivate::asyncDelayWithPriorityImpl(boost::function<void()> cb,
+                                                       qi::Duration delay,
+                                                       TaskPriority priority)
 {
   if (delay == qi::Duration::zero() && isInThisContext())
     return execNow(std::move(cb));
-  return deferImpl(std::move(cb), delay);
+  return deferImpl(std::move(cb), delay, priority);
 }
 
-Future<void> StrandPrivate::deferImpl(boost::function<void()> cb, qi::Duration delay)
+Future<void> StrandPrivate::deferImpl(boost::function<void()> cb, qi::Duration delay,
+                                      TaskPriority priority)
 {
-  boost::shared_ptr<Callback> cbStruct = createCallback(std::move(cb));
+  boost::shared_ptr<Callback> cbStruct = createCallback(std::move(cb), priority);
   cbStruct->promise =
     qi::Promise<void>(boost::bind(&StrandPrivate::cancel, this, cbStruct));
   qiLogDebug() << "Deferring job id " << cbStruct->id << " in " << qi::to_string(delay);
@@ -84,11 +121,13 @@ Future<void> StrandPrivate::deferImpl(boost::function<void()> cb, qi::Duration d
         delay);
   else
     enqueue(cbStruct);
-  return cbStruct->promise.future();
+  return cbStruct->promise->future();
 }
 
 void StrandPrivate::enqueue(boost::shared_ptr<Callback> cbStruct)
 {
+  unsigned int post = 0;
+  TaskPriority priority = _priority;
   const bool shouldschedule = [&]()
   {
     boost::recursive_mutex::scoped_lock lock(_mutex);
@@ -98,14 +137,21 @@ void StrandPrivate::enqueue(boost::shared_ptr<Callback> cbStruct)
     {
       if (_dying)
       {
-        cbStruct->promise.setError("the strand is dying");
+        cbStruct->setError("the strand is dying");
         qiLogDebug() << "Strand is dying on job id " << cbStruct->id;
         return false;
       }
 
       qiLogDebug() << "Strand callback state is None on job id " << cbStruct->id;
       _queue.push_back(cbStruct);
+      if (cbStruct->priority == TaskPriority::High)
+        ++_highPriorityCount;
       cbStruct->state = State::Scheduled;
+      if (detail::ExecutionStatisticsRecorder::enabled())
+      {
+        cbStruct->enqueued = SteadyClock::now();
+        _statistics.taskQueued();
+      }
     }
     else
     {
@@ -118,17 +164,31 @@ void StrandPrivate::enqueue(boost::shared_ptr<Callback> cbStruct)
     {
       qiLogDebug() << "Schedule process on job id " << cbStruct->id;
       _processing = true;
-      return true;
     }
-
-    return false;
+    else if (_processStarted || _processPriority == TaskPriority::High
+             || cbStruct->priority != TaskPriority::High)
+      return false;
+    else
+      qiLogDebug() << "Reschedule process with a higher priority on job id " << cbStruct->id;
+    post = nextProcessPost();
+    priority = _processPriority;
+    return true;
   }();
 
   if (shouldschedule)
-  {
-    qiLogDebug() << "StrandPrivate::process was not scheduled, doing it";
-    _eventLoop.async(boost::bind(&StrandPrivate::process, shared_from_this()));
-  }
+    postProcess(post, priority);
+}
+
+unsigned int StrandPrivate::nextProcessPost()
+{
+  _processStarted = false;
+  _processPriority = _highPriorityCount > 0 ? TaskPriority::High : _priority;
+  return ++_processPost;
+}
+
+void StrandPrivate::postProcess(unsigned int post, TaskPriority priority)
+{
+  _eventLoop.post(boost::bind(&StrandPrivate::process, shared_from_this(), post), priority);
 }
 
 void StrandPrivate::stopProcess(boost::recursive_mutex::scoped_lock& lock,
@@ -138,8 +198,10 @@ void StrandPrivate::stopProcess(boost::recursive_mutex::scoped_lock& lock,
   if (!finished && !_dying)
   {
     qiLogDebug() << "Strand quantum expired, rescheduling";
+    const unsigned int post = nextProcessPost();
+    const TaskPriority priority = _processPriority;
     lock.unlock();
-    _eventLoop.async(boost::bind(&StrandPrivate::process, shared_from_this()));
+    postProcess(post, priority);
   }
   else
   {
@@ -148,27 +210,40 @@ void StrandPrivate::stopProcess(boost::recursive_mutex::scoped_lock& lock,
   }
 }
 
-void StrandPrivate::process()
+void StrandPrivate::process(unsigned int post)
 {
-  static const unsigned int QI_STRAND_QUANTUM_US =
-    qi::os::getEnvDefault<unsigned int>("QI_STRAND_QUANTUM_US", 5000);
+  static const qi::MicroSeconds quantum(
+    qi::os::getEnvDefault<unsigned int>("QI_STRAND_QUANTUM_US", 5000));
+
+  {
+    boost::recursive_mutex::scoped_lock lock(_mutex);
+    if (post != _processPost)
+    {
+      qiLogDebug() << "StrandPrivate::process superseded by a posting of higher priority";
+      return;
+    }
+    _processStarted = true;
+  }
 
   qiLogDebug() << "StrandPrivate::process started";
 
   _processingThread = qi::os::gettid();
 
-  qi::SteadyClockTimePoint start = qi::SteadyClock::now();
+  // The clock is read once per callback: the end of a callback is the start of the next one.
+  const bool withStatistics = detail::ExecutionStatisticsRecorder::enabled();
+  const qi::SteadyClockTimePoint start = qi::SteadyClock::now();
+  qi::SteadyClockTimePoint jobStart = start;
+  qi::SteadyClockTimePoint jobEnd = start;
 
-  do
+  // The callbacks are dequeued all at once, then run without holding the mutex.
+  Queue batch;
+  while (jobEnd - start < quantum && !_dying)
   {
-    boost::shared_ptr<Callback> cbStruct;
+    if (batch.empty())
     {
       boost::recursive_mutex::scoped_lock lock(_mutex);
       if (_dying)
-      {
-        qiLogDebug() << this << " strand is dying, stopping process";
         break;
-      }
 
       QI_ASSERT(_processing);
       if (_queue.empty())
@@ -178,80 +253,124 @@ void StrandPrivate::process()
         _processingThread = 0;
         return;
       }
-      cbStruct = _queue.front();
-      _queue.pop_front();
-      if (cbStruct->state == State::Scheduled)
-      {
-        --_aliveCount;
-        cbStruct->state = State::Running;
-      }
-      else
-      {
-        // Job was canceled, cancel() already has done --_aliveCount
-        qiLogDebug() << "Abandoning job id " << cbStruct->id
-          << ", state: " << static_cast<int>(cbStruct->state);
-        continue;
-      }
+      swap(batch, _queue);
+      _highPriorityCount = 0;
+    }
+
+    boost::shared_ptr<Callback> cbStruct = std::move(batch.front());
+    batch.pop_front();
+    State expected = State::Scheduled;
+    if (!cbStruct->state.compare_exchange_strong(expected, State::Running))
+    {
+      // Job was canceled, cancel() already has done --_aliveCount
+      qiLogDebug() << "Abandoning job id " << cbStruct->id
+        << ", state: " << static_cast<int>(expected);
+      continue;
     }
+    --_aliveCount;
+
     qiLogDebug() << "Executing job id " << cbStruct->id;
+    if (withStatistics)
+    {
+      _statistics.taskStarted(true, jobStart - std::min(cbStruct->enqueued, jobStart));
+    }
     try {
       cbStruct->callback();
-      cbStruct->promise.setValue(0);
+      cbStruct->setValue();
     }
     catch (std::exception& e) {
-      cbStruct->promise.setError(e.what());
+      cbStruct->setError(e.what());
     }
     catch (...) {
-      cbStruct->promise.setError("callback has thrown in strand");
+      cbStruct->setError("callback has thrown in strand");
     }
     qiLogDebug() << "Finished job id " << cbStruct->id;
-  } while (qi::SteadyClock::now() - start < qi::MicroSeconds(QI_STRAND_QUANTUM_US));
+    jobEnd = qi::SteadyClock::now();
+    if (withStatistics)
+      _statistics.taskFinished(jobEnd - jobStart, cbStruct->callback.target_type().name());
+    jobStart = jobEnd;
+  }
+
+  if (_dying)
+    qiLogDebug() << this << " strand is dying, stopping process";
 
   _processingThread = 0;
 
   {
     boost::recursive_mutex::scoped_lock lock(_mutex);
+    if (_dying)
+    {
+      // The strand may have been joined from one of its callbacks, which does not wait
+      // for the queue to be emptied: nothing will run the callbacks left.
+      dropQueue(batch);
+      dropQueue(_queue);
+      _highPriorityCount = 0;
+    }
+    else
+    {
+      // Give back the callbacks that did not fit in the quantum, they go before the newer ones.
+      for (const auto& cbStruct : batch)
+        if (cbStruct->priority == TaskPriority::High)
+          ++_highPriorityCount;
+      _queue.insert(_queue.begin(),
+                    std::make_move_iterator(batch.begin()),
+                    std::make_move_iterator(batch.end()));
+    }
     stopProcess(lock, false);
   }
 }
 
+void StrandPrivate::dropQueue(Queue& queue)
+{
+  while (!queue.empty())
+  {
+    auto task = std::move(queue.front());
+    queue.pop_front();
+    State expected = State::Scheduled;
+    // Canceled callbacks were already unqueued by cancel().
+    if (!task->state.compare_exchange_strong(expected, State::Canceled))
+      continue;
+    if (detail::ExecutionStatisticsRecorder::enabled())
+      _statistics.taskUnqueued();
+    task->setError("the strand is dying");
+    --_aliveCount;
+  }
+}
+
 void StrandPrivate::cancel(boost::shared_ptr<Callback> cbStruct)
 {
   boost::recursive_mutex::scoped_lock lock(_mutex);
 
-  switch (cbStruct->state)
+  State expected = State::None;
+  if (cbStruct->state.compare_exchange_strong(expected, State::Canceled))
+  {
+    qiLogDebug() << "Not scheduled yet, canceling future";
+    cbStruct->asyncFuture.cancel();
+    --_aliveCount;
+    cbStruct->setCanceled();
+  }
+  else if (expected == State::Scheduled
+           && cbStruct->state.compare_exchange_strong(expected, State::Canceled))
   {
-    case State::None:
-      qiLogDebug() << "Not scheduled yet, canceling future";
-      cbStruct->asyncFuture.cancel();
-      cbStruct->state = State::Canceled;
-      --_aliveCount;
-      cbStruct->promise.setCanceled();
-      break;
-    case State::Scheduled:
-      qiLogDebug() << "Was scheduled, removing it from queue";
+    qiLogDebug() << "Was scheduled, removing it from queue";
+    // If it is not in the queue, it is in the batch being processed, which will skip it.
+    for (Queue::iterator iter = _queue.begin(); iter != _queue.end(); ++iter)
+      if ((*iter)->id == cbStruct->id)
       {
-        bool erased = false;
-        for (Queue::iterator iter = _queue.begin(); iter != _queue.end(); ++iter)
-          if ((*iter)->id == cbStruct->id)
-          {
-            _queue.erase(iter);
-            erased = true;
-            break;
-          }
-        // state was scheduled, so the callback must be there
-        QI_ASSERT(erased);
-        // Silence compile warning unused erased
-        (void)erased;
-
+        if (cbStruct->priority == TaskPriority::High)
+          --_highPriorityCount;
+        _queue.erase(iter);
+        break;
       }
-      --_aliveCount;
-      cbStruct->promise.setCanceled();
-      break;
-    default:
-      qiLogDebug() << "State is " << static_cast<int>(cbStruct->state)
-        << ", too late for canceling";
-      break;
+    if (detail::ExecutionStatisticsRecorder::enabled())
+      _statistics.taskUnqueued();
+    --_aliveCount;
+    cbStruct->setCanceled();
+  }
+  else
+  {
+    qiLogDebug() << "State is " << static_cast<int>(expected)
+      << ", too late for canceling";
   }
 }
 
@@ -271,6 +390,11 @@ Strand::Strand(qi::ExecutionContext& eventloop)
 {
 }
 
+Strand::Strand(qi::ExecutionContext& eventloop, TaskPriority priority)
+  : _p(new StrandPrivate(eventloop, priority))
+{
+}
+
 Strand::~Strand()
 {
   join();
@@ -304,16 +428,8 @@ void Strand::join()
     boost::atomic_exchange(&prv, _p);
 
     prv->_processFinished.wait(lock, [&]{ return !prv->_processing; });
-    while (!prv->_queue.empty())
-    {
-      auto task = std::move(prv->_queue.front());
-      prv->_queue.pop_front();
-      if (task->state == StrandPrivate::State::Canceled)
-        continue;
-      QI_ASSERT(task->state == StrandPrivate::State::Scheduled);
-      task->promise.setError("the strand is dying");
-      --prv->_aliveCount;
-    }
+    prv->dropQueue(prv->_queue);
+    prv->_highPriorityCount = 0;
 
     qiLogVerbose() << this << " joined, remaining tasks: " << prv->_aliveCount;
   }
@@ -358,10 +474,25 @@ Future<void> Strand::asyncDelayImpl(boost::function<void()> cb, qi::Duration del
 }
 
 void Strand::postImpl(boost::function<void()> callback)
+{
+  postWithPriorityImpl(std::move(callback), TaskPriority::Normal);
+}
+
+void Strand::postWithPriorityImpl(boost::function<void()> callback, TaskPriority priority)
 {
   auto prv = boost::atomic_load(&_p);
   if (prv)
-    prv->enqueue(prv->createCallback(std::move(callback)));
+    prv->enqueue(prv->createCallback(std::move(callback), priority));
+}
+
+Future<void> Strand::asyncDelayWithPriorityImpl(boost::function<void()> cb, qi::Duration delay,
+                                                TaskPriority priority)
+{
+  auto prv = boost::atomic_load(&_p);
+  if (prv)
+    return prv->asyncDelayWithPriorityImpl(std::move(cb), delay, priority);
+  else
+    return makeFutureError<void>("the strand is dying");
 }
 
 Future<void> Strand::defer(const boost::function<void ()>& cb)
@@ -373,6 +504,15 @@ Future<void> Strand::defer(const boost::function<void ()>& cb)
     return makeFutureError<void>("the strand is dying");
 }
 
+ExecutionStatistics Strand::statistics() const
+{
+  auto prv = boost::atomic_load(&_p);
+  if (prv)
+    return prv->_statistics.statistics();
+  else
+    return ExecutionStatistics();
+}
+
 bool Strand::isInThisContext() const
 {
   auto prv = boost::atomic_load(&_p);
@@ -41,3 +41,89 @@ TRACEPOINT_EVENT(qi_qi, eventloop_task_error,
         TP_ARGS(unsigned int, taskId),
         TP_FIELDS(ctf_integer(int, taskId, taskId))
 )
+
+//Steps of the lifecycle of a message, keyed by the message id
+TRACEPOINT_EVENT_CLASS(qi_qi, message_class,
+        TP_ARGS(unsigned int, id,
+                unsigned int, service,
+                unsigned int, object,
+                unsigned int, function,
+                int, type),
+        TP_FIELDS(ctf_integer(unsigned int, id, id)
+                  ctf_integer(unsigned int, service, service)
+                  ctf_integer(unsigned int, object, object)
+                  ctf_integer(unsigned int, function, function)
+                  ctf_integer(int, type, type))
+)
+
+//RemoteObject::metaCall, before the arguments are serialized
+TRACEPOINT_EVENT_INSTANCE(qi_qi, message_class, rpc_call,
+        TP_ARGS(unsigned int, id,
+                unsigned int, service,
+                unsigned int, object,
+                unsigned int, function,
+                int, type)
+)
+
+//Message serialized and queued for sending on a socket
+TRACEPOINT_EVENT_INSTANCE(qi_qi, message_class, message_enqueue,
+        TP_ARGS(unsigned int, id,
+                unsigned int, service,
+                unsigned int, object,
+                unsigned int, function,
+                int, type)
+)
+
+//Message written to the socket
+TRACEPOINT_EVENT_INSTANCE(qi_qi, message_class, message_sent,
+        TP_ARGS(unsigned int, id,
+                unsigned int, service,
+                unsigned int, object,
+                unsigned int, function,
+                int, type)
+)
+
+//Message read from a socket
+TRACEPOINT_EVENT_INSTANCE(qi_qi, message_class, message_received,
+        TP_ARGS(unsigned int, id,
+                unsigned int, service,
+                unsigned int, object,
+                unsigned int, function,
+                int, type)
+)
+
+//Message handed to the MessageDispatcher
+TRACEPOINT_EVENT_INSTANCE(qi_qi, message_class, message_dispatch,
+        TP_ARGS(unsigned int, id,
+                unsigned int, service,
+                unsigned int, object,
+                unsigned int, function,
+                int, type)
+)
+
+//Message received by ServiceBoundObject::onMessage
+TRACEPOINT_EVENT_INSTANCE(qi_qi, message_class, server_message,
+        TP_ARGS(unsigned int, id,
+                unsigned int, service,
+                unsigned int, object,
+                unsigned int, function,
+                int, type)
+)
+
+//Call arguments decoded, method about to be invoked
+TRACEPOINT_EVENT_INSTANCE(qi_qi, message_class, server_call_start,
+        TP_ARGS(unsigned int, id,
+                unsigned int, service,
+                unsigned int, object,
+                unsigned int, function,
+                int, type)
+)
+
+//Call finished, result about to be serialized (serverResultAdapter)
+TRACEPOINT_EVENT_INSTANCE(qi_qi, message_class, server_call_result,
+        TP_ARGS(unsigned int, id,
+                unsigned int, service,
+                unsigned int, object,
+                unsigned int, function,
+                int, type)
+)
@@ -8,12 +8,17 @@
 
 #include <boost/filesystem.hpp>
 #include <boost/locale.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
 #include <boost/thread/mutex.hpp>
 
 #include <qi/translator.hpp>
 #include <qi/path.hpp>
 #include <qi/log.hpp>
 
+#include <map>
+#include <set>
+
 #include "utils.hpp"
 
 qiLogCategory("qi.translator");
@@ -124,8 +129,23 @@ namespace qi
   class TranslatorPrivate
   {
   public:
+    /* State read by translate(). It is never modified once published:
+     * writers copy it, update the copy and swap it in, so that readers only
+     * take an atomic load of the pointer.
+     */
+    struct Snapshot
+    {
+      std::string                        currentLocale;
+      std::string                        currentDomain;
+      std::set<std::string>              domains;
+      // Locales generated on first use, with the catalogs of all domains.
+      std::map<std::string, std::locale> locales;
+    };
+    using SnapshotPtr = boost::shared_ptr<const Snapshot>;
+
     // TODO : as name is not used anymore (domain paths are pre-loaded by packageManager, who loads all of them) we can remove it and change the API
     TranslatorPrivate(const std::string &name)
+      : snapshot(boost::make_shared<Snapshot>())
     {
       if (name.empty())
       {
@@ -134,28 +154,75 @@ namespace qi
       addDomainPath();
     }
 
+    SnapshotPtr current() const
+    {
+      return boost::atomic_load(&snapshot);
+    }
+
     void setCurrentLocale(const std::string &locale)
     {
       boost::mutex::scoped_lock l(mutex);
-      currentLocale = locale;
-      if (currentLocale.find(".UTF-8") == std::string::npos)
+      boost::shared_ptr<Snapshot> next = boost::make_shared<Snapshot>(*current());
+      next->currentLocale = locale;
+      if (next->currentLocale.find(".UTF-8") == std::string::npos)
       {
-        currentLocale += ".UTF-8";
+        next->currentLocale += ".UTF-8";
       }
+      boost::atomic_store(&snapshot, SnapshotPtr(next));
     }
 
     void setDefaultDomain(const std::string &domain)
     {
       boost::mutex::scoped_lock l(mutex);
-      currentDomain = domain;
       generator.add_messages_domain(domain);
       generator.set_default_messages_domain(domain);
+      boost::shared_ptr<Snapshot> next = boost::make_shared<Snapshot>(*current());
+      next->currentDomain = domain;
+      next->domains.insert(domain);
+      // The default domain is part of the generated locales.
+      next->locales.clear();
+      boost::atomic_store(&snapshot, SnapshotPtr(next));
     }
 
     void addDomain(const std::string &domain)
     {
+      if (current()->domains.count(domain))
+        return;
+
       boost::mutex::scoped_lock l(mutex);
+      SnapshotPtr prev = current();
+      if (prev->domains.count(domain))
+        return;
       generator.add_messages_domain(domain);
+      boost::shared_ptr<Snapshot> next = boost::make_shared<Snapshot>(*prev);
+      next->domains.insert(domain);
+      // Locales generated so far do not hold the catalogs of the new domain.
+      next->locales.clear();
+      boost::atomic_store(&snapshot, SnapshotPtr(next));
+    }
+
+    // Returns the locale named name, generating it on first use.
+    std::locale locale(const std::string &name)
+    {
+      {
+        SnapshotPtr s = current();
+        std::map<std::string, std::locale>::const_iterator it = s->locales.find(name);
+        if (it != s->locales.end())
+          return it->second;
+      }
+
+      boost::mutex::scoped_lock l(mutex);
+      SnapshotPtr prev = current();
+      std::map<std::string, std::locale>::const_iterator it = prev->locales.find(name);
+      if (it != prev->locales.end())
+        return it->second;
+
+      qiLogVerbose() << "Loading catalogs for " << name;
+      std::locale loc = generator(name);
+      boost::shared_ptr<Snapshot> next = boost::make_shared<Snapshot>(*prev);
+      next->locales.insert(std::make_pair(name, loc));
+      boost::atomic_store(&snapshot, SnapshotPtr(next));
+      return loc;
     }
 
     void addDomainPath()
@@ -171,10 +238,10 @@ namespace qi
     }
 
   public:
+    // Serializes the writers and the use of the generator.
     boost::mutex             mutex;
     boost::locale::generator generator;
-    std::string              currentLocale;
-    std::string              currentDomain;
+    SnapshotPtr              snapshot;
   };
 
 
@@ -193,8 +260,8 @@ namespace qi
                                     const std::string &locale,
                                     const std::string &context)
   {
-    boost::mutex::scoped_lock l(_p->mutex);
-    if (_p->currentDomain.empty() && domain.empty())
+    const TranslatorPrivate::SnapshotPtr s = _p->current();
+    if (s->currentDomain.empty() && domain.empty())
     {
       qiLogWarning() << "You must call setDefaultDomain first!";
       return msg;
@@ -203,14 +270,14 @@ namespace qi
     std::string loc;
     if (locale.empty())
     {
-      if (_p->currentLocale.empty())
+      if (s->currentLocale.empty())
       {
         qiLogWarning() << "You must call setDefaultLocale first!";
         return msg;
       }
       else
       {
-        loc = _p->currentLocale;
+        loc = s->currentLocale;
       }
     }
     else
@@ -221,19 +288,11 @@ namespace qi
     std::string dom;
     if (domain.empty())
     {
-      if (_p->currentDomain.empty())
-      {
-        qiLogWarning() << "You must call setDefaultDomain first!";
-        return msg;
-      }
-      else
-      {
-        dom = _p->currentDomain;
-      }
+      dom = s->currentDomain;
     }
     else
     {
-      _p->generator.add_messages_domain(domain);
+      _p->addDomain(domain);
       dom = domain;
     }
 
@@ -241,9 +300,9 @@ namespace qi
       loc += ".UTF-8";
 
     if (domain.empty())
-      return boost::locale::translate(context, msg).str(_p->generator(loc));
+      return boost::locale::translate(context, msg).str(_p->locale(loc));
     else
-      return boost::locale::translate(context, msg).str(_p->generator(loc),
+      return boost::locale::translate(context, msg).str(_p->locale(loc),
                                                dom);
   }
 
@@ -280,6 +280,11 @@ namespace qi
   {
   }
 
+  GenericFunctionParameters::GenericFunctionParameters(AnyReferenceVector&& args)
+  :AnyReferenceVector(std::move(args))
+  {
+  }
+
   GenericFunctionParameters GenericFunctionParameters::copy(bool notFirst) const
   {
     GenericFunctionParameters result(*this);
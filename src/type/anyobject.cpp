@@ -4,7 +4,10 @@
 */
 
 #include <qi/anyobject.hpp>
+#include <qi/deadline.hpp>
+#include <qi/moveoncopy.hpp>
 #include <memory>
+#include <boost/optional.hpp>
 
 #ifdef _MSC_VER
 #  pragma warning( push )
@@ -191,40 +194,39 @@ inline void call(qi::Promise<AnyReference>& out,
 class MFunctorCall
 {
 public:
-  MFunctorCall(AnyFunction& func_, GenericFunctionParameters& params_,
+  MFunctorCall(AnyFunction func_, GenericFunctionParameters params_,
      qi::Promise<AnyReference>* out_, bool noCloneFirst_,
-     AnyObject context_, unsigned int methodId_, unsigned int callerId_, qi::os::timeval postTimestamp_)
+     AnyObject context_, unsigned int methodId_, unsigned int callerId_, qi::os::timeval postTimestamp_,
+     boost::optional<SteadyClockTimePoint> deadline_)
     : out(out_)
+    , params(std::move(params_))
+    , func(std::move(func_))
     , noCloneFirst(noCloneFirst_)
-    , context(context_)
+    , context(std::move(context_))
     , methodId(methodId_)
     , callerId(callerId_)
     , postTimestamp(postTimestamp_)
+    , deadline(deadline_)
   {
-    std::swap(this->func, func_);
-    std::swap((AnyReferenceVector&) params_,
-      (AnyReferenceVector&) this->params);
-  }
-  MFunctorCall(const MFunctorCall& b)
-  {
-    (*this) = b;
-  }
-  void operator = (const MFunctorCall& b)
-  {
-    // Implement move semantic on =
-    std::swap( (AnyReferenceVector&) params,
-      (AnyReferenceVector&) b.params);
-    std::swap(func, const_cast<MFunctorCall&>(b).func);
-    context = b.context;
-    methodId = b.methodId;
-    this->out = b.out;
-    noCloneFirst = b.noCloneFirst;
-    callerId = b.callerId;
-    this->postTimestamp = b.postTimestamp;
   }
+  // The parameters are owned by the call: it can be moved but not copied.
+  MFunctorCall(MFunctorCall&&) = default;
+  MFunctorCall& operator=(MFunctorCall&&) = default;
+  MFunctorCall(const MFunctorCall&) = delete;
+  MFunctorCall& operator=(const MFunctorCall&) = delete;
+
   void operator()()
   {
-    call(*out, context, params, methodId, func, callerId, postTimestamp);
+    if (deadline && SteadyClock::now() >= *deadline)
+      out->setError(deadlineExpiredError);
+    else
+    {
+      // The deadline of the caller propagates to the calls made by this one.
+      boost::optional<ScopedDeadline> scopedDeadline;
+      if (deadline)
+        scopedDeadline.emplace(*deadline);
+      call(*out, context, params, methodId, func, callerId, postTimestamp);
+    }
     params.destroy(noCloneFirst);
     delete out;
   }
@@ -236,6 +238,7 @@ public:
   unsigned int methodId;
   unsigned int callerId;
   qi::os::timeval postTimestamp;
+  boost::optional<SteadyClockTimePoint> deadline;
 };
 
 }
@@ -248,7 +251,8 @@ qi::Future<AnyReference> metaCall(ExecutionContext* el,
   unsigned int methodId,
   AnyFunction func, const GenericFunctionParameters& params, bool noCloneFirst,
   unsigned int callerId,
-  qi::os::timeval postTimestamp)
+  qi::os::timeval postTimestamp,
+  TaskPriority priority)
 {
   // Implement rules described in header
   bool sync = false;
@@ -268,8 +272,12 @@ qi::Future<AnyReference> metaCall(ExecutionContext* el,
   if (sync)
   {
     qi::Promise<AnyReference> out(FutureCallbackType_Sync);
-    call(out, context, params, methodId, func,
-         callerId ? callerId : qi::os::gettid(), postTimestamp);
+    const auto deadline = currentDeadline();
+    if (deadline && SteadyClock::now() >= *deadline)
+      out.setError(deadlineExpiredError);
+    else
+      call(out, context, params, methodId, func,
+           callerId ? callerId : qi::os::gettid(), postTimestamp);
     return out.future();
   }
   else
@@ -281,8 +289,11 @@ qi::Future<AnyReference> metaCall(ExecutionContext* el,
     GenericFunctionParameters pCopy = params.copy(noCloneFirst);
     qi::Future<AnyReference> result = out->future();
     qi::os::timeval t(qi::SystemClock::now().time_since_epoch());
-    el->post(MFunctorCall(func, pCopy, out.release(), noCloneFirst, context,
-                           methodId, callerId ? callerId : qi::os::gettid(), t));
+    auto call = makeMoveOnCopy(MFunctorCall(std::move(func), std::move(pCopy), out.release(),
+                                            noCloneFirst, std::move(context), methodId,
+                                            callerId ? callerId : qi::os::gettid(), t,
+                                            currentDeadline()));
+    el->post([call] { (*call)(); }, priority);
     return result;
   }
 }
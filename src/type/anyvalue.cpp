@@ -4,6 +4,66 @@
 */
 
 #include <boost/lexical_cast.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include <qi/anyvalue.hpp>
 #include <qi/anyobject.hpp>
+
+namespace qi
+{
+  namespace detail
+  {
+    namespace
+    {
+      struct InlineType
+      {
+        TypeInterface* type;
+        std::size_t size;
+      };
+
+      template <typename T>
+      InlineType inlineType()
+      {
+        static_assert(sizeof(T) <= sizeof(int64_t), "type too large to be stored inline");
+        InlineType result = { typeOf<T>(), sizeof(T) };
+        return result;
+      }
+    }
+
+    std::size_t inlineStorageSize(TypeInterface* type)
+    {
+      static const InlineType types[] = {
+        inlineType<bool>(),
+        inlineType<char>(),
+        inlineType<signed char>(),
+        inlineType<unsigned char>(),
+        inlineType<short>(),
+        inlineType<unsigned short>(),
+        inlineType<int>(),
+        inlineType<unsigned int>(),
+        inlineType<long>(),
+        inlineType<unsigned long>(),
+        inlineType<long long>(),
+        inlineType<unsigned long long>(),
+        inlineType<float>(),
+        inlineType<double>(),
+      };
+      for (const InlineType& t : types)
+        if (t.type == type)
+          return t.size;
+      return 0;
+    }
+  }
+
+  void AnyValue::moveInlineToHeap() const
+  {
+    // A const AnyValue may be exposed by several threads at once: only one of
+    // them moves the value.
+    static boost::mutex mutex;
+    boost::mutex::scoped_lock lock(mutex);
+    if (!isInline())
+      return;
+    AnyValue& self = const_cast<AnyValue&>(*this);
+    self._value = _type->clone(_value);
+  }
+}
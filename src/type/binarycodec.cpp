@@ -17,6 +17,7 @@
 #include <qi/types.hpp>
 #include <vector>
 #include <cstring>
+#include <limits>
 
 qiLogCategory("qitype.binarycoder");
 
@@ -184,6 +185,22 @@ namespace qi {
     }
   }
 
+  void BinaryDecoder::read(qi::StringView &s)
+  {
+    qi::uint32_t sz = 0;
+    read(sz);
+
+    s = StringView();
+    if (sz) {
+      s = bufferReader().readView(sz);
+      if (s.empty()) {
+        qiLogError() << "Read past end";
+        setStatus(Status::ReadPastEnd);
+        return;
+      }
+    }
+  }
+
   void BinaryDecoder::read(qi::Buffer &meta) {
     BufferReader& reader = bufferReader();
     if (reader.hasSubBuffer())
@@ -638,6 +655,14 @@ namespace qi {
 
       void visitString(char*, size_t)
       {
+        //when result is a view, refer to the decoded buffer instead of copying
+        static TypeInterface* tstringview = nullptr;
+        QI_ONCE(tstringview = qi::typeOf<StringView>());
+        if ((result.type() == tstringview) || (result.type()->info() == tstringview->info())) {
+          in.read(result.as<StringView>());
+          return;
+        }
+
         std::string s;
         in.read(s);
 
@@ -652,6 +677,68 @@ namespace qi {
         result.setString(s);
       }
 
+      // Reads a list of numbers in one copy if result is a std::vector<T>.
+      template <typename T>
+      bool readNumberList(qi::uint32_t size)
+      {
+        static TypeInterface* tvector;
+        QI_ONCE(tvector = qi::typeOf<std::vector<T> >());
+        if (result.type() != tvector && result.type()->info() != tvector->info())
+          return false;
+        const void* data = nullptr;
+        if (size <= std::numeric_limits<size_t>::max() / sizeof(T))
+          data = in.readRaw(size * sizeof(T));
+        if (!data)
+        {
+          in.setStatus(BinaryDecoder::Status::ReadPastEnd);
+          return true;
+        }
+        // Appended, as the generic path does.
+        std::vector<T>& values = result.as<std::vector<T> >();
+        const std::size_t old = values.size();
+        values.resize(old + size);
+        if (size)
+          std::memcpy(values.data() + old, data, size * sizeof(T));
+        return true;
+      }
+
+      bool readNumberList(TypeInterface* elementType, qi::uint32_t size)
+      {
+        // The serialized elements are contiguous and have the layout of
+        // the C++ type, only the identity of the vector type matters.
+        if (elementType->kind() == TypeKind_Int)
+        {
+          switch (static_cast<IntTypeInterface*>(elementType)->size())
+          {
+          case 1:
+            return readNumberList<int8_t>(size) || readNumberList<uint8_t>(size)
+                || readNumberList<char>(size);
+          case 2:
+            return readNumberList<int16_t>(size) || readNumberList<uint16_t>(size);
+          case 4:
+            return readNumberList<int32_t>(size) || readNumberList<uint32_t>(size);
+          case 8:
+            return readNumberList<int64_t>(size) || readNumberList<uint64_t>(size)
+                || readNumberList<long long>(size) || readNumberList<unsigned long long>(size);
+          default: // bool
+            return false;
+          }
+        }
+        if (elementType->kind() == TypeKind_Float)
+        {
+          switch (static_cast<FloatTypeInterface*>(elementType)->size())
+          {
+          case 4:
+            return readNumberList<float>(size);
+          case 8:
+            return readNumberList<double>(size);
+          default:
+            return false;
+          }
+        }
+        return false;
+      }
+
       void visitList(AnyIterator, AnyIterator)
       {
         TypeInterface* elementType = static_cast<ListTypeInterface*>(result.type())->elementType();
@@ -659,6 +746,8 @@ namespace qi {
         in.read(sz);
         if (in.status() != BinaryDecoder::Status::Ok)
           return;
+        if (readNumberList(elementType, sz))
+          return;
         for (unsigned i = 0; i < sz; ++i)
         {
           AnyReference v = deserialize(elementType, in, context, streamContext);
@@ -782,6 +871,14 @@ namespace qi {
 
       void visitRaw(AnyReference)
       {
+        //optimise when result is of type Buffer: read it in place
+        static TypeInterface* tbuffer = nullptr;
+        QI_ONCE(tbuffer = qi::typeOf<Buffer>());
+        if ((result.type() == tbuffer) || (result.type()->info() == tbuffer->info())) {
+          in.read(result.as<Buffer>());
+          return;
+        }
+
         Buffer b;
         in.read(b);
         result.setRaw((char*)b.data(), b.size());
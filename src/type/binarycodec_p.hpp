@@ -63,6 +63,8 @@ namespace qi {
     void read(float    &f);
     void read(double   &d);
     void read(std::string& i);
+    /// Does not copy the string, the view refers to the decoded buffer.
+    void read(qi::StringView& s);
 
     void read(qi::Buffer &buffer);
 
@@ -35,6 +35,7 @@ namespace qi
     using MethodMap = std::map<unsigned int, std::pair<AnyFunction, MetaCallType>>;
     SignalMap           signalMap;
     MethodMap           methodMap;
+    std::map<unsigned int, TaskPriority> methodPriority;
     MetaObject          meta;
     ObjectThreadingModel threadingModel;
 
@@ -154,6 +155,14 @@ namespace qi
     _p->methodMap[id] = std::make_pair(callable, threadingModel);
   }
 
+  void DynamicObject::setMethodPriority(unsigned int id, TaskPriority priority)
+  {
+    if (priority == TaskPriority::Normal)
+      _p->methodPriority.erase(id);
+    else
+      _p->methodPriority[id] = priority;
+  }
+
   void DynamicObject::setSignal(unsigned int id, SignalBase* signal)
   {
     _p->signalMap[id] = std::make_pair(signal, false);
@@ -272,8 +281,10 @@ namespace qi
     else
       p.push_back(AnyReference::from(this));
     p.insert(p.end(), params.begin(), params.end());
+    const auto priority = _p->methodPriority.find(method);
     return ::qi::metaCall(ec, _p->threadingModel,
-      i->second.second, callType, context, method, i->second.first, p);
+      i->second.second, callType, context, method, i->second.first, p, false, 0, qi::os::timeval(),
+      priority == _p->methodPriority.end() ? TaskPriority::Normal : priority->second);
   }
 
   qi::Future<void> DynamicObject::metaSetProperty(AnyObject context, unsigned int id, AnyValue val)
@@ -195,4 +195,9 @@ namespace qi
   {
     _p->_object->setThreadingModel(model);
   }
+
+  void DynamicObjectBuilder::setMethodPriority(unsigned int id, TaskPriority priority)
+  {
+    _p->_object->setMethodPriority(id, priority);
+  }
 }
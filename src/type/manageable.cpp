@@ -1,5 +1,7 @@
 #include <qi/type/detail/manageable.hpp>
 #include <qi/type/objecttypebuilder.hpp>
+#include <qi/eventloop.hpp>
+#include <qi/strand.hpp>
 #include "../type/signal_p.hpp"
 
 namespace qi
@@ -118,6 +120,16 @@ namespace qi
     _p->stats.clear();
   }
 
+  std::map<std::string, ExecutionStatistics> Manageable::executionStats() const
+  {
+    std::map<std::string, ExecutionStatistics> result;
+    if (auto strand = boost::dynamic_pointer_cast<Strand>(_p->executionContext))
+      result["strand"] = strand->statistics();
+    result["eventloop"] = getEventLoop()->statistics();
+    result["network"] = getNetworkEventLoop()->statistics();
+    return result;
+  }
+
   bool Manageable::isTraceEnabled() const
   {
     return _p->traceEnabled;
@@ -155,6 +167,7 @@ namespace qi
     builder.advertiseMethod("isTraceEnabled", &Manageable::isTraceEnabled, MetaCallType_Auto, id++);
     builder.advertiseMethod("enableTrace", &Manageable::enableTrace,       MetaCallType_Auto, id++);
     builder.advertiseSignal("traceObject", &Manageable::traceObject, id++);
+    builder.advertiseMethod("executionStats", &Manageable::executionStats, MetaCallType_Auto, id++);
     QI_ASSERT(id <= endId);
     const detail::ObjectTypeData& typeData = builder.typeData();
     *manageable::methodMap = typeData.methodMap;
@@ -100,6 +100,14 @@ namespace qi {
     _p->data.threadingModel = model;
   }
 
+  void ObjectTypeBuilderBase::setMethodPriority(unsigned int id, TaskPriority priority)
+  {
+    if (priority == TaskPriority::Normal)
+      _p->data.methodPriority.erase(id);
+    else
+      _p->data.methodPriority[id] = priority;
+  }
+
   const MetaObject& ObjectTypeBuilderBase::metaObject()
   {
     _p->metaObject._p->refreshCache();
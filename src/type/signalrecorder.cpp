@@ -0,0 +1,627 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/thread/mutex.hpp>
+#include <qi/async.hpp>
+#include <qi/binarycodec.hpp>
+#include <qi/log.hpp>
+#include <qi/path.hpp>
+#include <qi/scoped.hpp>
+#include <qi/signalrecorder.hpp>
+
+qiLogCategory("qi.signalrecorder");
+
+namespace bfs = boost::filesystem;
+namespace bip = boost::interprocess;
+
+namespace qi
+{
+  const qi::uint32_t SignalRecorder::fileMagic;
+  const qi::uint32_t SignalRecorder::fileVersion;
+  const qi::uint32_t SignalRecorder::channelDeclaration;
+  const std::size_t SignalRecorder::defaultSegmentSize;
+
+namespace
+{
+  struct SegmentHeader
+  {
+    qi::uint32_t magic;
+    qi::uint32_t version;
+    qi::int64_t startTime;
+  };
+  static_assert(sizeof(SegmentHeader) == 16, "unexpected segment header size");
+
+  struct RecordHeader
+  {
+    qi::uint32_t size;
+    qi::uint32_t channel;
+    qi::int64_t time;
+  };
+  static_assert(sizeof(RecordHeader) == 16, "unexpected record header size");
+
+  const char segmentExtension[] = ".qibag";
+
+  // Replaying as fast as possible yields to the event loop after this many records.
+  const std::size_t maxRecordsPerTask = 1000;
+
+  std::size_t alignedRecordSize(std::size_t payloadSize)
+  {
+    return (sizeof(RecordHeader) + payloadSize + 7) & ~static_cast<std::size_t>(7);
+  }
+
+  bfs::path segmentPath(const bfs::path& directory, std::size_t number)
+  {
+    std::ostringstream name;
+    name << "segment-" << std::setw(6) << std::setfill('0') << number << segmentExtension;
+    return directory / name.str();
+  }
+
+  std::vector<bfs::path> listSegments(const bfs::path& directory)
+  {
+    std::vector<bfs::path> segments;
+    boost::system::error_code ec;
+    for (bfs::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec))
+    {
+      if (it->path().extension() == segmentExtension)
+        segments.push_back(it->path());
+    }
+    std::sort(segments.begin(), segments.end());
+    return segments;
+  }
+
+  /// Copies the buffer as it is serialized on the network: the sub-buffers after their size.
+  void copyBuffer(const Buffer& buffer, char* out)
+  {
+    const char* data = static_cast<const char*>(buffer.data());
+    std::size_t begin = 0;
+    for (const auto& sub : buffer.subBuffers())
+    {
+      const std::size_t end = sub.first + sizeof(Buffer::size_type);
+      std::memcpy(out, data + begin, end - begin);
+      out += end - begin;
+      begin = end;
+      std::memcpy(out, sub.second.data(), sub.second.size());
+      out += sub.second.size();
+    }
+    std::memcpy(out, data + begin, buffer.size() - begin);
+  }
+
+  std::vector<TypeInterface*> memberTypes(const Signature& signature)
+  {
+    TypeInterface* type = TypeInterface::fromSignature(signature);
+    if (!type || type->kind() != TypeKind_Tuple)
+      throw std::runtime_error("Cannot record arguments of signature " + signature.toString());
+    return static_cast<StructTypeInterface*>(type)->memberTypes();
+  }
+}
+
+namespace detail
+{
+  /// A segment file, mapped in memory.
+  class BagSegment
+  {
+  public:
+    BagSegment(const bfs::path& path, bip::mode_t mode)
+      : path(path)
+      , file(path.string(qi::unicodeFacet()).c_str(), mode)
+      , region(file, mode)
+      , reserved(sizeof(SegmentHeader))
+    {
+    }
+
+    char* data() const { return static_cast<char*>(region.get_address()); }
+    std::size_t size() const { return region.get_size(); }
+
+    const bfs::path path;
+    bip::file_mapping file;
+    bip::mapped_region region;
+    /// The end of the space reserved by the writers.
+    std::atomic<std::size_t> reserved;
+  };
+
+  class SignalRecorderPrivate
+  {
+  public:
+    SignalRecorderPrivate(const bfs::path& directory, std::size_t segmentSize)
+      : recordCount(0)
+      , droppedCount(0)
+      , _directory(directory)
+      , _segmentSize(segmentSize)
+      , _start(SteadyClock::now())
+      , _startTime(boost::chrono::duration_cast<NanoSeconds>(
+                     SystemClock::now().time_since_epoch()).count())
+      , _current(nullptr)
+      , _channelCount(0)
+    {
+      if (_segmentSize < sizeof(SegmentHeader) + sizeof(RecordHeader))
+        throw std::runtime_error("The segments of a bag are too small");
+      bfs::create_directories(_directory);
+      for (const bfs::path& segment : listSegments(_directory))
+        bfs::remove(segment);
+      boost::mutex::scoped_lock lock(_segmentsMutex);
+      addSegment();
+    }
+
+    ~SignalRecorderPrivate()
+    {
+      // Called when no writer is left: everything reserved is written.
+      BagSegment* last = _current.load();
+      const std::size_t used = std::min(last->reserved.load(), last->size());
+      const bfs::path path = last->path;
+      _segments.clear();
+      boost::system::error_code ec;
+      bfs::resize_file(path, used, ec);
+      if (ec)
+        qiLogWarning() << "Cannot truncate " << path.string(qi::unicodeFacet()) << ": " << ec.message();
+    }
+
+    unsigned int declare(const std::string& name, const Signature& signature)
+    {
+      boost::mutex::scoped_lock lock(_channelsMutex);
+      const qi::uint32_t channel = _channelCount;
+      Buffer payload;
+      encodeBinary(&payload, channel);
+      encodeBinary(&payload, name);
+      encodeBinary(&payload, signature.toString());
+      if (!append(SignalRecorder::channelDeclaration, SteadyClock::now(), payload))
+        throw std::runtime_error("Cannot declare the channel " + name);
+      ++_channelCount;
+      return channel;
+    }
+
+    /// Serializes and appends an emission, without throwing.
+    /// Arguments that are not of the given types are converted first.
+    void record(unsigned int channel, const AnyReferenceVector& args,
+                const std::vector<TypeInterface*>* types)
+    {
+      const SteadyClockTimePoint time = SteadyClock::now();
+      try
+      {
+        if (types && types->size() != args.size())
+          throw std::runtime_error("unexpected number of arguments");
+        Buffer payload;
+        for (std::size_t i = 0; i < args.size(); ++i)
+        {
+          if (!types || args[i].type() == (*types)[i])
+          {
+            encodeBinary(&payload, args[i]);
+            continue;
+          }
+          std::pair<AnyReference, bool> converted = args[i].convert((*types)[i]);
+          if (!converted.first.type())
+            throw std::runtime_error("cannot convert argument " + args[i].signature().toString()
+                                     + " to " + (*types)[i]->signature().toString());
+          auto destroyConverted = scoped([&] { if (converted.second) converted.first.destroy(); });
+          encodeBinary(&payload, converted.first);
+        }
+        if (append(channel, time, payload))
+          return;
+      }
+      catch (const std::exception& e)
+      {
+        qiLogWarning() << "Cannot record an emission on channel " << channel << ": " << e.what();
+      }
+      ++droppedCount;
+    }
+
+    bool append(qi::uint32_t channel, SteadyClockTimePoint time, const Buffer& payload)
+    {
+      const std::size_t payloadSize = payload.totalSize();
+      const std::size_t size = alignedRecordSize(payloadSize);
+      if (sizeof(SegmentHeader) + size > _segmentSize)
+      {
+        qiLogWarning() << "An emission of " << payloadSize << " bytes does not fit in a segment";
+        return false;
+      }
+      // The size is stored plus one, so that an empty payload is still a committed record.
+      RecordHeader header{static_cast<qi::uint32_t>(payloadSize + 1), channel,
+                          boost::chrono::duration_cast<NanoSeconds>(time - _start).count()};
+      while (true)
+      {
+        BagSegment* segment = _current.load(std::memory_order_acquire);
+        const std::size_t offset = segment->reserved.fetch_add(size);
+        if (offset + size > segment->size())
+        {
+          nextSegment(segment);
+          continue;
+        }
+        // The size is written last: a size field of 0 marks the end of the segment.
+        char* record = segment->data() + offset;
+        copyBuffer(payload, record + sizeof(RecordHeader));
+        std::memcpy(record + sizeof(header.size), &header.channel,
+                    sizeof(RecordHeader) - sizeof(header.size));
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(record, &header.size, sizeof(header.size));
+        if (channel != SignalRecorder::channelDeclaration)
+          ++recordCount;
+        return true;
+      }
+    }
+
+    void flush()
+    {
+      boost::mutex::scoped_lock lock(_segmentsMutex);
+      for (const auto& segment : _segments)
+        segment->region.flush(0, 0, false);
+    }
+
+    std::atomic<std::size_t> recordCount;
+    std::atomic<std::size_t> droppedCount;
+
+  private:
+    /// Replaces the full segment, unless another writer already did.
+    void nextSegment(BagSegment* full)
+    {
+      boost::mutex::scoped_lock lock(_segmentsMutex);
+      if (_current.load() != full)
+        return;
+      addSegment();
+      // Writers still copying in the full segment keep it mapped until the recorder is destroyed.
+      full->region.flush();
+    }
+
+    void addSegment()
+    {
+      const bfs::path path = segmentPath(_directory, _segments.size());
+      {
+        std::ofstream file(path.string(qi::unicodeFacet()).c_str(), std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+          throw std::runtime_error("Cannot create " + path.string(qi::unicodeFacet()));
+      }
+      bfs::resize_file(path, _segmentSize);
+      std::unique_ptr<BagSegment> segment(new BagSegment(path, bip::read_write));
+      const SegmentHeader header{SignalRecorder::fileMagic, SignalRecorder::fileVersion, _startTime};
+      std::memcpy(segment->data(), &header, sizeof(header));
+      _current.store(segment.get(), std::memory_order_release);
+      _segments.push_back(std::move(segment));
+    }
+
+    const bfs::path _directory;
+    const std::size_t _segmentSize;
+    const SteadyClockTimePoint _start;
+    const qi::int64_t _startTime;
+
+    boost::mutex _segmentsMutex;
+    std::vector<std::unique_ptr<BagSegment>> _segments;
+    std::atomic<BagSegment*> _current;
+
+    boost::mutex _channelsMutex;
+    qi::uint32_t _channelCount;
+  };
+
+  class SignalPlayerPrivate
+  {
+  public:
+    struct Entry
+    {
+      NanoSeconds time;
+      qi::uint32_t channel;
+      const char* payload;
+      qi::uint32_t size;
+    };
+
+    explicit SignalPlayerPrivate(const bfs::path& directory)
+      : startTime(NanoSeconds::zero())
+    {
+      const std::vector<bfs::path> paths = listSegments(directory);
+      if (paths.empty())
+        throw std::runtime_error("No bag in " + directory.string(qi::unicodeFacet()));
+      for (const bfs::path& path : paths)
+      {
+        segments.emplace_back(new BagSegment(path, bip::read_only));
+        load(*segments.back());
+      }
+      std::sort(channels.begin(), channels.end(),
+                [](const SignalPlayer::Channel& a, const SignalPlayer::Channel& b) { return a.id < b.id; });
+      // Emissions from several threads may be recorded slightly out of order.
+      std::stable_sort(entries.begin(), entries.end(),
+                       [](const Entry& a, const Entry& b) { return a.time < b.time; });
+    }
+
+    /// The decoded arguments, as a tuple.
+    AnyValue decode(const Entry& entry) const
+    {
+      auto type = types.find(entry.channel);
+      if (type == types.end())
+        throw std::runtime_error("Undeclared channel " + std::to_string(entry.channel));
+      Buffer buffer;
+      buffer.write(entry.payload, entry.size);
+      BufferReader reader(buffer);
+      AnyReference value(type->second);
+      value = decodeBinary(&reader, value);
+      return AnyValue(value, false, true);
+    }
+
+    void emit(const Entry& entry) const
+    {
+      auto target = targets.find(entry.channel);
+      if (target == targets.end())
+        return;
+      AnyValue args = decode(entry);
+      target->second(GenericFunctionParameters(args.asReference().asTupleValuePtr()));
+    }
+
+    std::vector<std::unique_ptr<BagSegment>> segments;
+    std::vector<SignalPlayer::Channel> channels;
+    std::map<unsigned int, TypeInterface*> types;
+    std::vector<Entry> entries;
+    std::map<unsigned int, std::function<void(const GenericFunctionParameters&)>> targets;
+    SystemClockTimePoint startTime;
+
+  private:
+    void load(const BagSegment& segment)
+    {
+      const std::string path = segment.path.string(qi::unicodeFacet());
+      SegmentHeader header;
+      if (segment.size() < sizeof(header))
+        throw std::runtime_error(path + " is not a bag segment");
+      std::memcpy(&header, segment.data(), sizeof(header));
+      if (header.magic != SignalRecorder::fileMagic)
+        throw std::runtime_error(path + " is not a bag segment");
+      if (header.version != SignalRecorder::fileVersion)
+        throw std::runtime_error(path + " has an unsupported bag version");
+      startTime = SystemClockTimePoint(NanoSeconds(header.startTime));
+
+      std::size_t offset = sizeof(header);
+      RecordHeader record;
+      while (offset + sizeof(record) <= segment.size())
+      {
+        std::memcpy(&record, segment.data() + offset, sizeof(record));
+        if (record.size == 0)
+          break;
+        const qi::uint32_t payloadSize = record.size - 1;
+        if (offset + sizeof(record) + payloadSize > segment.size())
+          break;
+        const Entry entry{NanoSeconds(record.time), record.channel,
+                          segment.data() + offset + sizeof(record), payloadSize};
+        if (record.channel == SignalRecorder::channelDeclaration)
+          declare(entry);
+        else
+          entries.push_back(entry);
+        offset += alignedRecordSize(payloadSize);
+      }
+    }
+
+    void declare(const Entry& entry)
+    {
+      Buffer buffer;
+      buffer.write(entry.payload, entry.size);
+      BufferReader reader(buffer);
+      qi::uint32_t id;
+      std::string name;
+      std::string signature;
+      decodeBinary(&reader, &id);
+      decodeBinary(&reader, &name);
+      decodeBinary(&reader, &signature);
+      channels.push_back(SignalPlayer::Channel{id, name, Signature(signature)});
+      if (TypeInterface* type = TypeInterface::fromSignature(Signature(signature)))
+        types[id] = type;
+      else
+        qiLogWarning() << "Channel " << name << " has an unknown signature " << signature;
+    }
+  };
+
+  struct Playback
+  {
+    Playback(double speed, NanoSeconds firstTime)
+      : finished(std::make_shared<std::atomic<bool>>(false))
+      , promise(cancelUnlessFinished(finished))
+      , speed(speed)
+      , start(SteadyClock::now())
+      , firstTime(firstTime)
+    {
+    }
+
+    static Promise<void> cancelUnlessFinished(std::shared_ptr<std::atomic<bool>> finished)
+    {
+      return Promise<void>([finished](Promise<void> promise) {
+        if (!finished->exchange(true))
+          promise.setCanceled();
+      });
+    }
+
+    /// Set by the first of the cancellation and the end of the playback.
+    std::shared_ptr<std::atomic<bool>> finished;
+    Promise<void> promise;
+    const double speed;
+    const SteadyClockTimePoint start;
+    const NanoSeconds firstTime;
+  };
+}
+
+  SignalRecorder::SignalRecorder(const std::string& directory, std::size_t segmentSize)
+    : _p(std::make_shared<detail::SignalRecorderPrivate>(
+           bfs::path(directory, qi::unicodeFacet()), segmentSize))
+  {
+  }
+
+  SignalRecorder::~SignalRecorder()
+  {
+    for (auto& link : _links)
+    {
+      Future<void> disconnected = link.first.disconnect(link.second).async();
+      if (disconnected.wait() == FutureState_FinishedWithError)
+        qiLogWarning() << "Cannot stop recording: " << disconnected.error();
+    }
+    for (auto& connection : _signalLinks)
+    {
+      // Signals destroyed before the recorder have already dropped their subscriber.
+      if (auto subscribed = connection.subscribed.lock())
+        connection.signal->disconnect(connection.link);
+    }
+    // Emissions being recorded keep the private alive until they are written.
+  }
+
+  unsigned int SignalRecorder::record(AnyObject object, const std::string& signalOrPropertyName,
+                                      const std::string& channelName)
+  {
+    const MetaObject& metaObject = object.metaObject();
+    std::vector<TypeInterface*> types;
+    const int propertyId = metaObject.propertyId(signalOrPropertyName);
+    if (propertyId >= 0)
+      types = memberTypes("(" + metaObject.property(propertyId)->signature().toString() + ")");
+    else if (const MetaSignal* signal = metaObject.signal(signalOrPropertyName))
+      types = memberTypes(signal->parametersSignature());
+    else
+      throw std::runtime_error("No signal or property named " + signalOrPropertyName);
+
+    const unsigned int channel = _p->declare(
+          channelName.empty() ? signalOrPropertyName : channelName,
+          makeTupleType(types)->signature());
+    std::weak_ptr<detail::SignalRecorderPrivate> weakPrivate = _p;
+    const SignalLink link = object.connect(
+          signalOrPropertyName,
+          SignalSubscriber(AnyFunction::fromDynamicFunction([weakPrivate, channel, types](const AnyReferenceVector& args)
+    {
+      if (auto p = weakPrivate.lock())
+        p->record(channel, args, &types);
+      return AnyReference();
+    }), MetaCallType_Direct));
+    _links.emplace_back(object, link);
+    return channel;
+  }
+
+  unsigned int SignalRecorder::addChannel(const std::string& name, const std::vector<TypeInterface*>& types)
+  {
+    return _p->declare(name, makeTupleType(types)->signature());
+  }
+
+  void SignalRecorder::write(detail::SignalRecorderPrivate& p, unsigned int channel,
+                             const AnyReferenceVector& args)
+  {
+    p.record(channel, args, nullptr);
+  }
+
+  void SignalRecorder::flush()
+  {
+    _p->flush();
+  }
+
+  std::size_t SignalRecorder::recordCount() const
+  {
+    return _p->recordCount.load();
+  }
+
+  std::size_t SignalRecorder::droppedCount() const
+  {
+    return _p->droppedCount.load();
+  }
+
+  SignalPlayer::SignalPlayer(const std::string& directory)
+    : _p(new detail::SignalPlayerPrivate(bfs::path(directory, qi::unicodeFacet())))
+  {
+  }
+
+  SignalPlayer::~SignalPlayer()
+  {
+    destroy();
+  }
+
+  const std::vector<SignalPlayer::Channel>& SignalPlayer::channels() const
+  {
+    return _p->channels;
+  }
+
+  SystemClockTimePoint SignalPlayer::startTime() const
+  {
+    return _p->startTime;
+  }
+
+  std::size_t SignalPlayer::recordCount() const
+  {
+    return _p->entries.size();
+  }
+
+  SignalPlayer::Record SignalPlayer::record(std::size_t index) const
+  {
+    if (index >= _p->entries.size())
+    {
+      std::stringstream message;
+      message << "index " << index << " is out of range";
+      throw std::runtime_error(message.str());
+    }
+    const auto& entry = _p->entries[index];
+    Record record{entry.time, entry.channel, std::vector<AnyValue>()};
+    AnyValue args = _p->decode(entry);
+    for (const AnyReference& arg : args.asReference().asTupleValuePtr())
+      record.args.emplace_back(arg, true, true);
+    return record;
+  }
+
+  std::size_t SignalPlayer::seek(NanoSeconds time) const
+  {
+    const auto& entries = _p->entries;
+    return std::lower_bound(entries.begin(), entries.end(), time,
+                            [](const detail::SignalPlayerPrivate::Entry& entry, NanoSeconds t) {
+                              return entry.time < t;
+                            }) - entries.begin();
+  }
+
+  void SignalPlayer::setTarget(unsigned int channel, SignalBase& signal)
+  {
+    _p->targets[channel] = [&signal](const GenericFunctionParameters& args) {
+      signal.trigger(args, MetaCallType_Direct);
+    };
+  }
+
+  void SignalPlayer::setTarget(unsigned int channel, AnyObject object, const std::string& signalName)
+  {
+    _p->targets[channel] = [object, signalName](const GenericFunctionParameters& args) {
+      object.metaPost(signalName, args);
+    };
+  }
+
+  Future<void> SignalPlayer::play(double speed, std::size_t from)
+  {
+    const auto& entries = _p->entries;
+    auto playback = std::make_shared<detail::Playback>(
+          speed, from < entries.size() ? entries[from].time : NanoSeconds::zero());
+    playFrom(playback, from);
+    return playback->promise.future();
+  }
+
+  void SignalPlayer::playFrom(std::shared_ptr<detail::Playback> playback, std::size_t index)
+  {
+    const auto& entries = _p->entries;
+    for (std::size_t emitted = 0; index < entries.size(); ++index, ++emitted)
+    {
+      if (*playback->finished)
+        return;
+      if (playback->speed > 0)
+      {
+        const SteadyClockTimePoint due = playback->start + NanoSeconds(static_cast<qi::int64_t>(
+              (entries[index].time - playback->firstTime).count() / playback->speed));
+        if (due > SteadyClock::now())
+        {
+          asyncAt(track([=] { playFrom(playback, index); }, this), due);
+          return;
+        }
+      }
+      else if (emitted == maxRecordsPerTask)
+      {
+        async(track([=] { playFrom(playback, index); }, this));
+        return;
+      }
+
+      try
+      {
+        _p->emit(entries[index]);
+      }
+      catch (const std::exception& e)
+      {
+        qiLogWarning() << "Cannot replay record " << index << ": " << e.what();
+      }
+    }
+    if (!playback->finished->exchange(true))
+      playback->promise.setValue(nullptr);
+  }
+}
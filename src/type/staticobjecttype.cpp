@@ -86,7 +86,10 @@ StaticObjectTypeBase::metaCall(void* instance, AnyObject context, unsigned int m
   p2.push_back(self);
   p2.insert(p2.end(), params.begin(), params.end());
 
-  return ::qi::metaCall(ec, _data.threadingModel, methodThreadingModel, callType, context, methodId, method, p2, true);
+  const auto priority = _data.methodPriority.find(methodId);
+  return ::qi::metaCall(ec, _data.threadingModel, methodThreadingModel, callType, context, methodId, method, p2, true,
+                        0, qi::os::timeval(),
+                        priority == _data.methodPriority.end() ? TaskPriority::Normal : priority->second);
 }
 
 ExecutionContext* StaticObjectTypeBase::getExecutionContext(
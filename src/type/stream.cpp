@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/make_shared.hpp>
+
+#include <qi/log.hpp>
+#include <qi/path.hpp>
+#include <qi/stream.hpp>
+
+qiLogCategory("qitype.stream");
+
+namespace qi
+{
+  QI_REGISTER_OBJECT(Stream, read);
+
+  Stream::Stream(ChunkSource source)
+    : _source(std::move(source))
+    , _ended(false)
+  {
+  }
+
+  Buffer Stream::read(std::size_t maxSize)
+  {
+    if (_ended || maxSize == 0)
+      return Buffer();
+    Buffer chunk = _source(maxSize);
+    if (chunk.size() > maxSize)
+      throw std::runtime_error("Stream source produced a chunk larger than requested");
+    if (chunk.size() == 0)
+      _ended = true;
+    return chunk;
+  }
+
+  Object<Stream> Stream::fromBuffer(const Buffer& buffer)
+  {
+    // Copied once: copies of a Buffer are deep, the copies of the reader share this one.
+    auto data = boost::make_shared<const Buffer>(buffer);
+    auto offset = boost::make_shared<std::size_t>(0);
+    return Object<Stream>(new Stream([data, offset](std::size_t maxSize) {
+      const std::size_t size = std::min(maxSize, data->size() - *offset);
+      Buffer chunk;
+      if (size)
+        chunk.write(static_cast<const char*>(data->data()) + *offset, size);
+      *offset += size;
+      return chunk;
+    }));
+  }
+
+  Object<Stream> Stream::fromFile(const std::string& path)
+  {
+    auto file = boost::make_shared<boost::filesystem::ifstream>(
+        qi::Path(path).bfsPath(), std::ios::in | std::ios::binary);
+    if (!file->is_open())
+      throw std::runtime_error("Cannot open " + path + " for streaming");
+    file->seekg(0, std::ios::end);
+    auto remaining = boost::make_shared<std::size_t>(static_cast<std::size_t>(file->tellg()));
+    file->seekg(0, std::ios::beg);
+    qiLogVerbose() << "Streaming " << *remaining << " bytes from " << path;
+
+    return Object<Stream>(new Stream([file, remaining, path](std::size_t maxSize) {
+      const std::size_t size = std::min(maxSize, *remaining);
+      Buffer chunk;
+      if (!size)
+        return chunk;
+      file->read(static_cast<char*>(chunk.reserve(size)), size);
+      if (static_cast<std::size_t>(file->gcount()) != size)
+        throw std::runtime_error("Cannot read " + path);
+      *remaining -= size;
+      return chunk;
+    }));
+  }
+
+  namespace
+  {
+    void readNextChunk(AnyObject stream,
+                       boost::function<void (const Buffer&)> onChunk,
+                       std::size_t chunkSize,
+                       Promise<void> promise)
+    {
+      stream.async<Buffer>("read", chunkSize).connect(
+          [stream, onChunk, chunkSize, promise](Future<Buffer> fut) mutable {
+        if (fut.hasError())
+        {
+          promise.setError(fut.error());
+          return;
+        }
+        if (fut.isCanceled())
+        {
+          promise.setCanceled();
+          return;
+        }
+        const Buffer& chunk = fut.value();
+        if (chunk.size() == 0)
+        {
+          promise.setValue(nullptr);
+          return;
+        }
+        try
+        {
+          onChunk(chunk);
+        }
+        catch (const std::exception& e)
+        {
+          promise.setError(e.what());
+          return;
+        }
+        readNextChunk(stream, onChunk, chunkSize, promise);
+      });
+    }
+  }
+
+  Future<void> readStream(AnyObject stream,
+                          boost::function<void (const Buffer&)> onChunk,
+                          std::size_t chunkSize)
+  {
+    Promise<void> promise;
+    readNextChunk(stream, onChunk, chunkSize, promise);
+    return promise.future();
+  }
+}
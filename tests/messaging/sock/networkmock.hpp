@@ -173,6 +173,8 @@ namespace mock
       ssl_socket_type(io_service_type& io, ssl_context_type) : _io(&io) {}
       io_service_type& get_io_service() {return *_io;}
       void set_verify_mode(ssl_verify_mode_type) {}
+      using native_handle_type = void*;
+      native_handle_type native_handle() {return {};}
 
       using _anyAsyncHandshaker = std::function<void (handshake_type, _anyHandler)>;
       static _anyAsyncHandshaker async_handshake;
@@ -249,6 +251,8 @@ namespace mock
 
     using H = ssl_socket_type::lowest_layer_type::_native_handle;
     static void setSocketNativeOptions(H, int) {}
+    static void sslEnableSessionResumption(ssl_context_type&) {}
+    static void sslResumeSession(ssl_socket_type&) {}
 
     struct _mutable_buffer_sequence
     {
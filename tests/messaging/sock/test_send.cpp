@@ -73,6 +73,36 @@ TEST(NetSendMessage, SuccessSingleMessage)
   ASSERT_EQ(fut.value().second, &sentMsg);
 }
 
+TEST(NetSendMessage, CoalescedBuffersHoldTheSameBytes)
+{
+  using namespace qi;
+  using namespace qi::sock;
+  using N = mock::Network;
+  const std::vector<char> bigData(sslMaxRecordSize + 1, 'b');
+  Buffer sub;
+  sub.write(bigData.data(), bigData.size());
+  Buffer buf;
+  buf.write("abc", 3);
+  buf.addSubBuffer(sub);
+  buf.write("def", 3);
+  Message msg;
+  msg.setBuffer(buf);
+
+  auto concat = [](const std::vector<N::_const_buffer_sequence>& buffers) {
+    std::string res;
+    for (const auto& b : buffers)
+      res.append(b.begin, b.end);
+    return res;
+  };
+  std::vector<char> storage;
+  const auto coalesced = makeCoalescedBuffers<N>(msg, storage);
+  ASSERT_EQ(concat(makeBuffers<N>(msg)), concat(coalesced));
+  // The header, "abc" and the subbuffer's size are coalesced, the subbuffer
+  // is big enough to be sent in place.
+  ASSERT_EQ(3u, coalesced.size());
+  ASSERT_EQ(static_cast<const void*>(sub.data()), static_cast<const void*>(coalesced[1].begin));
+}
+
 TEST(NetSendMessage, SuccessMultipleMessage)
 {
   using namespace qi;
@@ -329,3 +359,66 @@ TEST(NetSendMessageEnqueue, MultipleSendsFromMultipleThreadsAsio)
   // Allow detached thread to finish.
   for (auto& t: sendThreads) t.join();
 }
+
+// Messages queued while a write is pending, or enqueued together, are written
+// with a single write.
+TEST(NetSendMessageEnqueue, GathersQueuedMessagesInOneWrite)
+{
+  using namespace qi;
+  using namespace qi::sock;
+  using N = mock::Network;
+  auto concat = [](const std::vector<N::_const_buffer_sequence>& buffers) {
+    std::string res;
+    for (const auto& b : buffers)
+      res.append(b.begin, b.end);
+    return res;
+  };
+  std::vector<std::string> writes;
+  std::vector<N::_anyTransferHandler> pendingWriteConts;
+  auto _ = scopedSetAndRestore(
+    N::_async_write_next_layer,
+    [&](SslSocket<N>::next_layer_type&, const std::vector<N::_const_buffer_sequence>& buffers,
+        N::_anyTransferHandler writeCont) {
+      writes.push_back(concat(buffers));
+      pendingWriteConts.push_back(writeCont);
+    }
+  );
+  IoService<N> io;
+  SslContext<N> context;
+  auto socket = makeSslSocketPtr<N>(io, context);
+  SendMessageEnqueue<N, SslSocketPtr<N>> send{socket};
+
+  std::vector<Message> msgs(4);
+  std::string expectedBytes;
+  for (std::size_t i = 0; i < msgs.size(); ++i)
+  {
+    msgs[i].setId(static_cast<unsigned int>(i));
+    expectedBytes += concat(makeBuffers<N>(msgs[i]));
+  }
+  std::vector<unsigned int> sentIds;
+  auto onSent = [&](ErrorCode<N>, std::list<Message>::const_iterator itMsg) {
+    sentIds.push_back(itMsg->id());
+    return true;
+  };
+
+  // The first message is written right away, the others wait for it.
+  send(Message{msgs[0]}, SslEnabled{false}, onSent);
+  send(Message{msgs[1]}, SslEnabled{false}, onSent);
+  send(Message{msgs[2]}, SslEnabled{false}, onSent);
+  send(Message{msgs[3]}, SslEnabled{false}, onSent);
+  ASSERT_EQ(1u, writes.size());
+  auto writeCont = pendingWriteConts.back();
+  writeCont(success<ErrorCode<N>>(), 0u);
+  ASSERT_EQ(2u, writes.size());
+  ASSERT_EQ(expectedBytes, writes[0] + writes[1]);
+  pendingWriteConts.back()(success<ErrorCode<N>>(), 0u);
+  ASSERT_EQ((std::vector<unsigned int>{0, 1, 2, 3}), sentIds);
+
+  // Messages enqueued together go in a single write.
+  sentIds.clear();
+  send.sendAll(std::vector<Message>(msgs), SslEnabled{false}, onSent);
+  ASSERT_EQ(3u, writes.size());
+  ASSERT_EQ(expectedBytes, writes[2]);
+  pendingWriteConts.back()(success<ErrorCode<N>>(), 0u);
+  ASSERT_EQ((std::vector<unsigned int>{0, 1, 2, 3}), sentIds);
+}
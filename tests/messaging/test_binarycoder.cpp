@@ -267,6 +267,81 @@ TEST(TestBind, serializeString)
   EXPECT_EQ(s, s2);
 }
 
+TEST(TestBind, deserializeStringView)
+{
+  qi::Buffer      buf;
+  qi::BufferReader bufr(buf);
+  std::string s = "1.25";
+  qi::encodeBinary(&buf, s);
+
+  qi::StringView view;
+  {
+    qi::Buffer copy(buf);
+    qi::BufferReader copyReader(copy);
+    qi::decodeBinary(&copyReader, &view);
+  } // the view shares the ownership of the decoded buffer
+
+  EXPECT_EQ(s, view.str());
+}
+
+TEST(TestBind, deserializeNumberLists)
+{
+  qi::Buffer buf;
+  std::vector<int> ints;
+  for (int i = 0; i < 1000; ++i)
+    ints.push_back(i - 500);
+  std::vector<double> doubles;
+  doubles.push_back(1.25);
+  doubles.push_back(-3.5);
+  qi::encodeBinary(&buf, ints);
+  qi::encodeBinary(&buf, doubles);
+
+  qi::BufferReader bufr(buf);
+  std::vector<int> ints2;
+  std::vector<double> doubles2;
+  qi::decodeBinary(&bufr, &ints2);
+  qi::decodeBinary(&bufr, &doubles2);
+  EXPECT_EQ(ints, ints2);
+  EXPECT_EQ(doubles, doubles2);
+
+  // Lists of numbers decoded as generic values take the generic path.
+  qi::BufferReader genericReader(buf);
+  qi::AnyValue generic(qi::TypeInterface::fromSignature(qi::Signature("[i]")));
+  qi::decodeBinary(&genericReader, generic.asReference());
+  EXPECT_EQ(ints, generic.to<std::vector<int> >());
+}
+
+TEST(TestBind, deserializeNumberListAppends)
+{
+  qi::Buffer buf;
+  qi::encodeBinary(&buf, std::vector<int>{3, 4});
+
+  // Like the generic path, the decoded elements are appended to the list.
+  qi::BufferReader bufr(buf);
+  std::vector<int> ints{1, 2};
+  qi::decodeBinary(&bufr, &ints);
+  EXPECT_EQ((std::vector<int>{1, 2, 3, 4}), ints);
+
+  qi::BufferReader genericReader(buf);
+  qi::AnyValue generic(qi::TypeInterface::fromSignature(qi::Signature("[i]")));
+  generic.asReference().append(qi::AnyReference::from(1));
+  generic.asReference().append(qi::AnyReference::from(2));
+  qi::decodeBinary(&genericReader, generic.asReference());
+  EXPECT_EQ((std::vector<int>{1, 2, 3, 4}), generic.to<std::vector<int> >());
+}
+
+TEST(TestBind, deserializeTruncatedNumberList)
+{
+  qi::Buffer buf;
+  qi::encodeBinary(&buf, std::vector<int>(10, 42));
+  qi::Buffer truncated;
+  truncated.write(buf.data(), buf.size() - 1);
+
+  qi::BufferReader bufr(truncated);
+  std::vector<int> ints;
+  EXPECT_ANY_THROW(qi::decodeBinary(&bufr, &ints));
+}
+
 TEST(TestBind, serializeStrings)
 {
   qi::Buffer      buf;
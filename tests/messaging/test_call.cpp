@@ -5,14 +5,19 @@
  *  Copyright (c) 2012 Aldebaran Robotics. All rights reserved.
  */
 
+#include <atomic>
 #include <list>
+#include <mutex>
+#include <thread>
 
 #include <gtest/gtest.h>
 
 #include <boost/assign/list_of.hpp>
 
 #include <qi/application.hpp>
+#include <qi/deadline.hpp>
 #include <qi/eventloop.hpp>
+#include <qi/messaging/callbatch.hpp>
 #include <qi/anyobject.hpp>
 #include <qi/type/dynamicobject.hpp>
 #include <qi/type/dynamicobjectbuilder.hpp>
@@ -1057,6 +1062,144 @@ TEST(TestCall, MetaCallFutureMatchesMethodFuture)
   ASSERT_TRUE(test::finishesWithValue(future));
 }
 
+TEST(TestCall, CallsAreDroppedOnceTheirDeadlineExpired)
+{
+  qi::Promise<void> blocker;
+  std::atomic<int> worked{0};
+
+  qi::DynamicObjectBuilder dob;
+  dob.setThreadingModel(qi::ObjectThreadingModel_SingleThread);
+  dob.advertiseMethod("block", [=]{ blocker.future().wait(); });
+  dob.advertiseMethod("work", [&]{ ++worked; });
+  qi::AnyObject obj = dob.object();
+
+  TestSessionPair sessions;
+  sessions.server()->registerService("deadline", obj);
+  qi::AnyObject remoteObj = sessions.client()->service("deadline");
+
+  // The call waits behind the blocking one until its deadline expires.
+  qi::Future<void> blocking = remoteObj.async<void>("block");
+  qi::Future<void> work;
+  {
+    qi::ScopedDeadline deadline(qi::MilliSeconds{50});
+    work = remoteObj.async<void>("work");
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds{100});
+  blocker.setValue(nullptr);
+  ASSERT_TRUE(test::finishesWithValue(blocking));
+  ASSERT_TRUE(test::finishesWithError(work));
+  EXPECT_EQ(qi::deadlineExpiredError, work.error());
+  EXPECT_EQ(0, worked.load());
+
+  // Calls are not even sent once the deadline has expired.
+  qi::ScopedDeadline expired(qi::SteadyClock::now());
+  EXPECT_EQ(qi::deadlineExpiredError, remoteObj.async<void>("work").error());
+  EXPECT_EQ(0, worked.load());
+}
+
+TEST(TestCall, CallsOverTheAdmissionLimitsAreQueuedThenRejected)
+{
+  qi::Promise<void> blocker;
+  std::atomic<int> worked{0};
+
+  qi::DynamicObjectBuilder dob;
+  dob.setThreadingModel(qi::ObjectThreadingModel_MultiThread);
+  dob.advertiseMethod("block", [=]{ blocker.future().wait(); });
+  dob.advertiseMethod("work", [&]{ ++worked; });
+  qi::AnyObject obj = dob.object();
+
+  TestSessionPair sessions;
+  sessions.server()->registerService("admission", obj);
+  qi::CallAdmissionPolicy policy;
+  policy.maxCalls = 1;
+  policy.maxQueued = 1;
+  sessions.server()->setCallAdmissionPolicy("admission", policy);
+  qi::AnyObject remoteObj = sessions.client()->service("admission");
+
+  qi::Future<void> blocking = remoteObj.async<void>("block");
+  qi::Future<void> queued = remoteObj.async<void>("work");
+  qi::Future<void> rejected = remoteObj.async<void>("work");
+  ASSERT_TRUE(test::finishesWithError(rejected));
+  EXPECT_EQ(qi::serviceOverloadedError, rejected.error());
+
+  qi::CallAdmissionStatistics stats = sessions.server()->callAdmissionStatistics("admission");
+  EXPECT_EQ(1u, stats.inFlight);
+  EXPECT_EQ(1u, stats.queued);
+  EXPECT_EQ(1u, stats.admitted);
+  EXPECT_EQ(1u, stats.delayed);
+  EXPECT_EQ(1u, stats.rejected);
+  EXPECT_EQ(0, worked.load());
+
+  // The queued call runs once the blocking one finishes.
+  blocker.setValue(nullptr);
+  ASSERT_TRUE(test::finishesWithValue(blocking));
+  ASSERT_TRUE(test::finishesWithValue(queued));
+  EXPECT_EQ(1, worked.load());
+  stats = sessions.server()->callAdmissionStatistics("admission");
+  EXPECT_EQ(0u, stats.queued);
+  EXPECT_EQ(2u, stats.admitted);
+
+  EXPECT_ANY_THROW(sessions.server()->callAdmissionStatistics("unknown"));
+}
+
+TEST(TestCall, BatchedCallsAreSentOnFlushAndRunInOrder)
+{
+  std::mutex mutex;
+  std::vector<int> order;
+
+  qi::DynamicObjectBuilder dob;
+  dob.setThreadingModel(qi::ObjectThreadingModel_MultiThread);
+  dob.advertiseMethod("append", [&](int value, int delayMs) {
+    qi::os::msleep(delayMs);
+    std::lock_guard<std::mutex> lock(mutex);
+    order.push_back(value);
+  });
+  qi::AnyObject obj = dob.object();
+
+  TestSessionPair sessions;
+  sessions.server()->registerService("batch", obj);
+  qi::AnyObject remoteObj = sessions.client()->service("batch");
+
+  std::vector<qi::Future<void>> calls;
+  {
+    qi::ScopedCallBatch batch(qi::ScopedCallBatch::CallOrder::Sequential);
+    // The first calls are the slowest: they would finish last if run concurrently.
+    for (int i = 0; i < 5; ++i)
+      calls.push_back(remoteObj.async<void>("append", i, (5 - i) * 10));
+    qi::os::msleep(50);
+    for (const auto& call : calls)
+      EXPECT_TRUE(call.isRunning());
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_TRUE(order.empty());
+  }
+  for (const auto& call : calls)
+    ASSERT_TRUE(test::finishesWithValue(call));
+  std::lock_guard<std::mutex> lock(mutex);
+  EXPECT_EQ((std::vector<int>{0, 1, 2, 3, 4}), order);
+}
+
+TEST(TestCall, SynchronousCallsInBatchAreSentRightAway)
+{
+  qi::DynamicObjectBuilder dob;
+  dob.setThreadingModel(qi::ObjectThreadingModel_MultiThread);
+  dob.advertiseMethod("echo", [](int value) { return value; });
+  dob.advertiseSignal<int>("signal");
+  qi::AnyObject obj = dob.object();
+
+  TestSessionPair sessions;
+  sessions.server()->registerService("batch", obj);
+
+  qi::ScopedCallBatch batch;
+  qi::AnyObject remoteObj = sessions.client()->service("batch");
+  auto queued = remoteObj.async<int>("echo", 1);
+  EXPECT_EQ(2, remoteObj.call<int>("echo", 2));
+  // Flushed before the synchronous call.
+  ASSERT_TRUE(test::finishesWithValue(queued));
+  EXPECT_EQ(1, queued.value());
+  auto connecting = remoteObj.connect("signal", [](int) {});
+  ASSERT_TRUE(test::finishesWithValue(connecting));
+}
+
 // TODO: fix races in ObjectStatistics to reenable this test
 TEST(TestCall, DISABLED_Statistics)
 {
@@ -1091,6 +1234,31 @@ TEST(TestCall, DISABLED_Statistics)
   EXPECT_TRUE(stats.empty());
 }
 
+TEST(TestCall, ExecutionStatistics)
+{
+  TestSessionPair p;
+  qi::DynamicObjectBuilder gob;
+  gob.advertiseMethod("sleep", &qi::os::msleep);
+  qi::AnyObject srv = gob.object();
+  p.server()->registerService("sleep", srv);
+  qi::AnyObject obj = p.client()->service("sleep");
+  obj.call<void>("sleep", 10);
+
+  using Statistics = std::map<std::string, qi::ExecutionStatistics>;
+  Statistics stats = obj.call<Statistics>("executionStats");
+  ASSERT_EQ(1u, stats.count("eventloop"));
+  ASSERT_EQ(1u, stats.count("network"));
+  EXPECT_LT(0u, stats["network"].completedTasks);
+  // The call ran either in the strand of the object or in the global event loop.
+  qi::int64_t slowestUs = 0;
+  for (const auto& context : stats)
+  {
+    if (context.first != "network" && !context.second.slowestTasks.empty())
+      slowestUs = std::max(slowestUs, context.second.slowestTasks.front().runTimeUs);
+  }
+  EXPECT_LE(10000, slowestUs);
+}
+
 class ArgPack
 {
 public:
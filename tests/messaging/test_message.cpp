@@ -1,8 +1,13 @@
 #include <string>
 #include <algorithm>
+#include <fstream>
 #include <gtest/gtest.h>
+#include <boost/filesystem.hpp>
 #include <qi/application.hpp>
+#include <qi/os.hpp>
+#include <qi/path.hpp>
 #include "src/messaging/message.hpp"
+#include "src/messaging/messagecapture.hpp"
 
 namespace qi
 {
@@ -60,3 +65,63 @@ TEST(TestMessage, CopiesAreDistinct)
   ASSERT_NE(buf.totalSize(), bb.totalSize());
 
 }
+
+TEST(TestMessage, TimeLeftPrefixesThePayload)
+{
+  using namespace qi;
+  Message m(Message::Type_Call, MessageAddress{1, 2, 3, 105});
+  EXPECT_FALSE(m.timeLeft());
+
+  m.setTimeLeft(MicroSeconds{1500});
+  m.setValue(AnyReference::from(42), "i");
+  EXPECT_TRUE(m.flags() & Message::TypeFlag_Deadline);
+  ASSERT_TRUE(m.timeLeft());
+  EXPECT_EQ(MicroSeconds{1500}, *m.timeLeft());
+
+  AnyReference value = m.value("i", MessageSocketPtr());
+  EXPECT_EQ(42, value.to<int>());
+  value.destroy();
+}
+
+TEST(TestMessage, CaptureRecordsMessagesAsOnTheNetwork)
+{
+  using namespace qi;
+  const qi::Path dir = qi::os::mktmpdir("test_capture");
+  const std::string path = (dir / "capture.bin").str();
+  Message m(Message::Type_Call, MessageAddress{1, 2, 3, 105});
+  m.setValue(AnyReference::from(42), "i");
+  const qi::uint32_t connection = MessageCapture::newConnection();
+  {
+    MessageCapture capture(path);
+    capture.record(MessageCapture::Direction::Received, connection, m);
+    capture.flush();
+  }
+
+  std::ifstream file(path.c_str(), std::ios::binary);
+  qi::uint32_t magic = 0, version = 0, connectionNumber = 42;
+  qi::int64_t elapsed = -1;
+  qi::uint8_t direction = 0;
+  Message::Header header;
+  file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+  file.read(reinterpret_cast<char*>(&version), sizeof(version));
+  file.read(reinterpret_cast<char*>(&elapsed), sizeof(elapsed));
+  file.read(reinterpret_cast<char*>(&connectionNumber), sizeof(connectionNumber));
+  file.read(reinterpret_cast<char*>(&direction), sizeof(direction));
+  file.read(reinterpret_cast<char*>(&header), sizeof(header));
+  std::string payload(header.size, '\0');
+  file.read(&payload[0], payload.size());
+  ASSERT_TRUE(file.good());
+  EXPECT_EQ(EOF, file.peek());
+
+  EXPECT_EQ(MessageCapture::fileMagic, magic);
+  EXPECT_EQ(MessageCapture::fileVersion, version);
+  EXPECT_LE(0, elapsed);
+  EXPECT_EQ(connection, connectionNumber);
+  EXPECT_LT(connection, MessageCapture::newConnection());
+  EXPECT_EQ(static_cast<qi::uint8_t>(MessageCapture::Direction::Received), direction);
+  EXPECT_EQ(m.header(), header);
+  EXPECT_EQ(std::string(static_cast<const char*>(m.buffer().data()), m.buffer().size()), payload);
+
+  file.close();
+  boost::filesystem::remove_all(dir.bfsPath());
+}
@@ -742,6 +742,26 @@ TEST(SendObject, object_referenced_by_remote_only_is_destroyed_on_unreference)
   ASSERT_TRUE(cookieLostSpy.waitUntil(1, timeout));
 }
 
+TEST(SendObject, object_sent_repeatedly_has_a_single_proxy)
+{
+  TestSessionPair p;
+  auto cookieBox = boost::make_shared<CookieBox>();
+  p.server()->registerService("CookieBox", cookieBox);
+  cookieBox->give(cookieBox->makeCookie(true));
+  qi::AnyObject cookieBoxRemote = p.client()->service("CookieBox");
+  auto cookie = cookieBoxRemote.call<qi::AnyObject>("take");
+  auto sameCookie = cookieBoxRemote.call<qi::AnyObject>("take");
+  EXPECT_EQ(cookie.asGenericObject(), sameCookie.asGenericObject());
+
+  // The object stays alive until every reference sent is released.
+  qi::SignalSpy cookieLostSpy{cookieBox->cookieLost};
+  cookieBox->give(qi::AnyObject());
+  cookie.reset();
+  EXPECT_TRUE(sameCookie.call<bool>("eat"));
+  sameCookie.reset();
+  ASSERT_TRUE(cookieLostSpy.waitUntil(1, timeout));
+}
+
 TEST(SendObject, eat_yourself)
 {
   TestSessionPair p;
@@ -1,6 +1,9 @@
+#include <array>
 #include <chrono>
+#include <memory>
 #include <numeric>
 #include <random>
+#include <vector>
 #include <gtest/gtest.h>
 #include "sock/networkmock.hpp"
 #include "sock/networkcommon.hpp"
@@ -11,6 +14,7 @@
 #include "src/messaging/transportserver.hpp"
 #include "tests/qi/testutils/testutils.hpp"
 #include "qi/scoped.hpp"
+#include <qi/os.hpp>
 
 static const qi::MilliSeconds defaultTimeout{ 2000 };
 
@@ -714,6 +718,169 @@ TEST(NetMessageSocketAsio, DisconnectToDistantWhileConnected)
   ASSERT_EQ(FutureState_FinishedWithValue, futDisco.wait(defaultTimeout));
 }
 
+TYPED_TEST(NetMessageSocketAsio, AcceptManyConcurrentConnections)
+{
+  using namespace qi;
+  using namespace qi::sock;
+
+  const std::size_t clientCount = 20;
+  boost::mutex mutex;
+  std::vector<MessageSocketPtr> serverSideSockets;
+  Promise<void> promiseAllAccepted;
+
+  TransportServer server;
+  server.newConnection.connect([&](const std::pair<MessageSocketPtr, Url>& p) {
+    boost::mutex::scoped_lock lock(mutex);
+    serverSideSockets.push_back(p.first);
+    if (serverSideSockets.size() == clientCount)
+      promiseAllAccepted.setValue(nullptr);
+  });
+  const auto url = this->listen(server, this->defaultListenURL(), false).url;
+
+  std::vector<MessageSocketPtr> clientSideSockets;
+  std::vector<Future<void>> connections;
+  for (std::size_t i = 0; i < clientCount; ++i)
+  {
+    clientSideSockets.push_back(makeMessageSocket(this->scheme()));
+    connections.push_back(clientSideSockets.back()->connect(url).async());
+  }
+  const auto _ = scoped([&]{
+    for (auto& socket : clientSideSockets)
+      socket->disconnect().wait(defaultTimeout);
+  });
+
+  for (auto& connection : connections)
+    ASSERT_EQ(FutureState_FinishedWithValue, connection.wait(defaultTimeout));
+  ASSERT_EQ(FutureState_FinishedWithValue, promiseAllAccepted.future().wait(defaultTimeout));
+
+  // The handshake is over when the connection is given away: reading does not block.
+  for (auto& socket : serverSideSockets)
+    ASSERT_TRUE(socket->ensureReading());
+
+  const auto stats = server.acceptStatistics();
+  EXPECT_EQ(clientCount, stats.accepted);
+  EXPECT_EQ(0u, stats.acceptErrors);
+  EXPECT_EQ(0u, stats.handshakeFailures);
+  EXPECT_EQ(0u, stats.pendingHandshakes);
+}
+
+// Clients that connect but never start the SSL handshake must not lock accepting out.
+TEST(NetMessageSocketAsio, StalledHandshakesTimeOut)
+{
+  using namespace qi;
+  using namespace qi::sock;
+  using tcp = boost::asio::ip::tcp;
+
+  // The settings are read when the server starts listening.
+  qi::os::setenv("QI_TRANSPORTSERVER_MAX_PENDING_HANDSHAKES", "2");
+  qi::os::setenv("QI_TRANSPORTSERVER_HANDSHAKE_TIMEOUT", "1");
+  const auto _ = scoped([]{
+    qi::os::setenv("QI_TRANSPORTSERVER_MAX_PENDING_HANDSHAKES", "");
+    qi::os::setenv("QI_TRANSPORTSERVER_HANDSHAKE_TIMEOUT", "");
+  });
+  const MilliSeconds handshakeTimeout{1000};
+
+  TransportServer server;
+  const auto listenRes = NetMessageSocket<SchemeTcpSSL>::listen(server);
+  const auto url = listenRes.url;
+
+  // More than the outstanding accepts can take before they are all suspended.
+  const std::size_t stalledClientCount = 8;
+  boost::asio::io_service io;
+  std::vector<std::unique_ptr<tcp::socket>> stalledClients;
+  for (std::size_t i = 0; i < stalledClientCount; ++i)
+  {
+    stalledClients.emplace_back(new tcp::socket(io));
+    stalledClients.back()->connect(
+        tcp::endpoint(boost::asio::ip::address::from_string(url.host()), url.port()));
+  }
+
+  auto client = makeMessageSocket("tcps");
+  const auto _2 = scoped([=]{ client->disconnect().wait(defaultTimeout); });
+  Future<void> connection = client->connect(url).async();
+  ASSERT_EQ(FutureState_FinishedWithValue,
+            connection.wait(2 * handshakeTimeout + defaultTimeout));
+  ASSERT_EQ(FutureState_FinishedWithValue,
+            listenRes.promiseConnectedSocket.future().wait(defaultTimeout));
+
+  // The stalled clients were disconnected, freeing their handshake slots.
+  for (auto& stalledClient : stalledClients)
+  {
+    char byte;
+    boost::system::error_code error;
+    boost::asio::read(*stalledClient, boost::asio::buffer(&byte, 1), error);
+    EXPECT_TRUE(error);
+  }
+  // The slot of a handshake is freed just after its socket is closed.
+  const auto deadline = SteadyClock::now() + defaultTimeout;
+  while (server.acceptStatistics().pendingHandshakes != 0 && SteadyClock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+  const auto stats = server.acceptStatistics();
+  EXPECT_EQ(stalledClientCount + 1, stats.accepted);
+  EXPECT_EQ(stalledClientCount, stats.handshakeFailures);
+  EXPECT_EQ(0u, stats.pendingHandshakes);
+}
+
+TEST(NetMessageSocketAsio, ClientResumesTlsSession)
+{
+  using namespace qi;
+  using namespace qi::sock;
+  using N = NetworkAsio;
+
+  TransportServer server;
+  boost::mutex mutex;
+  std::vector<MessageSocketPtr> serverSideSockets;
+  server.newConnection.connect([&](const std::pair<MessageSocketPtr, Url>& p) {
+    // With TLS 1.3, the client receives the resumable session when it reads after the
+    // handshake: give it something to read.
+    p.first->ensureReading();
+    p.first->send(Message{});
+    boost::mutex::scoped_lock lock(mutex);
+    serverSideSockets.push_back(p.first);
+  });
+  using Fixture = NetMessageSocket<SchemeTcpSSL>;
+  const auto url = Fixture::listen(server, Fixture::defaultListenURL(), false).url;
+  const boost::asio::ip::tcp::endpoint endpoint{
+      boost::asio::ip::address::from_string(url.host()), url.port()};
+
+  auto connect = [&] {
+    auto context = makeSslContextPtr<N>(SslContext<N>::sslv23);
+    N::sslEnableSessionResumption(*context);
+    auto socket = makeSocketWithContextPtr<N>(N::defaultIoService(), context);
+    socket->set_verify_mode(N::sslVerifyNone());
+    socket->lowest_layer().connect(endpoint);
+    Promise<void> handshake;
+    socket->async_handshake(HandshakeSide<SslSocket<N>>::client, [=](const ErrorCode<N>& erc) mutable {
+      if (erc)
+        handshake.setError(erc.message());
+      else
+        handshake.setValue(nullptr);
+    });
+    EXPECT_EQ(FutureState_FinishedWithValue, handshake.future().wait(defaultTimeout));
+    auto data = std::make_shared<std::array<char, 1>>();
+    Promise<void> received;
+    socket->async_read_some(boost::asio::buffer(*data), [=](const ErrorCode<N>& erc, std::size_t) mutable {
+      if (erc)
+        received.setError(erc.message());
+      else
+        received.setValue(nullptr);
+    });
+    EXPECT_EQ(FutureState_FinishedWithValue, received.future().wait(defaultTimeout));
+    return socket;
+  };
+
+  // The connections are closed without a TLS shutdown, as sockets usually are.
+  const auto first = connect();
+  EXPECT_FALSE(SSL_session_reused(first->native_handle()));
+  first->lowest_layer().close();
+  for (int i = 0; i < 2; ++i)
+  {
+    const auto next = connect();
+    EXPECT_TRUE(SSL_session_reused(next->native_handle()));
+    next->lowest_layer().close();
+  }
+}
+
 // Connect to another process and make it brutally crash to check that the
 // disconnection is quick and does not last until a system timeout expires.
 TEST(NetMessageSocketAsio, DistantCrashWhileConnected)
@@ -82,3 +82,40 @@ TEST(TestBufferReader, TestPeekSeek)
 
   ASSERT_STREQ("bla", str);
 }
+
+TEST(TestBufferReader, TestReadArray)
+{
+  qi::Buffer buffer;
+  const qi::uint32_t values[] = { 1, 2, 3, 0xdeadbeef };
+  buffer.write(values, sizeof(values));
+
+  qi::BufferReader reader(buffer);
+  qi::uint32_t read[4] = {};
+  ASSERT_FALSE(reader.readArray(read, 5));
+  ASSERT_EQ(0u, reader.position());
+
+  ASSERT_TRUE(reader.readArray(read, 3));
+  ASSERT_EQ(3 * sizeof(qi::uint32_t), reader.position());
+  ASSERT_TRUE(reader.readArray(read + 3, 1));
+  for (int i = 0; i < 4; ++i)
+    EXPECT_EQ(values[i], read[i]);
+}
+
+TEST(TestBufferReader, TestReadView)
+{
+  qi::Buffer buffer;
+  char tmpStr1[] = "Blabla";
+
+  buffer.write(tmpStr1, sizeof(tmpStr1));
+
+  qi::BufferReader reader(buffer);
+  qi::StringView view = reader.readView(100u);
+  ASSERT_TRUE(view.empty());
+  ASSERT_EQ(0u, reader.position());
+
+  view = reader.readView(3u);
+  ASSERT_EQ(3u, reader.position());
+  ASSERT_EQ(std::string("Bla"), view.str());
+  // The view refers to the buffer data.
+  ASSERT_EQ(static_cast<const char*>(buffer.data()), view.data());
+}
@@ -1,7 +1,13 @@
 #include <condition_variable>
+#include <limits>
 #include <mutex>
+#include <thread>
+#include <vector>
 #include <gtest/gtest.h>
 #include <qi/eventloop.hpp>
+#include <qi/detail/executionstatistics.hpp>
+#include <qi/os.hpp>
+#include <qi/scoped.hpp>
 #include "test_future.hpp"
 
 int ping(int v)
@@ -110,3 +116,183 @@ TEST(EventLoop, asyncFast)
     f.wait();
   }
 }
+
+TEST(EventLoop, nextNetworkEventLoopDefaultsToNetworkEventLoop)
+{
+  // QI_NETWORK_EVENTLOOP_COUNT is not set in the tests environment.
+  for (int i = 0; i < 4; ++i)
+  {
+    EXPECT_EQ(qi::getNetworkEventLoop(), qi::getNextNetworkEventLoop());
+  }
+}
+
+TEST(EventLoop, threadPolicyFromEnvironment)
+{
+  const auto _ = qi::scoped([] {
+    for (const char* name : {"QI_TEST_POLICY_CPUS", "QI_TEST_POLICY_PINNED",
+                             "QI_TEST_POLICY_PRIORITY", "QI_TEST_POLICY_THREAD_NAME"})
+      qi::os::setenv(name, "");
+  });
+  qi::os::setenv("QI_TEST_POLICY_CPUS", "0-2, 5");
+  qi::os::setenv("QI_TEST_POLICY_PINNED", "1");
+  qi::os::setenv("QI_TEST_POLICY_PRIORITY", "5");
+  qi::os::setenv("QI_TEST_POLICY_THREAD_NAME", "TestPool");
+  const auto policy = qi::EventLoopThreadPolicy::fromEnvironment("QI_TEST_POLICY");
+  EXPECT_EQ((std::vector<int>{0, 1, 2, 5}), policy.cpus);
+  EXPECT_TRUE(policy.pinned);
+  EXPECT_FALSE(policy.realTime);
+  EXPECT_EQ(5, policy.priority);
+  EXPECT_EQ("TestPool", policy.threadName);
+
+  qi::os::setenv("QI_TEST_POLICY_CPUS", "2-1");
+  EXPECT_THROW(qi::EventLoopThreadPolicy::fromEnvironment("QI_TEST_POLICY"), std::runtime_error);
+}
+
+TEST(EventLoop, threadStatisticsCountTasksOfPinnedWorkers)
+{
+  qi::EventLoopThreadPolicy policy;
+  policy.cpus = {0};
+  policy.pinned = true;
+  qi::EventLoop loop{ gEventLoopName, 2, false, policy };
+
+  for (int i = 0; i < 10; ++i)
+    loop.async([]{ std::this_thread::sleep_for(std::chrono::milliseconds{1}); }).value(1000);
+
+  // A task is accounted for right after its future is set.
+  uint64_t tasks = 0;
+  qi::NanoSeconds busyTime{0};
+  for (int attempt = 0; attempt < 100 && tasks < 10; ++attempt)
+  {
+    if (attempt)
+      std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    const auto stats = loop.threadStatistics();
+    ASSERT_EQ(2u, stats.size());
+    tasks = 0;
+    busyTime = qi::NanoSeconds{0};
+    for (const auto& worker : stats)
+    {
+#if defined(__linux__) && !defined(ANDROID)
+      EXPECT_EQ(0, worker.cpu);
+#endif
+      EXPECT_LE(worker.busyTime, worker.upTime);
+      tasks += worker.tasks;
+      busyTime += worker.busyTime;
+    }
+  }
+  EXPECT_EQ(10u, tasks);
+  EXPECT_GE(busyTime, qi::MilliSeconds{10});
+}
+
+TEST(EventLoop, durationHistogramQuantiles)
+{
+  qi::DurationHistogram histogram;
+  EXPECT_EQ(0, histogram.quantileUs(0.5));
+  for (int i = 0; i < 99; ++i)
+    histogram.push(3);
+  histogram.push(1000);
+  EXPECT_EQ(100u, histogram.total());
+  EXPECT_EQ(4, histogram.quantileUs(0.5));
+  EXPECT_EQ(1024, histogram.quantileUs(0.999));
+  histogram.push(std::numeric_limits<qi::int64_t>::max());
+  EXPECT_EQ(1u, histogram.counts.back());
+}
+
+TEST(EventLoop, statisticsCountTasksAndSlowestOnes)
+{
+  qi::EventLoop loop{ gEventLoopName, 1, false };
+  loop.async([]{ std::this_thread::sleep_for(std::chrono::milliseconds{20}); });
+  for (int i = 0; i < 9; ++i)
+    loop.async([]{});
+  loop.asyncDelay([]{}, qi::MilliSeconds{1}).value(1000);
+
+  // A task is accounted for right after its future is set.
+  qi::ExecutionStatistics stats;
+  for (int attempt = 0; attempt < 100; ++attempt)
+  {
+    stats = loop.statistics();
+    if (stats.completedTasks == 11u)
+      break;
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+  }
+  EXPECT_EQ(11u, stats.completedTasks);
+  EXPECT_EQ(0, stats.queueDepth);
+  EXPECT_EQ(11u, stats.runTime.total());
+  EXPECT_EQ(11u, stats.schedulingDelay.total());
+  // The tasks posted behind the sleeping one waited for it.
+  EXPECT_GE(stats.schedulingDelay.quantileUs(0.5), 10000);
+  ASSERT_FALSE(stats.slowestTasks.empty());
+  EXPECT_LE(stats.slowestTasks.size(), qi::detail::ExecutionStatisticsRecorder::slowTaskCount);
+  EXPECT_GE(stats.slowestTasks.front().runTimeUs, 20000);
+  EXPECT_FALSE(stats.slowestTasks.front().name.empty());
+}
+
+TEST(EventLoop, poolGrowsWhenBlockedAndShrinksWhenIdle)
+{
+  qi::os::setenv("QI_EVENTLOOP_IDLE_TIMEOUT", "100");
+  qi::EventLoop loop{ gEventLoopName, 1 };
+  qi::os::setenv("QI_EVENTLOOP_IDLE_TIMEOUT", "");
+
+  // Block the only thread, the pool must grow to run the next task.
+  qi::Promise<void> blocker;
+  loop.async([=]{ blocker.future().wait(); });
+  auto next = loop.async([]{});
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, next.wait(qi::Seconds{5}));
+  auto stats = loop.poolStatistics();
+  EXPECT_LE(1u, stats.spawned);
+  EXPECT_EQ(1u, stats.blockedThreads);
+  EXPECT_EQ(1u, stats.minThreads);
+
+  // Once unblocked, the extra threads are idle and retired.
+  blocker.setValue(nullptr);
+  for (int attempt = 0; attempt < 50; ++attempt)
+  {
+    stats = loop.poolStatistics();
+    if (stats.threads == 1u && stats.retired >= stats.spawned)
+      break;
+    std::this_thread::sleep_for(std::chrono::milliseconds{100});
+  }
+  EXPECT_EQ(1u, stats.threads);
+  EXPECT_EQ(stats.spawned, stats.retired);
+}
+
+TEST(EventLoop, highPriorityTasksRunBeforePendingNormalOnes)
+{
+  qi::EventLoop loop{ gEventLoopName, 1, false };
+  qi::Promise<void> blocker;
+  loop.async([=]{ blocker.future().wait(); });
+
+  std::mutex m;
+  std::vector<char> order;
+  auto record = [&](char c) { return [&, c] { std::lock_guard<std::mutex> l{m}; order.push_back(c); }; };
+  std::vector<qi::Future<void>> futures;
+  for (int i = 0; i < 3; ++i)
+    futures.push_back(loop.async(record('n')));
+  futures.push_back(loop.async(record('h'), qi::TaskPriority::High));
+
+  blocker.setValue(nullptr);
+  for (auto& future : futures)
+    ASSERT_EQ(qi::FutureState_FinishedWithValue, future.wait(1000));
+  ASSERT_EQ(4u, order.size());
+  EXPECT_EQ('h', order.front());
+}
+
+TEST(EventLoop, normalTasksAreNotStarvedByHighPriorityOnes)
+{
+  qi::EventLoop loop{ gEventLoopName, 1, false };
+  qi::Promise<void> blocker;
+  loop.async([=]{ blocker.future().wait(); });
+
+  std::mutex m;
+  std::vector<char> order;
+  auto record = [&](char c) { return [&, c] { std::lock_guard<std::mutex> l{m}; order.push_back(c); }; };
+  std::vector<qi::Future<void>> futures;
+  futures.push_back(loop.async(record('n')));
+  for (int i = 0; i < 50; ++i)
+    futures.push_back(loop.async(record('h'), qi::TaskPriority::High));
+
+  blocker.setValue(nullptr);
+  for (auto& future : futures)
+    ASSERT_EQ(qi::FutureState_FinishedWithValue, future.wait(1000));
+  ASSERT_EQ(51u, order.size());
+  EXPECT_NE('n', order.back());
+}
@@ -0,0 +1,33 @@
+#include <set>
+#include <vector>
+#include <gtest/gtest.h>
+#include <qi/application.hpp>
+#include <qi/eventloop.hpp>
+#include <qi/os.hpp>
+
+// The network eventloops are created on first use, from the environment set in main.
+static const int networkEventLoopCount = 3;
+
+TEST(NetworkEventLoops, nextNetworkEventLoopIsRoundRobin)
+{
+  std::vector<qi::EventLoop*> loops;
+  for (int i = 0; i < 2 * networkEventLoopCount; ++i)
+    loops.push_back(qi::getNextNetworkEventLoop());
+
+  const std::set<qi::EventLoop*> distinct(loops.begin(), loops.end());
+  EXPECT_EQ(static_cast<std::size_t>(networkEventLoopCount), distinct.size());
+  EXPECT_EQ(1u, distinct.count(qi::getNetworkEventLoop()));
+  for (int i = 0; i < networkEventLoopCount; ++i)
+    EXPECT_EQ(loops[i], loops[i + networkEventLoopCount]);
+
+  for (qi::EventLoop* loop : distinct)
+    EXPECT_EQ(42, loop->async([] { return 42; }).value());
+}
+
+int main(int argc, char* argv[])
+{
+  qi::os::setenv("QI_NETWORK_EVENTLOOP_COUNT", std::to_string(networkEventLoopCount).c_str());
+  qi::Application app(argc, argv);
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
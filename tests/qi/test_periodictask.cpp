@@ -192,3 +192,48 @@ TEST(TestPeriodicTask, DoesNotDeadlockWhenStartedWithStrandInsideStrandContext)
   ASSERT_TRUE(test::finishesWithValue(futStart));
   strand.join(); // join it before PeriodicTask is destroyed
 }
+
+namespace
+{
+  // Runs a task whose first call lasts longer than several periods and
+  // returns the statistics once it was called callCount times.
+  qi::PeriodicTask::Statistics runWithLongFirstCall(qi::PeriodicTask::Scheduling scheduling)
+  {
+    static const qi::MilliSeconds period{ 10 };
+    static const int callCount = 4;
+    qi::Atomic<int> calls;
+    qi::Promise<void> done;
+    qi::PeriodicTask pt;
+    pt.setCallback([&] {
+      if (++calls == 1)
+        qi::sleepFor(qi::MilliSeconds{ 55 });
+      else if (calls.load() == callCount)
+        done.setValue(nullptr);
+    });
+    pt.setPeriod(period);
+    pt.setScheduling(scheduling);
+    pt.start();
+    done.future().wait(5000);
+    pt.stop();
+    return pt.statistics();
+  }
+}
+
+TEST(TestPeriodicTask, FixedRateSkipsMissedDeadlines)
+{
+  const auto stats = runWithLongFirstCall(qi::PeriodicTask::Scheduling::FixedRateSkip);
+  EXPECT_GE(stats.calls, 4u);
+  EXPECT_GE(stats.overruns, 1u);
+  EXPECT_GE(stats.skipped, 4u);
+  EXPECT_GE(stats.totalJitter, stats.maxJitter);
+}
+
+TEST(TestPeriodicTask, FixedRateCatchesUpMissedDeadlines)
+{
+  const auto stats = runWithLongFirstCall(qi::PeriodicTask::Scheduling::FixedRateCatchUp);
+  EXPECT_GE(stats.calls, 4u);
+  EXPECT_GE(stats.overruns, 1u);
+  EXPECT_EQ(0u, stats.skipped);
+  // The calls following the long one were late.
+  EXPECT_GT(stats.maxJitter, qi::Duration(0));
+}
@@ -18,6 +18,7 @@
 #include <cstring>
 #include <cwchar>
 #include <future>
+#include <stdexcept>
 
 #include <gmock/gmock.h>
 
@@ -203,6 +204,90 @@ TEST_F(SyncLog, formatting)
     EXPECT_CALL(handler, log(StrEq("coin 42")));
     qiLogErrorF("coin %s%s", 42);
   }
+
+  {
+    const auto _u = scopeMockExpectations(handler);
+    EXPECT_CALL(handler, log(StrEq("coin 51 42 100% 0x2a")));
+    qiLogError("qi.test", "coin %2% %1% 100%% %#x", 42, 51);
+  }
+
+  {
+    const auto _u = scopeMockExpectations(handler);
+    EXPECT_CALL(handler, log(StrEq("coin 42 |3.14|  7|7  |007")));
+    qiLogErrorF("coin {} |%.2f|%3d|%-3d|%03d", 42, 3.14159, 7, 7, 7);
+  }
+}
+
+namespace
+{
+  struct LoggingWhenPrinted {};
+
+  std::ostream& operator<<(std::ostream& os, const LoggingWhenPrinted&)
+  {
+    qiLogError("qi.test") << "inner";
+    return os << "outer";
+  }
+}
+
+TEST_F(SyncLog, nestedLogs)
+{
+  StrictMock<MockLogHandler> handler("eclairs");
+
+  const auto _u = scopeMockExpectations(handler);
+  EXPECT_CALL(handler, log(StrEq("inner")));
+  EXPECT_CALL(handler, log(StrEq("coin outer 42")));
+  qiLogError("qi.test") << "coin " << LoggingWhenPrinted{} << " " << 42;
+}
+
+TEST_F(SyncLog, longMessage)
+{
+  qiLogCategory("qi.test");
+  StrictMock<MockLogHandler> handler("madeleines");
+  const std::string message(5000, 'x');
+
+  const auto _u = scopeMockExpectations(handler);
+  EXPECT_CALL(handler, log(StrEq(message))).Times(Exactly(2));
+  qiLogError("qi.test") << message;
+  qiLogErrorF("%s", message);
+}
+
+TEST_F(SyncLog, formatArgumentCountMismatch)
+{
+  qiLogCategory("qi.test");
+  StrictMock<MockLogHandler> handler("financiers");
+
+  const auto _u = scopeMockExpectations(handler);
+  EXPECT_CALL(handler, log(StrEq("coin 42  {}")));
+  EXPECT_CALL(handler, log(StrEq("coin 42")));
+  EXPECT_CALL(handler, log(StrEq("set {} {42}")));
+  qiLogErrorF("coin %s %s {}", 42);
+  qiLogErrorF("coin %s", 42, 51);
+  qiLogErrorF("set {{}} {{{}}}", 42);
+}
+
+namespace
+{
+  struct ThrowingWhenPrinted {};
+
+  std::ostream& operator<<(std::ostream&, const ThrowingWhenPrinted&)
+  {
+    throw std::runtime_error("cannot print");
+  }
+}
+
+TEST(QiLogFormat, throwingArgumentReleasesTheBuffer)
+{
+  using namespace qi::log::detail;
+  LogStreamBuffer* const pooled = acquireLogStreamBuffer();
+  releaseLogStreamBuffer(pooled);
+
+  EXPECT_THROW(formatToString("coin %s", ThrowingWhenPrinted{}), std::runtime_error);
+
+  LogStreamBuffer* const buffer = acquireLogStreamBuffer();
+  EXPECT_TRUE(pooled == buffer);
+  EXPECT_EQ(0u, buffer->size());
+  releaseLogStreamBuffer(buffer);
+  EXPECT_EQ("coin 42", formatToString("coin %s", 42));
 }
 
 TEST_F(SyncLog, filteringChange)
@@ -524,6 +609,72 @@ TEST_F(SyncLog, emptyLogWithCat)
   qiLogFatal("log.test1");
 }
 
+TEST_F(SyncLog, hiddenLogWithCatIsNotFormatted)
+{
+  StrictMock<MockLogHandler> handler("scones");
+  int evaluated = 0;
+  auto evaluate = [&] { return ++evaluated; };
+
+  {
+    const auto _u = scopeMockExpectations(handler);
+    EXPECT_CALL(handler, log(_)).Times(Exactly(0));
+    for (int i = 0; i < 3; ++i)
+      qiLogVerbose("log.test3") << evaluate(); // will not log, default log level is info
+    const std::string category = "log.test3";
+    qiLogVerbose(category) << evaluate();
+    EXPECT_EQ(0, evaluated);
+  }
+
+  // The category cached by the call site follows the filters.
+  log::addFilter("log.test3", LogLevel_Verbose, handler.id);
+  {
+    const auto _u = scopeMockExpectations(handler);
+    EXPECT_CALL(handler, log(_)).Times(Exactly(2));
+    for (int i = 0; i < 2; ++i)
+      qiLogVerbose("log.test3") << evaluate();
+    EXPECT_EQ(2, evaluated);
+  }
+}
+
+namespace
+{
+  template <std::size_t N>
+  void logVerboseIn(const char (&category)[N])
+  {
+    qiLogVerbose(category) << "in " << category;
+  }
+}
+
+TEST_F(SyncLog, logWithCatEvaluatesTheCategoryOnce)
+{
+  StrictMock<MockLogHandler> handler("shortbreads");
+  int evaluated = 0;
+  auto category = [&] { ++evaluated; return "log.test4"; };
+
+  const auto _u = scopeMockExpectations(handler);
+  EXPECT_CALL(handler, log(StrEq("coin")));
+  EXPECT_CALL(handler, log(StrEq("coin 42")));
+  qiLogError(category()) << "coin";
+  qiLogError(category(), "coin %s", 42);
+  EXPECT_EQ(2, evaluated);
+}
+
+TEST_F(SyncLog, arrayCategoriesAreNotMixedUp)
+{
+  StrictMock<MockLogHandler> handler("palmiers");
+  static const char hidden[] = "log.test5";
+  static const char visible[] = "log.test6";
+  log::addFilter(visible, LogLevel_Verbose, handler.id);
+
+  const auto _u = scopeMockExpectations(handler);
+  EXPECT_CALL(handler, log(StrEq("in log.test6"))).Times(Exactly(2));
+  for (int i = 0; i < 2; ++i)
+  {
+    logVerboseIn(hidden);
+    logVerboseIn(visible);
+  }
+}
+
 TEST_F(SyncLog, emptyLog)
 {
   StrictMock<MockLogHandler> handler("cookies again");
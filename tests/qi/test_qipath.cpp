@@ -652,6 +652,30 @@ TEST_F(qiPathData, findDataDir)
   EXPECT_TRUE(barDirMatches.empty()); // listData discards directories
 }
 
+TEST(qiPath, findDataUsesCacheUntilInvalidated)
+{
+  const bfs::path prefix(qi::os::mktmpdir("cachedSdk"), qi::unicodeFacet());
+  const bfs::path shareFoo = prefix / "share" / "foo";
+  createData(shareFoo, "first.dat");
+
+  qi::SDKLayout sdkl(prefix.string(qi::unicodeFacet()));
+  const std::string first = (shareFoo / "first.dat").make_preferred().string(qi::unicodeFacet());
+  EXPECT_EQ(first, sdkl.findData("foo", "first.dat", true));
+  EXPECT_TRUE(sdkl.findData("foo", "late.dat", true).empty());
+
+  // The index of share/foo is not refreshed until the cache is invalidated.
+  createData(shareFoo, "late.dat");
+  EXPECT_TRUE(sdkl.findData("foo", "late.dat", true).empty());
+  EXPECT_EQ(1u, sdkl.listData("foo", "*.dat", true).size());
+
+  sdkl.invalidateCache();
+  const std::string late = (shareFoo / "late.dat").make_preferred().string(qi::unicodeFacet());
+  EXPECT_EQ(late, sdkl.findData("foo", "late.dat", true));
+  EXPECT_EQ(2u, sdkl.listData("foo", "*.dat", true).size());
+
+  bfs::remove_all(prefix);
+}
+
 TEST(qiPath, filesystemConcat)
 {
   std::string s0 = fsconcat("/toto", "tata");
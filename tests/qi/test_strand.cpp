@@ -462,3 +462,80 @@ TEST(TestStrand, CallScheduleFromStrandContextDoesNotExecuteImmediately)
   const std::vector<int> expected{0, 1};
   ASSERT_EQ(expected, values);
 }
+
+TEST(TestStrand, statisticsCountTasks)
+{
+  qi::Strand strand(*qi::getEventLoop());
+  for (int i = 0; i < 4; ++i)
+    strand.async([]{ std::this_thread::sleep_for(std::chrono::milliseconds{5}); });
+  strand.async([]{}).value();
+
+  // The last task is accounted for right after its future is set.
+  qi::ExecutionStatistics stats;
+  for (int attempt = 0; attempt < 100; ++attempt)
+  {
+    stats = strand.statistics();
+    if (stats.completedTasks == 5u)
+      break;
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+  }
+  EXPECT_EQ(5u, stats.completedTasks);
+  EXPECT_EQ(0, stats.queueDepth);
+  EXPECT_EQ(0, stats.activeTasks);
+  EXPECT_EQ(5u, stats.runTime.total());
+  ASSERT_FALSE(stats.slowestTasks.empty());
+  EXPECT_GE(stats.slowestTasks.front().runTimeUs, 5000);
+}
+
+TEST(TestStrand, statisticsUnqueueTasksDroppedWhenJoinedFromInside)
+{
+  qi::Strand strand(*qi::getEventLoop());
+  std::vector<qi::Future<void>> dropped;
+  strand.async([&]{
+    for (int i = 0; i < 3; ++i)
+      dropped.push_back(strand.defer([]{}));
+    // Does not wait for the queued tasks, they never run.
+    strand.join();
+  }).value();
+
+  for (auto& future : dropped)
+    EXPECT_EQ(qi::FutureState_FinishedWithError, future.wait(qi::Seconds{1}));
+  EXPECT_EQ(0, strand.statistics().queueDepth);
+}
+
+TEST(TestStrand, PostedCallbacksRunInOrderDespiteErrors)
+{
+  qi::Strand strand(*qi::getEventLoop());
+  std::vector<int> order;
+  for (int i = 0; i < 100; ++i)
+  {
+    strand.post([&order, i]{
+      order.push_back(i);
+      if (i % 10 == 0)
+        throw std::runtime_error("posted callback failure");
+    });
+  }
+  strand.async([]{}).value();
+
+  ASSERT_EQ(100u, order.size());
+  for (int i = 0; i < 100; ++i)
+    EXPECT_EQ(i, order[i]);
+}
+
+TEST(TestStrand, HighPriorityStrandRunsBeforePendingNormalTasks)
+{
+  qi::EventLoop loop("TestStrandPriority", 1, false);
+  qi::Strand strand(loop, qi::TaskPriority::High);
+  qi::Promise<void> blocker;
+  loop.async([=]{ blocker.future().wait(); });
+
+  std::atomic<bool> normalTaskRan{false};
+  auto normal = loop.async([&]{ normalTaskRan = true; });
+  bool ranBeforeNormalTask = false;
+  auto stranded = strand.async([&]{ ranBeforeNormalTask = !normalTaskRan; });
+
+  blocker.setValue(nullptr);
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, stranded.wait(1000));
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, normal.wait(1000));
+  EXPECT_TRUE(ranBeforeNormalTask);
+}
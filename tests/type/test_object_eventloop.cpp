@@ -6,13 +6,17 @@
 // Test that calls happen in the correct event loop
 
 #include <cstdint>
+#include <mutex>
+#include <vector>
 #include <boost/thread.hpp>
 
 #include <gtest/gtest.h>
+#include <qi/actor.hpp>
 #include <qi/anyobject.hpp>
 #include <qi/type/dynamicobjectbuilder.hpp>
 #include <qi/type/objecttypebuilder.hpp>
 #include <qi/application.hpp>
+#include <qi/eventloop.hpp>
 
 
 // ARGH! boost::thread::id is an opaque class, not an int, so we have
@@ -194,3 +198,80 @@ TEST(TestThreadModelStatic, MethodModel)
   f1.wait();
   ASSERT_LT(qi::os::ustime() - start, 270000);
 }
+
+TEST(TestMethodPriority, HighPriorityMethodRunsBeforePendingCalls)
+{
+  auto loop = boost::make_shared<qi::EventLoop>("TestMethodPriority", 1, false);
+  qi::Promise<void> blocker;
+  loop->async([=]{ blocker.future().wait(); });
+
+  std::mutex m;
+  std::vector<char> order;
+  qi::DynamicObjectBuilder ob;
+  ob.advertiseMethod("normal", [&]{ std::lock_guard<std::mutex> l{m}; order.push_back('n'); });
+  const unsigned int urgent =
+      ob.advertiseMethod("urgent", [&]{ std::lock_guard<std::mutex> l{m}; order.push_back('h'); });
+  ob.setMethodPriority(urgent, qi::TaskPriority::High);
+  qi::AnyObject obj = ob.object();
+  obj.forceExecutionContext(loop);
+
+  std::vector<qi::Future<void>> futures;
+  for (int i = 0; i < 3; ++i)
+    futures.push_back(obj.async<void>("normal"));
+  futures.push_back(obj.async<void>("urgent"));
+
+  blocker.setValue(nullptr);
+  for (auto& future : futures)
+    ASSERT_EQ(qi::FutureState_FinishedWithValue, future.wait(1000));
+  ASSERT_EQ(4u, order.size());
+  EXPECT_EQ('h', order.front());
+}
+
+namespace
+{
+  // Single-threaded: its calls are serialized by the strand of the actor.
+  class PrioritizedActor : public qi::Actor
+  {
+  public:
+    explicit PrioritizedActor(qi::ExecutionContext& ec)
+      : qi::Actor(ec)
+    {
+    }
+
+    void urgent()
+    {
+      std::lock_guard<std::mutex> l{mutex};
+      order.push_back('h');
+    }
+
+    std::mutex mutex;
+    std::vector<char> order;
+  };
+}
+
+TEST(TestMethodPriority, HighPriorityMethodOfSingleThreadedObjectRunsBeforePendingTasks)
+{
+  auto loop = boost::make_shared<qi::EventLoop>("TestMethodPriority", 1, false);
+  qi::Promise<void> blocker;
+  loop->async([=]{ blocker.future().wait(); });
+
+  PrioritizedActor actor(*loop);
+  qi::ObjectTypeBuilder<PrioritizedActor> ob;
+  const unsigned int urgent = ob.advertiseMethod("urgent", &PrioritizedActor::urgent);
+  ob.setMethodPriority(urgent, qi::TaskPriority::High);
+  qi::AnyObject obj = ob.object(&actor, &qi::AnyObject::deleteGenericObjectOnly);
+
+  std::vector<qi::Future<void>> futures;
+  for (int i = 0; i < 3; ++i)
+    futures.push_back(loop->async([&]{
+      std::lock_guard<std::mutex> l{actor.mutex};
+      actor.order.push_back('n');
+    }));
+  futures.push_back(obj.async<void>("urgent"));
+
+  blocker.setValue(nullptr);
+  for (auto& future : futures)
+    ASSERT_EQ(qi::FutureState_FinishedWithValue, future.wait(1000));
+  ASSERT_EQ(4u, actor.order.size());
+  EXPECT_EQ('h', actor.order.front());
+}
@@ -5,12 +5,15 @@
 ** Copyright (C) 2012 Aldebaran Robotics
 */
 
+#include <boost/filesystem.hpp>
 #include <gtest/gtest.h>
 #include <qi/signal.hpp>
 #include <qi/future.hpp>
+#include <qi/signalrecorder.hpp>
 #include <qi/signalspy.hpp>
 #include <qi/anyobject.hpp>
 #include <qi/application.hpp>
+#include <qi/os.hpp>
 #include <qi/type/objecttypebuilder.hpp>
 #include <qi/type/dynamicobjectbuilder.hpp>
 
@@ -548,3 +551,136 @@ TEST(TestSignalSpy, WaitUntilCanBeCancelled)
   auto status = waiting.wait(usualTimeout);
   ASSERT_EQ(qi::FutureState_Canceled, status);
 }
+
+// ===========================================================
+// Signal Recorder
+// -----------------------------------------------------------
+TEST(TestSignalRecorder, RecordsAcrossSegmentsAndReplays)
+{
+  const std::string bag = qi::os::mktmpdir("bag");
+  qi::Signal<int, std::string> typed;
+  qi::Signal<int> dynamic;
+  qi::DynamicObjectBuilder ob;
+  ob.advertiseSignal("dynamic", &dynamic);
+  qi::AnyObject obj(ob.object());
+  {
+    // Small segments, so that the records span several files.
+    qi::SignalRecorder recorder(bag, 128);
+    EXPECT_EQ(0u, recorder.record(typed, "typed"));
+    EXPECT_EQ(1u, recorder.record(obj, "dynamic"));
+    for (int i = 0; i < 20; ++i)
+    {
+      typed(i, std::string(i, 'x'));
+      dynamic(-i);
+    }
+    typed(0, std::string(200, 'x')); // does not fit in a segment
+    EXPECT_EQ(40u, recorder.recordCount());
+    EXPECT_EQ(1u, recorder.droppedCount());
+  }
+  typed(42, "not recorded");
+
+  qi::SignalPlayer player(bag);
+  ASSERT_EQ(2u, player.channels().size());
+  EXPECT_EQ("typed", player.channels()[0].name);
+  EXPECT_EQ("(is)", player.channels()[0].signature.toString());
+  EXPECT_EQ("dynamic", player.channels()[1].name);
+  ASSERT_EQ(40u, player.recordCount());
+  for (std::size_t i = 1; i < player.recordCount(); ++i)
+    EXPECT_LE(player.record(i - 1).time, player.record(i).time);
+
+  const auto last = player.record(player.recordCount() - 1);
+  EXPECT_EQ(player.recordCount() - 1, player.seek(last.time));
+  EXPECT_EQ(player.recordCount(), player.seek(last.time + qi::NanoSeconds(1)));
+  EXPECT_EQ(0u, player.seek(qi::NanoSeconds::zero()));
+  EXPECT_ANY_THROW(player.record(player.recordCount()));
+
+  qi::Signal<int, std::string> replayedTyped;
+  qi::Signal<int> replayedDynamic;
+  qi::SignalSpy typedSpy(replayedTyped);
+  qi::SignalSpy dynamicSpy(replayedDynamic);
+  player.setTarget(0, replayedTyped);
+  player.setTarget(1, replayedDynamic);
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, player.play(0).wait(usualTimeout));
+  ASSERT_TRUE(typedSpy.waitUntil(20, usualTimeout));
+  ASSERT_TRUE(dynamicSpy.waitUntil(20, usualTimeout));
+  for (int i = 0; i < 20; ++i)
+  {
+    EXPECT_EQ(i, typedSpy.record(i).arg<int>(0));
+    EXPECT_EQ(std::string(i, 'x'), typedSpy.record(i).arg<std::string>(1));
+    EXPECT_EQ(-i, dynamicSpy.record(i).arg<int>(0));
+  }
+  boost::filesystem::remove_all(bag);
+}
+
+TEST(TestSignalRecorder, ReplaysEmissionsWithoutArguments)
+{
+  const std::string bag = qi::os::mktmpdir("bag");
+  qi::Signal<> empty;
+  qi::Signal<int> sig;
+  {
+    qi::SignalRecorder recorder(bag);
+    recorder.record(empty, "empty");
+    recorder.record(sig, "sig");
+    empty();
+    sig(42);
+    EXPECT_EQ(2u, recorder.recordCount());
+  }
+  qi::SignalPlayer player(bag);
+  ASSERT_EQ(2u, player.recordCount());
+  EXPECT_EQ(0u, player.record(0).channel);
+  EXPECT_EQ(1u, player.record(1).channel);
+
+  qi::Signal<> replayedEmpty;
+  qi::Signal<int> replayed;
+  qi::SignalSpy emptySpy(replayedEmpty);
+  qi::SignalSpy spy(replayed);
+  player.setTarget(0, replayedEmpty);
+  player.setTarget(1, replayed);
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, player.play(0).wait(usualTimeout));
+  ASSERT_TRUE(emptySpy.waitUntil(1, usualTimeout));
+  ASSERT_TRUE(spy.waitUntil(1, usualTimeout));
+  EXPECT_EQ(42, spy.record(0).arg<int>(0));
+  boost::filesystem::remove_all(bag);
+}
+
+TEST(TestSignalRecorder, DisconnectsWhenDestroyed)
+{
+  const std::string bag = qi::os::mktmpdir("bag");
+  qi::Signal<int> sig;
+  {
+    qi::SignalRecorder recorder(bag);
+    recorder.record(sig, "sig");
+    {
+      qi::Signal<int> shortLived;
+      recorder.record(shortLived, "shortLived");
+      shortLived(1);
+    }
+    EXPECT_TRUE(sig.hasSubscribers());
+  }
+  EXPECT_FALSE(sig.hasSubscribers());
+  boost::filesystem::remove_all(bag);
+}
+
+TEST(TestSignalRecorder, PlayingCanBeCancelled)
+{
+  const std::string bag = qi::os::mktmpdir("bag");
+  qi::Signal<int> sig;
+  {
+    qi::SignalRecorder recorder(bag);
+    recorder.record(sig, "sig");
+    sig(1);
+    qi::os::msleep(200);
+    sig(2);
+  }
+  qi::SignalPlayer player(bag);
+  ASSERT_EQ(2u, player.recordCount());
+  qi::Signal<int> replayed;
+  qi::SignalSpy spy(replayed);
+  player.setTarget(0, replayed);
+  auto playing = player.play(0.01);
+  ASSERT_TRUE(spy.waitUntil(1, usualTimeout));
+  playing.cancel();
+  EXPECT_EQ(qi::FutureState_Canceled, playing.wait(usualTimeout));
+  EXPECT_EQ(1u, spy.recordCount());
+  boost::filesystem::remove_all(bag);
+}
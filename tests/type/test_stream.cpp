@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <qi/os.hpp>
+#include <qi/path.hpp>
+#include <qi/stream.hpp>
+
+namespace
+{
+  std::string toString(const qi::Buffer& buffer)
+  {
+    return std::string(static_cast<const char*>(buffer.data()), buffer.size());
+  }
+}
+
+TEST(Stream, readsBufferInChunks)
+{
+  const std::string content = "0123456789";
+  qi::Buffer buffer;
+  buffer.write(content.data(), content.size());
+
+  std::vector<std::string> chunks;
+  qi::Future<void> done = qi::readStream(qi::Stream::fromBuffer(buffer),
+      [&](const qi::Buffer& chunk) { chunks.push_back(toString(chunk)); }, 4);
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, done.wait(1000));
+
+  ASSERT_EQ(3u, chunks.size());
+  EXPECT_EQ("0123", chunks[0]);
+  EXPECT_EQ("4567", chunks[1]);
+  EXPECT_EQ("89", chunks[2]);
+}
+
+TEST(Stream, readsFile)
+{
+  const qi::Path dir = qi::os::mktmpdir("test_stream");
+  const qi::Path path = dir / "data.bin";
+  std::string content(10000, 'x');
+  content[9999] = 'y';
+  {
+    boost::filesystem::ofstream file(path.bfsPath(), std::ios::binary);
+    file << content;
+  }
+
+  std::string read;
+  qi::Future<void> done = qi::readStream(qi::Stream::fromFile(path.str()),
+      [&](const qi::Buffer& chunk) { read += toString(chunk); }, 4096);
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, done.wait(1000));
+  EXPECT_EQ(content, read);
+
+  boost::filesystem::remove_all(dir.bfsPath());
+}
+
+TEST(Stream, reportsSourceErrors)
+{
+  qi::Object<qi::Stream> stream(new qi::Stream([](std::size_t) -> qi::Buffer {
+    throw std::runtime_error("broken source");
+  }));
+
+  qi::Future<void> done = qi::readStream(stream, [](const qi::Buffer&) {});
+  ASSERT_EQ(qi::FutureState_FinishedWithError, done.wait(1000));
+  EXPECT_NE(std::string::npos, done.error().find("broken source"));
+}
+
+TEST(Stream, failsOnMissingFile)
+{
+  EXPECT_ANY_THROW(qi::Stream::fromFile("/this/file/does/not/exist"));
+}
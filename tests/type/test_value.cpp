@@ -119,6 +119,91 @@ TEST(Value, InvalidValue)
   EXPECT_EQ(AnyValue{}, v);
 }
 
+TEST(Value, Move)
+{
+  AnyValue v = AnyValue::from(std::string("forty-two"));
+  const void* storage = v.rawValue();
+
+  AnyValue moved(std::move(v));
+  EXPECT_FALSE(v.isValid());
+  EXPECT_EQ(storage, moved.rawValue());
+  EXPECT_EQ("forty-two", moved.toString());
+
+  AnyValue assigned = AnyValue::from(12);
+  assigned = std::move(moved);
+  EXPECT_FALSE(moved.isValid());
+  EXPECT_EQ(storage, assigned.rawValue());
+  EXPECT_EQ("forty-two", assigned.toString());
+}
+
+TEST(Value, InlineScalar)
+{
+  AnyValue v = AnyValue::from(42);
+  AnyValue copy(v);
+  EXPECT_NE(v.rawValue(), copy.rawValue());
+  copy.set(12);
+  EXPECT_EQ(42, v.toInt());
+  EXPECT_EQ(12, copy.toInt());
+
+  AnyValue str = AnyValue::from(std::string("foo"));
+  str.swap(v);
+  EXPECT_EQ(42, str.toInt());
+  EXPECT_EQ("foo", v.toString());
+
+  AnyValue moved(std::move(str));
+  EXPECT_FALSE(str.isValid());
+  EXPECT_EQ(42, moved.toInt());
+
+  AnyReference released = moved.release();
+  EXPECT_FALSE(moved.isValid());
+  EXPECT_EQ(42, released.toInt());
+  released.destroy();
+
+  AnyValue d = AnyValue::make<double>();
+  d.set(3.5);
+  EXPECT_EQ(3.5, d.toDouble());
+}
+
+TEST(Value, ReferencesFollowSwapAndMove)
+{
+  AnyValue v = AnyValue::from(42);
+  AnyValue other = AnyValue::from(12);
+  AnyReference ref = v.asReference();
+  v.swap(other);
+  EXPECT_EQ(42, ref.toInt());
+  EXPECT_EQ(other.rawValue(), ref.rawValue());
+  EXPECT_EQ(12, v.toInt());
+
+  AnyValue moved(std::move(other));
+  EXPECT_EQ(moved.rawValue(), ref.rawValue());
+  ref.set(13);
+  EXPECT_EQ(13, moved.toInt());
+
+  AnyValue assigned;
+  int& i = v.as<int>();
+  assigned = std::move(v);
+  i = 14;
+  EXPECT_EQ(14, assigned.toInt());
+
+  AnyValue str = AnyValue::from(std::string("foo"));
+  AnyReference strRef = str.asReference();
+  AnyValue movedStr(std::move(str));
+  EXPECT_EQ(movedStr.rawValue(), strRef.rawValue());
+  EXPECT_EQ("foo", strRef.toString());
+}
+
+TEST(Value, ReferencesFollowVectorReallocation)
+{
+  std::vector<AnyValue> values;
+  values.reserve(1);
+  values.push_back(AnyValue::from(42));
+  AnyReference ref = values[0].asReference();
+  for (int i = 0; i < 100; ++i)
+    values.push_back(AnyValue::from(i));
+  EXPECT_EQ(values[0].rawValue(), ref.rawValue());
+  EXPECT_EQ(42, ref.toInt());
+}
+
 TEST(Value, InvalidReference)
 {
   AnyValue v;
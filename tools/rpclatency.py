@@ -0,0 +1,110 @@
+#!/usr/bin/env python
+"""rpclatency: per-phase latency breakdown of the calls in a trace
+
+Reads the text output of babeltrace on a LTTng trace of processes built
+WITH_PROBES, and matches the qi_qi messaging tracepoints of each call by
+message id, service, object and function.
+
+The network phases compare timestamps of different processes: they are only
+meaningful when the client and the server run on the same machine.
+"""
+
+__usage__ = """
+babeltrace --clock-seconds <trace dir> | rpclatency.py [--service N] [--function N]
+rpclatency.py [--service N] [--function N] <babeltrace output file>
+"""
+
+import re
+import sys
+from optparse import OptionParser
+
+TYPE_CALL = 1
+
+# (phase, (start event, is the call message), (end event, is the call message))
+PHASES = [
+    ("serialization",     ("rpc_call", True),           ("message_enqueue", True)),
+    ("send queue",        ("message_enqueue", True),    ("message_sent", True)),
+    ("network",           ("message_sent", True),       ("message_received", True)),
+    ("server receive",    ("message_received", True),   ("server_message", True)),
+    ("decoding",          ("server_message", True),     ("server_call_start", True)),
+    ("execution",         ("server_call_start", True),  ("server_call_result", False)),
+    ("reply serialization", ("server_call_result", False), ("message_enqueue", False)),
+    ("reply send queue",  ("message_enqueue", False),   ("message_sent", False)),
+    ("reply network",     ("message_sent", False),      ("message_received", False)),
+    ("client dispatch",   ("message_received", False),  ("message_dispatch", False)),
+    ("total",             ("rpc_call", True),           ("message_dispatch", False)),
+]
+
+LINE_RE = re.compile(r"^\[([0-9:.]+)\].*?qi_qi:(\w+):.*\{([^{}]*)\}\s*$")
+FIELD_RE = re.compile(r"(\w+) = (-?\d+)")
+
+
+def parse_timestamp(text):
+    """ Seconds, from either --clock-seconds or the HH:MM:SS.ns format """
+    seconds = 0.0
+    for part in text.split(":"):
+        seconds = seconds * 60 + float(part)
+    return seconds
+
+
+def parse(lines):
+    """ Return {(id, service, object, function): {(event, is call): timestamp}} """
+    calls = {}
+    for line in lines:
+        match = LINE_RE.match(line)
+        if not match:
+            continue
+        timestamp, event, fields = match.groups()
+        fields = dict((k, int(v)) for (k, v) in FIELD_RE.findall(fields))
+        if "id" not in fields:
+            continue  # eventloop tracepoints
+        key = (fields["id"], fields["service"], fields["object"], fields["function"])
+        point = (event, fields["type"] == TYPE_CALL)
+        # Keep the first occurrence, e.g. a reply dispatched to several listeners.
+        calls.setdefault(key, {}).setdefault(point, parse_timestamp(timestamp))
+    return calls
+
+
+def percentile(values, ratio):
+    return values[min(len(values) - 1, int(ratio * len(values)))]
+
+
+def breakdown(calls, service=None, function=None):
+    durations = dict((phase, []) for (phase, _, _) in PHASES)
+    for (key, points) in calls.items():
+        if service is not None and key[1] != service:
+            continue
+        if function is not None and key[3] != function:
+            continue
+        for (phase, start, end) in PHASES:
+            if start in points and end in points:
+                durations[phase].append((points[end] - points[start]) * 1e6)
+    return durations
+
+
+def report(durations, out=sys.stdout):
+    out.write("%-20s %8s %10s %10s %10s %10s %10s\n"
+              % ("phase (us)", "count", "mean", "p50", "p90", "p99", "max"))
+    for (phase, _, _) in PHASES:
+        values = sorted(durations[phase])
+        if not values:
+            continue
+        out.write("%-20s %8d %10.1f %10.1f %10.1f %10.1f %10.1f\n"
+                  % (phase, len(values), sum(values) / len(values),
+                     percentile(values, 0.5), percentile(values, 0.9),
+                     percentile(values, 0.99), values[-1]))
+
+
+def main():
+    parser = OptionParser(usage=__usage__)
+    parser.add_option("--service", type="int", help="only the calls to this service id")
+    parser.add_option("--function", type="int", help="only the calls to this method id")
+    (options, args) = parser.parse_args()
+    if len(args) > 1:
+        parser.error("at most one input file")
+    lines = open(args[0]) if args else sys.stdin
+    report(breakdown(parse(lines), options.service, options.function))
+
+
+if __name__ == "__main__":
+    main()